@@ -43,6 +43,9 @@ SerialCommand::SerialCommand()
 	strncpy(delim," ",MAXDELIMETER);  // strtok_r needs a null-terminated string
 	term='\r';   // return character, default terminator for commands
 	numCommand=0;    // Number of callback handlers installed
+	commandTable=NULL;
+	commandSlots=0;
+	commandSeed=0;
 	clearBuffer(); 
 }
 
@@ -58,6 +61,9 @@ SerialCommand::SerialCommand(serialPortID SerialPort)
 	strncpy(delim," ",MAXDELIMETER);  // strtok_r needs a null-terminated string
 	term='\r';   // return character, default terminator for commands
 	numCommand=0;    // Number of callback handlers installed
+	commandTable=NULL;
+	commandSlots=0;
+	commandSeed=0;
 	clearBuffer();
 	switch (SerialPort)
 	{
@@ -103,6 +109,9 @@ SerialCommand::SerialCommand(SoftwareSerial &_SoftSer)
 	strncpy(delim," ",MAXDELIMETER);  // strtok_r needs a null-terminated string
 	term='\r';   // return character, default terminator for commands
 	numCommand=0;    // Number of callback handlers installed
+	commandTable=NULL;
+	commandSlots=0;
+	commandSeed=0;
 	clearBuffer(); 
 }
 #endif
@@ -141,8 +150,6 @@ void SerialCommand::readSerial()
 	while ((selectedSerialPort!=SW_SERIAL && HardSerial->available() > 0) || (selectedSerialPort==SW_SERIAL && SoftSerial->available() > 0) )
 	#endif
 	{
-		int i; 
-		boolean matched; 
 		#ifndef SERIALCOMMAND_HARDWAREONLY
 		if (selectedSerialPort!=SW_SERIAL) {
 		#endif
@@ -163,36 +170,7 @@ void SerialCommand::readSerial()
 			HardSerial.println(buffer);
 			#endif
 			bufPos=0;           // Reset to start of buffer
-			token = strtok_r(buffer,delim,&last);   // Search for command at start of buffer
-			if (token == NULL) return; 
-			matched=false; 
-			for (i=0; i<numCommand; i++) {
-				#ifdef SERIALCOMMANDDEBUG
-				HardSerial.print("Comparing ["); 
-				HardSerial.print(token); 
-				HardSerial.print("] to [");
-				HardSerial.print(CommandList[i].command);
-				HardSerial.println("]");
-				#endif
-				// Compare the found command against the list of known commands for a match
-				if (strncmp(token,CommandList[i].command,SERIALCOMMANDBUFFER) == 0) 
-				{
-					#ifdef SERIALCOMMANDDEBUG
-					HardSerial.print("Matched Command: "); 
-					HardSerial.println(token);
-					#endif
-					// Execute the stored handler function for the command
-					(*CommandList[i].function)(); 
-					clearBuffer(); 
-					matched=true; 
-					break; 
-				}
-			}
-			if (matched==false) {
-				(*defaultHandler)(); 
-				clearBuffer(); 
-			}
-
+			execute();
 		}
 		if (isprint(inChar))   // Only printable characters into the buffer
 		{
@@ -203,6 +181,67 @@ void SerialCommand::readSerial()
 	}
 }
 
+// Runs a whole command line got from elsewhere as if it had been read from the port. 
+// Line is copied, so it can be reused as soon as this returns 
+void SerialCommand::dispatch(const char *line)
+{
+	strncpy(buffer,line,SERIALCOMMANDBUFFER-1);
+	buffer[SERIALCOMMANDBUFFER-1]='\0';
+	bufPos=0;
+	execute();
+}
+
+// Looks up the command at the start of the buffer and calls its handler, 
+// or the default handler if there's none 
+void SerialCommand::execute()
+{
+	int i; 
+	boolean matched; 
+	token = strtok_r(buffer,delim,&last);   // Search for command at start of buffer
+	if (token == NULL) return; 
+	matched=false; 
+	if (commandTable != NULL) {
+		// Only command that can match is the one in token's slot
+		SerialCommandEntry entry;
+		memcpy_P(&entry,&commandTable[hash(token,commandSeed,commandSlots)],sizeof(SerialCommandEntry));
+		if ((entry.command != NULL) && (strcmp_P(token,entry.command) == 0)) {
+			#ifdef SERIALCOMMANDDEBUG
+			HardSerial.print("Matched Command: "); 
+			HardSerial.println(token);
+			#endif
+			(*entry.function)(); 
+			clearBuffer(); 
+			matched=true; 
+		}
+	}
+	for (i=0; !matched && i<numCommand; i++) {
+		#ifdef SERIALCOMMANDDEBUG
+		HardSerial.print("Comparing ["); 
+		HardSerial.print(token); 
+		HardSerial.print("] to [");
+		HardSerial.print(CommandList[i].command);
+		HardSerial.println("]");
+		#endif
+		// Compare the found command against the list of known commands for a match
+		if (strcmp(token,CommandList[i].command) == 0) 
+		{
+			#ifdef SERIALCOMMANDDEBUG
+			HardSerial.print("Matched Command: "); 
+			HardSerial.println(token);
+			#endif
+			// Execute the stored handler function for the command
+			(*CommandList[i].function)(); 
+			clearBuffer(); 
+			matched=true; 
+			break; 
+		}
+	}
+	if (matched==false) {
+		(*defaultHandler)(); 
+		clearBuffer(); 
+	}
+}
+
 // Adds a "command" and a handler function to the list of available commands.  
 // This is used for matching a found token in the buffer, and gives the pointer
 // to the handler function to deal with it. 
@@ -216,7 +255,7 @@ void SerialCommand::addCommand(const char *command, void (*function)())
 		HardSerial.println(command); 
 		#endif
 		
-		strncpy(CommandList[numCommand].command,command,SERIALCOMMANDBUFFER); 
+		CommandList[numCommand].command = command; 
 		CommandList[numCommand].function = function; 
 		numCommand++; 
 	} else {
@@ -229,6 +268,16 @@ void SerialCommand::addCommand(const char *command, void (*function)())
 	}
 }
 
+// Sets a PROGMEM table of commands, looked up before the ones given to addCommand(). 
+// Each entry must sit in the slot hash() gives its name with this seed and slots, 
+// which must be a power of two. 
+void SerialCommand::setCommands(const SerialCommandEntry *table, uint8_t slots, uint8_t seed)
+{
+	commandTable = table;
+	commandSlots = slots;
+	commandSeed = seed;
+}
+
 // This sets up a handler to be called in the event that the receveived command string
 // isn't in the list of things with handlers.
 void SerialCommand::addDefaultHandler(void (*function)())
@@ -18,6 +18,9 @@ Oct 2013 - SerialCommand object can be created using a SoftwareSerial object, fo
 Oct 2013 - Conditional compilation for the SoftwareSerial support, in case you really, really
            hate it and want it removed.  
 Feb 2014 - Made the changes to support Mega Serial 1/2/3 and to select serial from the library constructor
+Oct 2026 - Command table in PROGMEM, dispatched through a perfect hash checked at compile time.
+           addCommand() keeps a pointer to the name instead of a copy of it.
+           dispatch() runs a line assembled by the caller.
 
 This library is free software; you can redistribute it and/or
 modify it under the terms of the GNU Lesser General Public
@@ -68,6 +71,14 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #define MAXSERIALCOMMANDS	10
 #define MAXDELIMETER 2
 
+// Command table kept in PROGMEM, see setCommands(). Every command sits in the slot 
+// SerialCommand::hash() gives its name, so a received command is found with one hash 
+// and one strcmp_P. Unused slots have a NULL command. 
+typedef struct _serialCommandEntry {
+	const char *command;                // PROGMEM name
+	void (*function)();
+} SerialCommandEntry;
+
 #define SERIALCOMMANDDEBUG 1
 #undef SERIALCOMMANDDEBUG      // Comment this out to run the library in debug mode (verbose messages)
 
@@ -108,8 +119,18 @@ class SerialCommand
 		void clearBuffer();   // Sets the command buffer to all '\0' (nulls)
 		char *next();         // returns pointer to next token found in command buffer (for getting arguments to commands)
 		void readSerial();    // Main entry point.  
-		void addCommand(const char *, void(*)());   // Add commands to processing dictionary
+		void dispatch(const char *);   // Runs a complete command line read by the caller
+		void addCommand(const char *, void(*)());   // Add commands to processing dictionary, name must outlive it
+		void setCommands(const SerialCommandEntry *, uint8_t, uint8_t);   // PROGMEM table of slots entries, a power of two, and its hash seed
 		void addDefaultHandler(void (*function)());    // A handler to call when no valid command received. 
+
+		// Slot of a name in a table of slots entries. It's constexpr so a table's layout 
+		// can be checked with static_assert: a collision fails the build, and is solved 
+		// by trying another seed or doubling the slots. 
+		static constexpr uint8_t hash(const char *str, uint8_t seed, uint8_t slots)
+		{
+			return fold(mix(str, seed)) & (slots - 1);
+		}
 	
 	private:
 		char inChar;          // A character read from the serial stream 
@@ -120,18 +141,33 @@ class SerialCommand
 		char *token;                        // Returned token from the command buffer as returned by strtok_r
 		char *last;                         // State variable used by strtok_r during processing
 		typedef struct _callback {
-			char command[SERIALCOMMANDBUFFER];
+			const char *command;
 			void (*function)();
 		} SerialCommandCallback;            // Data structure to hold Command/Handler function key-value pairs
 
 		int numCommand;
 		SerialCommandCallback CommandList[MAXSERIALCOMMANDS];   // Actual definition for command/handler array
+		const SerialCommandEntry *commandTable;  // PROGMEM table set by setCommands(), or NULL
+		uint8_t commandSlots;
+		uint8_t commandSeed;
 		void (*defaultHandler)();           // Pointer to the default handler function 
 		serialPortID selectedSerialPort;    // Serial port selected by caller
 		#ifndef SERIALCOMMAND_HARDWAREONLY 
 		SoftwareSerial *SoftSerial;         // Pointer to a created SoftwareSerial object
 		#endif
 		HardwareSerial *HardSerial;         // Pointer to a HardwareSerial object
+
+		void execute();                     // Runs command in buffer
+
+		// h * 31 + c over the name, then high byte folded into low one
+		static constexpr uint16_t mix(const char *str, uint16_t h)
+		{
+			return (*str == '\0') ? h : mix(str + 1, (uint16_t)(h * 31u + (uint8_t)*str));
+		}
+		static constexpr uint8_t fold(uint16_t h)
+		{
+			return (uint8_t)(h ^ (h >> 8));
+		}
 };
 
 #endif //SerialCommand_h
\ No newline at end of file
@@ -0,0 +1,288 @@
+#include "Telemetry.h"
+
+// *********************************************
+// Telemetry
+// *********************************************
+uint16_t Telemetry::crc16(const uint8_t *data, size_t length) {
+	uint16_t crc = 0xFFFF;
+	while (length--) {
+		crc ^= (uint16_t)*data++ << 8;
+		for (uint8_t i = 0; i < 8; i++)
+			crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+	}
+	return crc;
+}
+
+//Each block is a code byte, one more than the non-zero bytes after it,
+//with the zero that ends the block left out. 0xFF blocks have no zero
+size_t Telemetry::cobsEncode(const uint8_t *src, size_t length, uint8_t *dst) {
+	uint8_t *code = dst;
+	uint8_t *out = dst + 1;
+	uint8_t run = 1;
+	for (size_t i = 0; i < length; i++) {
+		if (src[i] == 0) {
+			*code = run;
+			code = out++;
+			run = 1;
+			continue;
+		}
+		*out++ = src[i];
+		run++;
+		if (run == 0xFF) {
+			*code = run;
+			code = out++;
+			run = 1;
+		}
+	}
+	*code = run;
+	return out - dst;
+}
+
+size_t Telemetry::cobsDecode(const uint8_t *src, size_t length, uint8_t *dst, size_t dstSize) {
+	size_t in = 0;
+	size_t out = 0;
+	while (in < length) {
+		uint8_t code = src[in++];
+		if ((code == 0) || (in + code - 1 > length) || (out + code - 1 > dstSize))
+			return 0;
+		for (uint8_t i = 1; i < code; i++) {
+			if (src[in] == 0)
+				return 0;
+			dst[out++] = src[in++];
+		}
+		//Blocks but the last one and 0xFF ones end in a zero
+		if ((code != 0xFF) && (in < length)) {
+			if (out == dstSize)
+				return 0;
+			dst[out++] = 0;
+		}
+	}
+	return out;
+}
+
+size_t Telemetry::frame(uint8_t type, uint8_t sequence, const uint8_t *payload, uint8_t length, uint8_t *frame) {
+	if (length > maxPayload)
+		return 0;
+	uint8_t raw[maxRaw];
+	raw[0] = type;
+	raw[1] = sequence;
+	memcpy(raw + 2, payload, length);
+	put16(raw + 2 + length, crc16(raw, 2 + length));
+	frame[0] = 0;
+	size_t n = 1 + cobsEncode(raw, 2 + length + 2, frame + 1);
+	frame[n++] = 0;
+	return n;
+}
+
+uint8_t* Telemetry::put16(uint8_t *p, uint16_t value) {
+	*p++ = value;
+	*p++ = value >> 8;
+	return p;
+}
+
+uint8_t* Telemetry::put32(uint8_t *p, uint32_t value) {
+	p = put16(p, value);
+	return put16(p, value >> 16);
+}
+
+uint16_t Telemetry::get16(const uint8_t *p) {
+	return p[0] | ((uint16_t)p[1] << 8);
+}
+
+uint32_t Telemetry::get32(const uint8_t *p) {
+	return get16(p) | ((uint32_t)get16(p + 2) << 16);
+}
+
+// *********************************************
+// Payloads
+// *********************************************
+uint8_t TelemetrySnapshot::pack(uint8_t *buf) const {
+	uint8_t *p = Telemetry::put32(buf, time);
+	*p++ = present;
+	*p++ = alarms;
+	for (uint8_t i = 0; i < nChannels; i++)
+		p = Telemetry::put16(p, value[i]);
+	return p - buf;
+}
+
+bool TelemetrySnapshot::unpack(const uint8_t *buf, uint8_t length) {
+	if (length != size)
+		return false;
+	time = Telemetry::get32(buf);
+	present = buf[4];
+	alarms = buf[5];
+	for (uint8_t i = 0; i < nChannels; i++)
+		value[i] = Telemetry::get16(buf + 6 + 2 * i);
+	return true;
+}
+
+uint8_t TelemetryChanges::pack(uint8_t *buf) const {
+	uint8_t *p = Telemetry::put32(buf, time);
+	*p++ = present;
+	if (present & alarmsBit)
+		*p++ = alarms;
+	for (uint8_t i = 0; i < TelemetrySnapshot::nChannels; i++) {
+		if (present & (1 << i))
+			p = Telemetry::put16(p, value[i]);
+	}
+	return p - buf;
+}
+
+bool TelemetryChanges::unpack(const uint8_t *buf, uint8_t length) {
+	if (length < 5)
+		return false;
+	uint8_t expected = 5;
+	if (buf[4] & alarmsBit)
+		expected++;
+	for (uint8_t i = 0; i < TelemetrySnapshot::nChannels; i++) {
+		if (buf[4] & (1 << i))
+			expected += 2;
+	}
+	if (length != expected)
+		return false;
+	time = Telemetry::get32(buf);
+	present = buf[4];
+	const uint8_t *p = buf + 5;
+	if (present & alarmsBit)
+		alarms = *p++;
+	for (uint8_t i = 0; i < TelemetrySnapshot::nChannels; i++) {
+		if (present & (1 << i)) {
+			value[i] = Telemetry::get16(p);
+			p += 2;
+		}
+	}
+	return true;
+}
+
+uint8_t TelemetrySettings::pack(uint8_t *buf) const {
+	uint8_t *p = buf;
+	*p++ = count;
+	for (uint8_t i = 0; i < count; i++) {
+		*p++ = setting[i].id;
+		p = Telemetry::put16(p, setting[i].value);
+	}
+	return p - buf;
+}
+
+bool TelemetrySettings::unpack(const uint8_t *buf, uint8_t length) {
+	if ((length < 1) || (buf[0] > maxSettings) || (length != 1 + 3 * buf[0]))
+		return false;
+	count = buf[0];
+	for (uint8_t i = 0; i < count; i++) {
+		setting[i].id = buf[1 + 3 * i];
+		setting[i].value = Telemetry::get16(buf + 2 + 3 * i);
+	}
+	return true;
+}
+
+uint8_t TelemetryEvent::pack(uint8_t *buf) const {
+	uint8_t *p = Telemetry::put32(buf, time);
+	memcpy(p, text, length);
+	return 4 + length;
+}
+
+bool TelemetryEvent::unpack(const uint8_t *buf, uint8_t length) {
+	if ((length < 4) || (length - 4 > maxText))
+		return false;
+	time = Telemetry::get32(buf);
+	this->length = length - 4;
+	memcpy(text, buf + 4, this->length);
+	return true;
+}
+
+uint8_t TelemetryAlarm::pack(uint8_t *buf) const {
+	uint8_t *p = Telemetry::put32(buf, time);
+	*p++ = state;
+	return p - buf;
+}
+
+bool TelemetryAlarm::unpack(const uint8_t *buf, uint8_t length) {
+	if (length != size)
+		return false;
+	time = Telemetry::get32(buf);
+	state = buf[4];
+	return true;
+}
+
+// *********************************************
+// TelemetryDecoder
+// *********************************************
+TelemetryDecoder::TelemetryDecoder() : _received(0), _overflow(false), _length(0), _synced(false),
+	_nextSequence(0), _frames(0), _errors(0), _lost(0) {}
+
+TelemetryDecoder::TelemetryDecoder(const TelemetryDecoder &other) {
+	*this = other;
+}
+
+TelemetryDecoder& TelemetryDecoder::operator=(const TelemetryDecoder &other) {
+	memcpy(_encoded, other._encoded, sizeof(_encoded));
+	_received = other._received;
+	_overflow = other._overflow;
+	memcpy(_raw, other._raw, sizeof(_raw));
+	_length = other._length;
+	_synced = other._synced;
+	_nextSequence = other._nextSequence;
+	_frames = other._frames;
+	_errors = other._errors;
+	_lost = other._lost;
+	return *this;
+}
+
+TelemetryDecoder::~TelemetryDecoder() {}
+
+bool TelemetryDecoder::feed(uint8_t c) {
+	if (c != 0) {
+		if (_received < sizeof(_encoded))
+			_encoded[_received++] = c;
+		else
+			_overflow = true;
+		return false;
+	}
+	//Delimiter. Two in a row are just the end of one frame and the start of next
+	uint8_t received = _received;
+	bool overflow = _overflow;
+	_received = 0;
+	_overflow = false;
+	if (received == 0)
+		return false;
+	size_t n = overflow ? 0 : Telemetry::cobsDecode(_encoded, received, _raw, sizeof(_raw));
+	if ((n < 4) || (Telemetry::get16(_raw + n - 2) != Telemetry::crc16(_raw, n - 2))) {
+		_errors++;
+		return false;
+	}
+	_length = n - 4;
+	if (_synced)
+		_lost += (uint8_t)(_raw[1] - _nextSequence);
+	_nextSequence = _raw[1] + 1;
+	_synced = true;
+	_frames++;
+	return true;
+}
+
+uint8_t TelemetryDecoder::type() const {
+	return _raw[0];
+}
+
+uint8_t TelemetryDecoder::sequence() const {
+	return _raw[1];
+}
+
+const uint8_t* TelemetryDecoder::payload() const {
+	return _raw + 2;
+}
+
+uint8_t TelemetryDecoder::length() const {
+	return _length;
+}
+
+uint32_t TelemetryDecoder::getFrames() const {
+	return _frames;
+}
+
+uint32_t TelemetryDecoder::getErrors() const {
+	return _errors;
+}
+
+uint32_t TelemetryDecoder::getLost() const {
+	return _lost;
+}
@@ -0,0 +1,186 @@
+// #############################################################################
+//
+// # Name       : Telemetry
+//
+// # Description: Binary framed telemetry shared by Huertomato and the hosts reading it
+// # A frame is a type byte, a sequence byte, a payload of up to maxPayload bytes
+// # and a CRC-16 over all of them, COBS encoded so it holds no zeros and put between
+// # two zeros. Readers resync at the next zero after any error, so frames can share
+// # the UART with the text console. Payloads are little-endian fixed-point numbers:
+// # sensor values as in the SD logs, settings as in SettingsRegistry.
+// # Only needs the C++ standard headers, so host programs build it unchanged.
+//
+// #  This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// #############################################################################
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+//Frame types
+struct TelemetryMessage {
+	static const uint8_t Snapshot = 1;
+	static const uint8_t Settings = 2;
+	static const uint8_t Event = 3;
+	static const uint8_t Alarm = 4;
+	static const uint8_t Changes = 5;
+};
+
+class Telemetry {
+	public:
+		static const uint8_t maxPayload = 96;
+		//Type, sequence, payload and CRC
+		static const uint8_t maxRaw = 2 + maxPayload + 2;
+		//COBS adds one byte, and one more every 254, plus the zeros around it
+		static const uint8_t maxFrame = maxRaw + maxRaw / 254 + 3;
+
+		//CRC-16/CCITT-FALSE, the same the SD logs use
+		static uint16_t crc16(const uint8_t *data, size_t length);
+		//Encodes length bytes into dst, which needs length + length / 254 + 1 bytes.
+		//Returns encoded length. Adds no delimiter
+		static size_t cobsEncode(const uint8_t *src, size_t length, uint8_t *dst);
+		//Decodes a frame without its delimiter into dst, dstSize bytes long. Returns
+		//decoded length, 0 if it's malformed or wouldn't fit
+		static size_t cobsDecode(const uint8_t *src, size_t length, uint8_t *dst, size_t dstSize);
+		//Builds a whole frame, delimiters included, into frame (maxFrame bytes). Starting
+		//with a zero too, anything before it can't spoil it. Returns its length, 0 if
+		//payload is too long
+		static size_t frame(uint8_t type, uint8_t sequence, const uint8_t *payload, uint8_t length, uint8_t *frame);
+
+		//Little-endian field access. Writers return the byte after the field
+		static uint8_t* put16(uint8_t *p, uint16_t value);
+		static uint8_t* put32(uint8_t *p, uint32_t value);
+		static uint16_t get16(const uint8_t *p);
+		static uint32_t get32(const uint8_t *p);
+};
+
+//Latest reading of every sensor, fixed-point as in LogRecord: temp and pH in
+//hundredths (temp is signed), humidity and level in %, light in lux, EC in uS
+struct TelemetrySnapshot {
+	static const uint8_t nChannels = 6;
+	static const uint8_t size = 4 + 1 + 1 + 2 * nChannels;
+
+	//Seconds since 1970
+	uint32_t time;
+	//LogRecord present bits
+	uint8_t present;
+	//Sensors::alarmState() bits
+	uint8_t alarms;
+	uint16_t value[nChannels];
+
+	//Writes payload into buf, returns its length
+	uint8_t pack(uint8_t *buf) const;
+	//False if length is not a snapshot's
+	bool unpack(const uint8_t *buf, uint8_t length);
+};
+
+//Readings that changed since the previous Changes frame. Same figures as a
+//snapshot, but only channels with their present bit set are sent
+struct TelemetryChanges {
+	//Not a sensor: alarms byte is sent
+	static const uint8_t alarmsBit = 0x40;
+	static const uint8_t maxSize = TelemetrySnapshot::size;
+
+	uint32_t time;
+	//LogRecord present bits plus alarmsBit
+	uint8_t present;
+	uint8_t alarms;
+	//Channels not present are left as they were by unpack()
+	uint16_t value[TelemetrySnapshot::nChannels];
+
+	uint8_t pack(uint8_t *buf) const;
+	bool unpack(const uint8_t *buf, uint8_t length);
+};
+
+//One setting: Settings::Setting id and SettingsRegistry fixed-point value
+struct TelemetrySetting {
+	uint8_t id;
+	int16_t value;
+};
+
+struct TelemetrySettings {
+	//A count byte and three bytes each have to fit a payload
+	static const uint8_t maxSettings = (Telemetry::maxPayload - 1) / 3;
+
+	uint8_t count;
+	TelemetrySetting setting[maxSettings];
+
+	uint8_t pack(uint8_t *buf) const;
+	bool unpack(const uint8_t *buf, uint8_t length);
+};
+
+//A console message, sent as its text
+struct TelemetryEvent {
+	static const uint8_t maxText = Telemetry::maxPayload - 4;
+
+	uint32_t time;
+	uint8_t length;
+	//Not null terminated
+	char text[maxText];
+
+	uint8_t pack(uint8_t *buf) const;
+	bool unpack(const uint8_t *buf, uint8_t length);
+};
+
+//Alarm state changed. No bits set means it's over
+struct TelemetryAlarm {
+	static const uint8_t size = 4 + 1;
+
+	uint32_t time;
+	//Sensors::alarmState() bits
+	uint8_t state;
+
+	uint8_t pack(uint8_t *buf) const;
+	bool unpack(const uint8_t *buf, uint8_t length);
+};
+
+//Takes bytes as they arrive and hands out the frames that pass their CRC
+class TelemetryDecoder {
+	public:
+		TelemetryDecoder();
+		TelemetryDecoder(const TelemetryDecoder &other);
+		TelemetryDecoder& operator=(const TelemetryDecoder &other);
+		~TelemetryDecoder();
+
+		//True when c ends a good frame, readable until next feed()
+		bool feed(uint8_t c);
+		uint8_t type() const;
+		uint8_t sequence() const;
+		const uint8_t* payload() const;
+		uint8_t length() const;
+		uint32_t getFrames() const;
+		//Frames too long, badly encoded or failing their CRC. Text lines count here too
+		uint32_t getErrors() const;
+		//Frames missing according to sequence numbers
+		uint32_t getLost() const;
+
+	private:
+		uint8_t _encoded[Telemetry::maxFrame];
+		uint8_t _received;
+		//Too long, dropped up to next delimiter
+		bool _overflow;
+		uint8_t _raw[Telemetry::maxRaw];
+		uint8_t _length;
+		bool _synced;
+		uint8_t _nextSequence;
+		uint32_t _frames;
+		uint32_t _errors;
+		uint32_t _lost;
+};
+
+#endif
@@ -0,0 +1,98 @@
+// Reads Huertomato's serial output from stdin and prints every binary telemetry
+// frame in it, one per line, with counters at the end. Text console lines in
+// between are counted as errors and otherwise ignored.
+//
+// Build on the host: g++ -I.. -o TelemetryDump TelemetryDump.cpp ../Telemetry.cpp
+// Use: stty -F /dev/ttyACM0 115200 raw && ./TelemetryDump < /dev/ttyACM0
+
+#include <stdio.h>
+#include <Telemetry.h>
+
+//Prints present readings of a snapshot or changes frame
+static void printValues(uint8_t present, const uint16_t *value) {
+	if (present & 0x01) {
+		//Temp is signed hundredths in Celsius or Fahrenheit
+		int16_t t = (int16_t)value[0];
+		printf(" temp=%s%d.%02d%s", (t < 0) ? "-" : "", (t < 0 ? -t : t) / 100, (t < 0 ? -t : t) % 100,
+			(present & 0x80) ? "F" : "C");
+	}
+	if (present & 0x02)
+		printf(" humidity=%u%%", value[1]);
+	if (present & 0x04)
+		printf(" light=%u", value[2]);
+	if (present & 0x08)
+		printf(" ec=%u", value[3]);
+	if (present & 0x10)
+		printf(" ph=%u.%02u", value[4] / 100, value[4] % 100);
+	if (present & 0x20)
+		printf(" level=%u%%", value[5]);
+	printf("\n");
+}
+
+static void printFrame(const TelemetryDecoder &decoder) {
+	printf("#%u ", decoder.sequence());
+	switch (decoder.type()) {
+		case TelemetryMessage::Snapshot: {
+			TelemetrySnapshot s;
+			if (s.unpack(decoder.payload(), decoder.length())) {
+				printf("snapshot time=%lu alarms=0x%02X", (unsigned long)s.time, s.alarms);
+				printValues(s.present, s.value);
+				return;
+			}
+			break;
+		}
+		case TelemetryMessage::Changes: {
+			TelemetryChanges c;
+			if (c.unpack(decoder.payload(), decoder.length())) {
+				printf("changes time=%lu", (unsigned long)c.time);
+				if (c.present & TelemetryChanges::alarmsBit)
+					printf(" alarms=0x%02X", c.alarms);
+				printValues(c.present, c.value);
+				return;
+			}
+			break;
+		}
+		case TelemetryMessage::Settings: {
+			TelemetrySettings s;
+			if (s.unpack(decoder.payload(), decoder.length())) {
+				printf("settings");
+				for (uint8_t i = 0; i < s.count; i++)
+					printf(" %u=%d", s.setting[i].id, s.setting[i].value);
+				printf("\n");
+				return;
+			}
+			break;
+		}
+		case TelemetryMessage::Event: {
+			TelemetryEvent e;
+			if (e.unpack(decoder.payload(), decoder.length())) {
+				printf("event time=%lu %.*s\n", (unsigned long)e.time, e.length, e.text);
+				return;
+			}
+			break;
+		}
+		case TelemetryMessage::Alarm: {
+			TelemetryAlarm a;
+			if (a.unpack(decoder.payload(), decoder.length())) {
+				printf("alarm time=%lu state=0x%02X\n", (unsigned long)a.time, a.state);
+				return;
+			}
+			break;
+		}
+	}
+	printf("type=%u length=%u not understood\n", decoder.type(), decoder.length());
+}
+
+int main() {
+	TelemetryDecoder decoder;
+	int c;
+	while ((c = getchar()) != EOF) {
+		if (decoder.feed(c)) {
+			printFrame(decoder);
+			fflush(stdout);
+		}
+	}
+	fprintf(stderr, "frames=%lu errors=%lu lost=%lu\n", (unsigned long)decoder.getFrames(),
+		(unsigned long)decoder.getErrors(), (unsigned long)decoder.getLost());
+	return 0;
+}
@@ -0,0 +1,166 @@
+// Encodes every telemetry message, decodes it back and checks nothing changed.
+// Also checks corrupted, truncated, interleaved and oversized frames are dropped
+// without losing the ones after them, and compares frame sizes with their text form.
+// Exits with 1 if any check failed.
+//
+// Build on the host: g++ -I.. -o TelemetryRoundTrip TelemetryRoundTrip.cpp ../Telemetry.cpp
+// Use: ./TelemetryRoundTrip
+
+#include <stdio.h>
+#include <Telemetry.h>
+
+static uint8_t frame[Telemetry::maxFrame];
+static uint8_t payload[Telemetry::maxPayload];
+static TelemetryDecoder decoder;
+static uint8_t sequence = 0;
+static uint8_t failures = 0;
+
+static void check(const char *label, bool passed) {
+	printf("%s %s\n", passed ? "PASS" : "FAIL", label);
+	if (!passed)
+		failures++;
+}
+
+//Frames payload and feeds it to decoder. True if exactly one good frame came out
+static bool roundTrip(uint8_t type, uint8_t length, size_t &frameLength) {
+	frameLength = Telemetry::frame(type, sequence++, payload, length, frame);
+	uint8_t decoded = 0;
+	for (size_t i = 0; i < frameLength; i++) {
+		if (decoder.feed(frame[i]))
+			decoded++;
+	}
+	return (frameLength > 0) && (decoded == 1) && (decoder.type() == type) && (decoder.length() == length);
+}
+
+static void reportSize(size_t frameLength, uint16_t textLength) {
+	printf("     %u bytes framed, about %u as text\n", (unsigned)frameLength, textLength);
+}
+
+int main() {
+	size_t n;
+
+	//Every channel, negative temperature and values with zero bytes
+	TelemetrySnapshot snapshot = {1791158400UL, 0xBF, 0x05, {(uint16_t)-1250, 65, 0, 1800, 600, 100}};
+	TelemetrySnapshot snapshotBack;
+	bool ok = roundTrip(TelemetryMessage::Snapshot, snapshot.pack(payload), n)
+		&& snapshotBack.unpack(decoder.payload(), decoder.length())
+		&& (snapshotBack.time == snapshot.time) && (snapshotBack.present == snapshot.present)
+		&& (snapshotBack.alarms == snapshot.alarms)
+		&& (memcmp(snapshotBack.value, snapshot.value, sizeof(snapshot.value)) == 0);
+	check("snapshot", ok);
+	//"sensors" output: a labelled line per sensor
+	reportSize(n, 170);
+
+	//Alarms and two channels only
+	TelemetryChanges changes = {1791158460UL, TelemetryChanges::alarmsBit | 0x01 | 0x10, 0x04, {(uint16_t)-1240, 0, 0, 0, 598, 0}};
+	TelemetryChanges changesBack = {0, 0, 0, {0, 0, 0, 0, 0, 0}};
+	ok = roundTrip(TelemetryMessage::Changes, changes.pack(payload), n)
+		&& (decoder.length() == 4 + 1 + 1 + 2 * 2)
+		&& changesBack.unpack(decoder.payload(), decoder.length())
+		&& (changesBack.time == changes.time) && (changesBack.present == changes.present)
+		&& (changesBack.alarms == changes.alarms)
+		&& (changesBack.value[0] == changes.value[0]) && (changesBack.value[4] == changes.value[4]);
+	check("changes", ok);
+	reportSize(n, 20);
+
+	TelemetrySettings settings;
+	settings.count = 30;
+	for (uint8_t i = 0; i < settings.count; i++) {
+		settings.setting[i].id = i + 1;
+		settings.setting[i].value = (int16_t)(i * 1111 - 16000);
+	}
+	TelemetrySettings settingsBack;
+	ok = roundTrip(TelemetryMessage::Settings, settings.pack(payload), n)
+		&& settingsBack.unpack(decoder.payload(), decoder.length())
+		&& (settingsBack.count == settings.count)
+		&& (memcmp(settingsBack.setting, settings.setting, settings.count * sizeof(TelemetrySetting)) == 0);
+	check("settings", ok);
+	//"settings list" output
+	reportSize(n, 620);
+
+	TelemetryEvent event;
+	event.time = 1791158400UL;
+	event.length = TelemetryEvent::maxText;
+	for (uint8_t i = 0; i < event.length; i++)
+		event.text[i] = 'a' + i % 26;
+	TelemetryEvent eventBack;
+	ok = roundTrip(TelemetryMessage::Event, event.pack(payload), n)
+		&& eventBack.unpack(decoder.payload(), decoder.length())
+		&& (eventBack.time == event.time) && (eventBack.length == event.length)
+		&& (memcmp(eventBack.text, event.text, event.length) == 0);
+	check("event", ok);
+
+	TelemetryAlarm alarm = {1791158400UL, 0x00};
+	TelemetryAlarm alarmBack;
+	ok = roundTrip(TelemetryMessage::Alarm, alarm.pack(payload), n)
+		&& alarmBack.unpack(decoder.payload(), decoder.length())
+		&& (alarmBack.time == alarm.time) && (alarmBack.state == alarm.state);
+	check("alarm", ok);
+
+	//A payload longer than 254 non-zero bytes can't happen, but COBS has to split it
+	uint8_t raw[300];
+	uint8_t encoded[300 + 300 / 254 + 1];
+	uint8_t decoded[300];
+	for (uint16_t i = 0; i < sizeof(raw); i++)
+		raw[i] = 1 + i % 255;
+	n = Telemetry::cobsEncode(raw, sizeof(raw), encoded);
+	ok = (memchr(encoded, 0, n) == NULL) && (Telemetry::cobsDecode(encoded, n, decoded, sizeof(decoded)) == sizeof(raw))
+		&& (memcmp(raw, decoded, sizeof(raw)) == 0);
+	check("long COBS block", ok);
+
+	//Flipping any bit of a frame must not give a good frame
+	uint32_t errors = decoder.getErrors();
+	uint8_t good = 0;
+	n = Telemetry::frame(TelemetryMessage::Alarm, sequence++, payload, alarm.pack(payload), frame);
+	for (size_t i = 0; i < n - 1; i++) {
+		for (uint8_t bit = 0; bit < 8; bit++) {
+			frame[i] ^= 1 << bit;
+			for (size_t j = 0; j < n; j++) {
+				if (decoder.feed(frame[j]))
+					good++;
+			}
+			//Ends whatever a flipped zero left half received
+			decoder.feed(0);
+			frame[i] ^= 1 << bit;
+		}
+	}
+	check("corrupted frames dropped", good == 0);
+	check("corrupted frames counted", decoder.getErrors() > errors);
+
+	//Text between frames and a frame cut short are skipped
+	const char text[] = "12:00:00 > Watering\r\n";
+	for (uint8_t i = 0; i < sizeof(text) - 1; i++)
+		decoder.feed(text[i]);
+	for (size_t i = 0; i < n / 2; i++)
+		decoder.feed(frame[i]);
+	ok = roundTrip(TelemetryMessage::Alarm, alarm.pack(payload), n) && (decoder.getLost() > 0);
+	check("resync after text and cut frame", ok);
+
+	//Decodes to more than a raw frame holds: dropped, and what the decoder
+	//keeps after its buffer is left alone
+	uint8_t oversize[Telemetry::maxRaw + 4];
+	oversize[0] = 0;
+	oversize[1] = Telemetry::maxRaw + 3;
+	memset(oversize + 2, 'A', Telemetry::maxRaw + 2);
+	ok = (Telemetry::cobsDecode(oversize + 1, Telemetry::maxRaw + 3, decoded, Telemetry::maxRaw) == 0);
+	errors = decoder.getErrors();
+	good = 0;
+	for (size_t i = 0; i < sizeof(oversize); i++) {
+		if (decoder.feed(oversize[i]))
+			good++;
+	}
+	decoder.feed(0);
+	uint32_t lost = decoder.getLost();
+	ok = ok && (good == 0) && (decoder.getErrors() == errors + 1)
+		&& roundTrip(TelemetryMessage::Alarm, alarm.pack(payload), n) && (decoder.getLost() == lost);
+	check("oversized frame dropped", ok);
+
+	//A zero block ending exactly where the buffer does doesn't fit either
+	uint8_t full[] = {3, 'A', 'A', 1};
+	ok = (Telemetry::cobsDecode(full, sizeof(full), decoded, 2) == 0)
+		&& (Telemetry::cobsDecode(full, sizeof(full), decoded, 3) == 3);
+	check("decoding bounded", ok);
+
+	printf(failures == 0 ? "All passed\n" : "Some failed\n");
+	return (failures == 0) ? 0 : 1;
+}
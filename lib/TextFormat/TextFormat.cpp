@@ -0,0 +1,143 @@
+#include "TextFormat.h"
+
+//Powers of ten used for scaling floats to fixed-point
+static const uint32_t pow10Table[TextFormat::maxDecimals + 1] PROGMEM = { 1, 10, 100, 1000, 10000, 100000 };
+
+// *********************************************
+// CharBuffer
+// *********************************************
+CharBuffer::CharBuffer(char *buf, size_t size) : _buf(buf), _size(size) {
+	clear();
+}
+
+size_t CharBuffer::write(uint8_t c) {
+	//Last position is reserved for '\0'
+	if (_length + 1 >= _size) {
+		_overflow = true;
+		return 0;
+	}
+	_buf[_length++] = c;
+	_buf[_length] = '\0';
+	return 1;
+}
+
+void CharBuffer::clear() {
+	_length = 0;
+	_overflow = false;
+	if (_size > 0)
+		_buf[0] = '\0';
+}
+
+const char* CharBuffer::c_str() const { return _buf; }
+
+size_t CharBuffer::length() const { return _length; }
+
+boolean CharBuffer::overflow() const { return _overflow; }
+
+// *********************************************
+// TextFormat
+// *********************************************
+size_t TextFormat::printUInt(Print &out, uint32_t num, uint8_t width, char filler) {
+	char digits[_maxDigits];
+	uint8_t n = toDigits(num, digits + _maxDigits, 1);
+	return printPadded(out, false, digits + _maxDigits - n, n, 0, width, filler, '.');
+}
+
+size_t TextFormat::printInt(Print &out, int32_t num, uint8_t width, char filler) {
+	char digits[_maxDigits];
+	boolean negative = (num < 0);
+	//Done in unsigned so INT32_MIN doesn't overflow
+	uint32_t absNum = negative ? -(uint32_t)num : (uint32_t)num;
+	uint8_t n = toDigits(absNum, digits + _maxDigits, 1);
+	return printPadded(out, negative, digits + _maxDigits - n, n, 0, width, filler, '.');
+}
+
+size_t TextFormat::printFixed(Print &out, int32_t num, uint8_t decimals, uint8_t width, char filler, char divider) {
+	char digits[_maxDigits];
+	boolean negative = (num < 0);
+	uint32_t absNum = negative ? -(uint32_t)num : (uint32_t)num;
+	if (decimals > _maxDigits - 1)
+		decimals = _maxDigits - 1;
+	//At least one digit before divider: 5 with 2 decimals is "0.05"
+	uint8_t n = toDigits(absNum, digits + _maxDigits, decimals + 1);
+	return printPadded(out, negative, digits + _maxDigits - n, n, decimals, width, filler, divider);
+}
+
+size_t TextFormat::printFloat(Print &out, float num, uint8_t decimals, uint8_t width, char filler, char divider) {
+	if (isnan(num))
+		return out.print(F("nan"));
+	if (decimals > maxDecimals)
+		decimals = maxDecimals;
+	//Out of int32_t range once scaled
+	float scaled = num * (float)pgm_read_dword(&pow10Table[decimals]);
+	if ((scaled > 2147483520.0) || (scaled < -2147483520.0))
+		return out.print(F("ovf"));
+	return printFixed(out, toFixed(num, decimals), decimals, width, filler, divider);
+}
+
+int32_t TextFormat::toFixed(float num, uint8_t decimals) {
+	if (decimals > maxDecimals)
+		decimals = maxDecimals;
+	float scaled = num * (float)pgm_read_dword(&pow10Table[decimals]);
+	if (scaled > 2147483520.0)
+		return INT32_MAX;
+	if (scaled < -2147483520.0)
+		return INT32_MIN;
+	return (scaled < 0) ? (int32_t)(scaled - 0.5) : (int32_t)(scaled + 0.5);
+}
+
+size_t TextFormat::printP(Print &out, const char *pmStr) {
+	return out.print(reinterpret_cast<const __FlashStringHelper*>(pmStr));
+}
+
+//AVR has no divide instruction: every '/' or '%' on a uint32_t is a call to __udivmodsi4
+//(~600 cycles). Digits are extracted multiplying by the reciprocal of 10 instead.
+uint8_t TextFormat::toDigits(uint32_t num, char *end, uint8_t minDigits) {
+	uint8_t n = 0;
+	//num * 0.1 as a sum of shifts (Hacker's Delight divu10), off by one at most
+	while (num > 0xFFFF) {
+		uint32_t q = (num >> 1) + (num >> 2);
+		q += (q >> 4);
+		q += (q >> 8);
+		q += (q >> 16);
+		q >>= 3;
+		uint8_t rem = num - (((q << 2) + q) << 1);
+		if (rem > 9) {
+			q++;
+			rem -= 10;
+		}
+		*--end = '0' + rem;
+		num = q;
+		n++;
+	}
+	//Below 2^16 num * 0xCCCD >> 19 is exact: a 16x16 multiply and a shift
+	uint16_t small = num;
+	do {
+		uint16_t q = ((uint32_t)small * 0xCCCD) >> 19;
+		*--end = '0' + (uint8_t)(small - q * 10);
+		small = q;
+		n++;
+	} while ((small > 0) || (n < minDigits));
+	return n;
+}
+
+size_t TextFormat::printPadded(Print &out, boolean negative, const char *digits, uint8_t nDigits,
+	uint8_t decimals, uint8_t width, char filler, char divider) {
+	uint8_t length = nDigits + (negative ? 1 : 0) + (decimals ? 1 : 0);
+	uint8_t padding = (width > length) ? width - length : 0;
+	size_t res = 0;
+
+	//Zeros go between sign and digits, anything else before the sign
+	if (negative && (filler == '0'))
+		res += out.write('-');
+	for (uint8_t i = 0; i < padding; i++)
+		res += out.write(filler);
+	if (negative && (filler != '0'))
+		res += out.write('-');
+	for (uint8_t i = 0; i < nDigits; i++) {
+		if (decimals && (i == nDigits - decimals))
+			res += out.write(divider);
+		res += out.write(digits[i]);
+	}
+	return res;
+}
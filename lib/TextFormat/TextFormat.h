@@ -0,0 +1,82 @@
+// #############################################################################
+//
+// # Name       : TextFormat
+//
+// # Description: Allocation-free text formatting for Huertomato
+// # Formats integers, fixed-point decimals and PROGMEM literals into any Print sink
+// # (Serial, SD File, LCD...) or into a caller provided char array using CharBuffer.
+// # Nothing here touches the heap, so it can replace Arduino String safely.
+//
+// #  This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// #############################################################################
+
+#ifndef TEXTFORMAT_H
+#define TEXTFORMAT_H
+
+#include <Arduino.h>
+
+//Print sink over a caller provided char array. Output is always null terminated.
+//Chars that don't fit are dropped and overflow() becomes true.
+class CharBuffer : public Print {
+	public:
+		CharBuffer(char *buf, size_t size);
+
+		size_t write(uint8_t c);
+		using Print::write;
+		//Empties buffer so it can be reused
+		void clear();
+		const char* c_str() const;
+		size_t length() const;
+		boolean overflow() const;
+
+	private:
+		char *_buf;
+		size_t _size;
+		size_t _length;
+		boolean _overflow;
+};
+
+//Number and text formatters. All of them return the number of chars written.
+//width pads the output to the right with filler. When filler is '0' sign goes first: "-0012"
+class TextFormat {
+	public:
+		static size_t printUInt(Print &out, uint32_t num, uint8_t width = 0, char filler = ' ');
+		static size_t printInt(Print &out, int32_t num, uint8_t width = 0, char filler = ' ');
+		//Prints num / 10^decimals. printFixed(out,2350,2) -> "23.50"
+		static size_t printFixed(Print &out, int32_t num, uint8_t decimals, uint8_t width = 0,
+			char filler = ' ', char divider = '.');
+		//Rounds num to decimals (max 5) and prints it as fixed-point
+		static size_t printFloat(Print &out, float num, uint8_t decimals, uint8_t width = 0,
+			char filler = ' ', char divider = '.');
+		//Prints a char array stored in PROGMEM
+		static size_t printP(Print &out, const char *pmStr);
+		//Rounds num to decimals (max 5) as fixed-point: toFixed(23.456,2) -> 2346
+		//Saturates when out of int32_t range
+		static int32_t toFixed(float num, uint8_t decimals);
+
+		//Largest number of decimals printFloat() handles
+		static const uint8_t maxDecimals = 5;
+
+	private:
+		//Longest uint32_t is 10 digits
+		static const uint8_t _maxDigits = 10;
+		//Writes digits of num backwards ending at end, with at least minDigits digits.
+		//Returns number of digits written
+		static uint8_t toDigits(uint32_t num, char *end, uint8_t minDigits);
+		static size_t printPadded(Print &out, boolean negative, const char *digits, uint8_t nDigits,
+			uint8_t decimals, uint8_t width, char filler, char divider);
+};
+
+#endif
@@ -0,0 +1,80 @@
+// Measures CPU cycles spent formatting numbers with the Arduino core (Print, dtostrf)
+// and with TextFormat. Output goes to a sink that discards it, so only formatting
+// is timed. Results are printed at 115200 bauds.
+
+#include <TextFormat.h>
+
+//Print sink that throws everything away
+class NullPrint : public Print {
+	public:
+		size_t write(uint8_t) { return 1; }
+		using Print::write;
+};
+
+NullPrint sink;
+const uint16_t iterations = 1000;
+volatile float floatValue = 23.47;
+volatile long longValue = -1234567;
+volatile uint8_t byteValue = 7;
+
+//Prints average cycles per call given the micros() spent on all iterations
+void report(const __FlashStringHelper *label, uint32_t elapsed) {
+	Serial.print(label);
+	TextFormat::printUInt(Serial, (elapsed * (F_CPU / 1000000UL)) / iterations, 8);
+	Serial.println(F(" cycles"));
+}
+
+void setup() {
+	Serial.begin(115200);
+	char buf[16];
+	CharBuffer cbuf(buf, sizeof(buf));
+	uint32_t start;
+
+	Serial.println(F("Float, 2 decimals"));
+	start = micros();
+	for (uint16_t i = 0; i < iterations; i++)
+		sink.print(floatValue);
+	report(F("  Print::print(float)      "), micros() - start);
+	start = micros();
+	for (uint16_t i = 0; i < iterations; i++)
+		dtostrf(floatValue, 6, 2, buf);
+	report(F("  dtostrf()                "), micros() - start);
+	start = micros();
+	for (uint16_t i = 0; i < iterations; i++)
+		TextFormat::printFloat(sink, floatValue, 2);
+	report(F("  TextFormat::printFloat() "), micros() - start);
+
+	Serial.println(F("Long"));
+	start = micros();
+	for (uint16_t i = 0; i < iterations; i++)
+		sink.print(longValue);
+	report(F("  Print::print(long)       "), micros() - start);
+	start = micros();
+	for (uint16_t i = 0; i < iterations; i++)
+		TextFormat::printInt(sink, longValue);
+	report(F("  TextFormat::printInt()   "), micros() - start);
+
+	Serial.println(F("Two digit, zero padded"));
+	start = micros();
+	for (uint16_t i = 0; i < iterations; i++) {
+		if (byteValue < 10)
+			sink.print('0');
+		sink.print(byteValue);
+	}
+	report(F("  Print::print(uint8_t)    "), micros() - start);
+	start = micros();
+	for (uint16_t i = 0; i < iterations; i++)
+		TextFormat::printUInt(sink, byteValue, 2, '0');
+	report(F("  TextFormat::printUInt()  "), micros() - start);
+
+	Serial.println(F("Into char array"));
+	start = micros();
+	for (uint16_t i = 0; i < iterations; i++) {
+		cbuf.clear();
+		TextFormat::printFixed(cbuf, 2347, 2);
+	}
+	report(F("  TextFormat::printFixed() "), micros() - start);
+}
+
+void loop() {
+}
@@ -37,6 +37,7 @@
 
 #include "UTFT.h"
 #include <pins_arduino.h>
+#include <TextFormat.h>
 
 // Include hardware-specific functions for the correct MCU
 #if defined(__AVR__)
@@ -1055,108 +1056,56 @@ void UTFT::print(String st, int x, int y, int deg)
 	print(buf, x, y, deg);
 }
 
-void UTFT::printNumI(long num, int x, int y, int length, char filler)
+//Prints a string stored in flash without copying it to SRAM first
+void UTFT::print(const __FlashStringHelper *st, int x, int y, int deg)
 {
-	char buf[25];
-	char st[27];
-	boolean neg=false;
-	int c=0, f=0;
-  
-	if (num==0)
+	const char *pst = (const char *)st;
+	int stl, i;
+
+	stl = strlen_P(pst);
+
+	if (orient==PORTRAIT)
 	{
-		if (length!=0)
-		{
-			for (c=0; c<(length-1); c++)
-				st[c]=filler;
-			st[c]=48;
-			st[c+1]=0;
-		}
-		else
-		{
-			st[0]=48;
-			st[1]=0;
-		}
+	if (x==RIGHT)
+		x=(disp_x_size+1)-(stl*cfont.x_size);
+	if (x==CENTER)
+		x=((disp_x_size+1)-(stl*cfont.x_size))/2;
 	}
 	else
 	{
-		if (num<0)
-		{
-			neg=true;
-			num=-num;
-		}
-	  
-		while (num>0)
-		{
-			buf[c]=48+(num % 10);
-			c++;
-			num=(num-(num % 10))/10;
-		}
-		buf[c]=0;
-	  
-		if (neg)
-		{
-			st[0]=45;
-		}
-	  
-		if (length>(c+neg))
-		{
-			for (int i=0; i<(length-c-neg); i++)
-			{
-				st[i+neg]=filler;
-				f++;
-			}
-		}
+	if (x==RIGHT)
+		x=(disp_y_size+1)-(stl*cfont.x_size);
+	if (x==CENTER)
+		x=((disp_y_size+1)-(stl*cfont.x_size))/2;
+	}
 
-		for (int i=0; i<c; i++)
-		{
-			st[i+neg+f]=buf[c-i-1];
-		}
-		st[c+neg+f]=0;
+	for (i=0; i<stl; i++)
+		if (deg==0)
+			printChar(pgm_read_byte(pst++), x + (i*(cfont.x_size)), y);
+		else
+			rotateChar(pgm_read_byte(pst++), x, y, i, deg);
+}
 
-	}
+void UTFT::printNumI(long num, int x, int y, int length, char filler)
+{
+	char st[27];
+	CharBuffer buf(st, sizeof(st));
 
+	TextFormat::printInt(buf, num, length, filler);
 	print(st,x,y);
 }
 
 void UTFT::printNumF(double num, byte dec, int x, int y, char divider, int length, char filler)
 {
 	char st[27];
-	boolean neg=false;
+	CharBuffer buf(st, sizeof(st));
 
 	if (dec<1)
 		dec=1;
 	else if (dec>5)
 		dec=5;
 
-	if (num<0)
-		neg = true;
-
-	_convert_float(st, num, length, dec);
-
-	if (divider != '.')
-	{
-		for (int i=0; i<sizeof(st); i++)
-			if (st[i]=='.')
-				st[i]=divider;
-	}
-
-	if (filler != ' ')
-	{
-		if (neg)
-		{
-			st[0]='-';
-			for (int i=1; i<sizeof(st); i++)
-				if ((st[i]==' ') || (st[i]=='-'))
-					st[i]=filler;
-		}
-		else
-		{
-			for (int i=0; i<sizeof(st); i++)
-				if (st[i]==' ')
-					st[i]=filler;
-		}
-	}
-
+	TextFormat::printFloat(buf, num, dec, length, filler, divider);
 	print(st,x,y);
 }
 
@@ -182,6 +182,7 @@ class UTFT
 		word getBackColor();
 		void print(char *st, int x, int y, int deg=0);
 		void print(String st, int x, int y, int deg=0);
+		void print(const __FlashStringHelper *st, int x, int y, int deg=0);
 		void printNumI(long num, int x, int y, int length=0, char filler=' ');
 		void printNumF(double num, byte dec, int x, int y, char divider='.', int length=0, char filler=' ');
 		void setFont(uint8_t* font);
@@ -0,0 +1,80 @@
+#include "BinaryTelemetry.h"
+
+//Every setting has to fit a single frame
+static_assert(SettingsRegistry::nSettings <= TelemetrySettings::maxSettings, "Settings don't fit a telemetry frame");
+
+BinaryTelemetry::BinaryTelemetry() : _sequence(0) {}
+
+BinaryTelemetry::BinaryTelemetry(const BinaryTelemetry &other) {
+	_sequence = other._sequence;
+}
+
+BinaryTelemetry& BinaryTelemetry::operator=(const BinaryTelemetry &other) {
+	_sequence = other._sequence;
+	return *this;
+}
+
+BinaryTelemetry::~BinaryTelemetry() {}
+
+void BinaryTelemetry::sendSnapshot(Print &out, const SensorSample &sample) {
+	TelemetrySnapshot snapshot;
+	snapshot.time = sample.time;
+	snapshot.present = sample.present;
+	snapshot.alarms = sample.alarms;
+	//Fixed-point readings fit 16 bits, temp as two's complement
+	for (uint8_t i = 0; i < TelemetrySnapshot::nChannels; i++)
+		snapshot.value[i] = sample.value[i];
+	uint8_t payload[TelemetrySnapshot::size];
+	send(out, TelemetryMessage::Snapshot, payload, snapshot.pack(payload));
+}
+
+void BinaryTelemetry::sendChanges(Print &out, const SensorSample &changes) {
+	TelemetryChanges frame;
+	frame.time = changes.time;
+	frame.present = changes.present;
+	frame.alarms = changes.alarms;
+	for (uint8_t i = 0; i < TelemetrySnapshot::nChannels; i++)
+		frame.value[i] = changes.value[i];
+	uint8_t payload[TelemetryChanges::maxSize];
+	send(out, TelemetryMessage::Changes, payload, frame.pack(payload));
+}
+
+void BinaryTelemetry::sendSettings(Print &out, const Settings &settings) {
+	TelemetrySettings all;
+	all.count = SettingsRegistry::nSettings;
+	SettingInfo info;
+	for (uint8_t i = 0; i < SettingsRegistry::nSettings; i++) {
+		SettingsRegistry::info(i, info);
+		all.setting[i].id = info.id;
+		all.setting[i].value = SettingsRegistry::get(settings, i);
+	}
+	uint8_t payload[Telemetry::maxPayload];
+	send(out, TelemetryMessage::Settings, payload, all.pack(payload));
+}
+
+void BinaryTelemetry::sendEvent(Print &out, time_t time, const char *txt) {
+	TelemetryEvent event;
+	event.time = time;
+	event.length = min(strlen_P(txt), (size_t)TelemetryEvent::maxText);
+	memcpy_P(event.text, txt, event.length);
+	uint8_t payload[Telemetry::maxPayload];
+	send(out, TelemetryMessage::Event, payload, event.pack(payload));
+}
+
+void BinaryTelemetry::sendAlarm(Print &out, time_t time, uint8_t state) {
+	TelemetryAlarm alarm;
+	alarm.time = time;
+	alarm.state = state;
+	uint8_t payload[TelemetryAlarm::size];
+	send(out, TelemetryMessage::Alarm, payload, alarm.pack(payload));
+}
+
+uint8_t BinaryTelemetry::getSequence() const {
+	return _sequence;
+}
+
+void BinaryTelemetry::send(Print &out, uint8_t type, const uint8_t *payload, uint8_t length) {
+	uint8_t frame[Telemetry::maxFrame];
+	size_t n = Telemetry::frame(type, _sequence++, payload, length, frame);
+	out.write(frame, n);
+}
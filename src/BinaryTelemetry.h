@@ -0,0 +1,61 @@
+// #############################################################################
+//
+// # Name       : BinaryTelemetry
+//
+// # Description: Sends Huertomato's state as Telemetry frames instead of text
+// # A snapshot of every sensor takes 25 bytes against about 170 of "sensors" output,
+// # and hosts read it without parsing labels, units or decimal points. Values are
+// # the same fixed-point figures the SD logs and SettingsRegistry hold. Frames are
+// # numbered so a host can tell how many it missed.
+//
+// #  This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// #############################################################################
+
+#ifndef BINARYTELEMETRY_H
+#define BINARYTELEMETRY_H
+
+#include <Arduino.h>
+#include <Telemetry.h>
+#include "Settings.h"
+#include "SettingsRegistry.h"
+#include "SensorAggregate.h"
+
+class BinaryTelemetry {
+	public:
+		BinaryTelemetry();
+		BinaryTelemetry(const BinaryTelemetry &other);
+		BinaryTelemetry& operator=(const BinaryTelemetry &other);
+		~BinaryTelemetry();
+
+		//Every sensor reading and alarm bits
+		void sendSnapshot(Print &out, const SensorSample &sample);
+		//Every SettingsRegistry entry
+		void sendSettings(Print &out, const Settings &settings);
+		//A console message, assumes a PROGMEM char*. Cut to TelemetryEvent::maxText
+		void sendEvent(Print &out, time_t time, const char *txt);
+		//Readings with their present bit set, and alarms with TelemetryChanges::alarmsBit
+		void sendChanges(Print &out, const SensorSample &changes);
+		//Sensors::alarmState() bits, 0 when alarms are over
+		void sendAlarm(Print &out, time_t time, uint8_t state);
+		//Frames sent so far, wrapping at 256 as their sequence number does
+		uint8_t getSequence() const;
+
+	private:
+		uint8_t _sequence;
+
+		void send(Print &out, uint8_t type, const uint8_t *payload, uint8_t length);
+};
+
+#endif
@@ -146,7 +146,7 @@ void WinButtons::disableButton(int buttonID, boolean redraw) {
 }
 
 //Relabels a button
-void WinButtons::relabelButton(int buttonID, char *label, boolean redraw) {
+void WinButtons::relabelButton(int buttonID, const char *label, boolean redraw) {
   if (!(buttons[buttonID].flags & BUTTON_UNUSED)) {
 	buttons[buttonID].label = label;
     if (redraw)
@@ -234,8 +234,7 @@ void WinButtons::setButtonColors(const uint8_t atxt[3], const uint8_t iatxt[3],
   }
 }
 
-//Converts a char array from PROGMEM to variable in SRAM
-char* WinButtons::pmChar(const char *pmArray) {
-	strcpy_P(_stringBuffer, (char*)pmArray);
-	return _stringBuffer;
+//Tags a char array in PROGMEM so it gets printed from flash with no SRAM copy
+const __FlashStringHelper* WinButtons::pmChar(const char *pmArray) {
+	return reinterpret_cast<const __FlashStringHelper*>(pmArray);
 }
\ No newline at end of file
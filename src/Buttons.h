@@ -59,7 +59,7 @@ class WinButtons {
 		void drawButton(int buttonID);
 		void enableButton(int buttonID, boolean redraw=false);
 		void disableButton(int buttonID, boolean redraw=false);
-		void relabelButton(int buttonID, char *label, boolean redraw=false);
+		void relabelButton(int buttonID, const char *label, boolean redraw=false);
 		boolean	buttonEnabled(int buttonID); 
 		void deleteButton(int buttonID); 
 		void deleteAllButtons(); 
@@ -75,9 +75,8 @@ class WinButtons {
 		button_struct buttons[_maxButtons];
 		uint8_t _color_text[3], _color_text_inactive[3], _color_background[3], _color_hilite[3];
 		uint8_t	*_font_text, *_font_symbol;
-		//These are used to read data from PROGMEM and store them into SRAM
-		char _stringBuffer[30];
-		char* pmChar(const char* pmArray);
+		//Tags a PROGMEM label so UTFT prints it straight from flash
+		const __FlashStringHelper* pmChar(const char* pmArray);
 };
 
 #endif
@@ -0,0 +1,87 @@
+#include "ContiguousFile.h"
+
+ContiguousFile::ContiguousFile() : _card(NULL), _ready(false), _firstBlock(0), _lastBlock(0) {}
+
+ContiguousFile::ContiguousFile(const ContiguousFile &other) {
+	*this = other;
+}
+
+ContiguousFile& ContiguousFile::operator=(const ContiguousFile &other) {
+	_card = other._card;
+	_volume = other._volume;
+	_root = other._root;
+	_file = other._file;
+	_ready = other._ready;
+	_firstBlock = other._firstBlock;
+	_lastBlock = other._lastBlock;
+	return *this;
+}
+
+ContiguousFile::~ContiguousFile() {}
+
+//Card pointer is static in SdVolume and set by SD.begin(). Initialising the volume
+//only reads the boot sector through the cache, the card itself isn't reset
+boolean ContiguousFile::begin() {
+	_card = _volume.sdCard();
+	_ready = (_card != NULL) && _volume.init(_card) && _root.openRoot(&_volume);
+	return _ready;
+}
+
+boolean ContiguousFile::ready() const { return _ready; }
+
+boolean ContiguousFile::open(const char *fileName, uint32_t size) {
+	if (!_ready || _file.isOpen())
+		return false;
+	if (_file.open(&_root, fileName, O_RDWR)) {
+		if (_file.contiguousRange(&_firstBlock, &_lastBlock))
+			return true;
+		_file.close();
+		return false;
+	}
+	if (!_file.createContiguous(&_root, fileName, size))
+		return false;
+	if (!_file.contiguousRange(&_firstBlock, &_lastBlock)) {
+		_file.close();
+		return false;
+	}
+	//Erased blocks are written faster and don't hold old data that passes for records.
+	//Not all cards support it, reads of unerased blocks are checked anyway
+	SdVolume::cacheClear();
+	_card->erase(_firstBlock, _lastBlock);
+	return true;
+}
+
+boolean ContiguousFile::isOpen() const {
+	return _file.isOpen();
+}
+
+uint32_t ContiguousFile::size() const {
+	return (_lastBlock - _firstBlock + 1) * blockSize;
+}
+
+boolean ContiguousFile::read(uint32_t pos, void *buf, uint16_t n) {
+	return _file.seekSet(pos) && (_file.read(buf, n) == (int16_t)n);
+}
+
+boolean ContiguousFile::readBlock(uint32_t n, uint8_t *buf) {
+	if (!_file.isOpen() || (_firstBlock + n > _lastBlock))
+		return false;
+	return _card->readBlock(_firstBlock + n, buf);
+}
+
+boolean ContiguousFile::writeBlock(uint32_t n, const uint8_t *buf) {
+	if (!_file.isOpen() || (_firstBlock + n > _lastBlock))
+		return false;
+	//Cache may hold the old block, read through SD by LogExport or HistoryQuery.
+	//Clearing also writes out any dirty block first, as the file system would
+	SdVolume::cacheClear();
+	return _card->writeBlock(_firstBlock + n, buf);
+}
+
+boolean ContiguousFile::close(uint32_t length) {
+	if (!_file.isOpen())
+		return false;
+	boolean res = _file.truncate(length);
+	res &= _file.close();
+	return res;
+}
@@ -0,0 +1,72 @@
+// #############################################################################
+//
+// # Name       : ContiguousFile
+//
+// # Description: SD card file made of consecutive blocks, written with raw block writes
+// # The file is created at its final size in contiguous clusters and erased once, so
+// # writing it needs no cluster-chain lookups or FAT updates: block n of the file is
+// # just card block first + n. close() truncates it to the length actually used.
+// # Works on the card SD.begin() set up, through an SdVolume of its own: SD keeps its
+// # volume private. All volumes share one block cache, which raw writes clear first,
+// # so readers of the file through SD never get an old copy of a block.
+//
+// #  This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// #############################################################################
+
+#ifndef CONTIGUOUSFILE_H
+#define CONTIGUOUSFILE_H
+
+#include <Arduino.h>
+#include <SD.h>
+
+class ContiguousFile {
+	public:
+		static const uint16_t blockSize = 512;
+
+		ContiguousFile();
+		ContiguousFile(const ContiguousFile &other);
+		ContiguousFile& operator=(const ContiguousFile &other);
+		~ContiguousFile();
+
+		//Sets up raw access to the card SD.begin() initialised. Call it after SD.begin()
+		boolean begin();
+		boolean ready() const;
+		//Opens an existing contiguous file or creates one of size bytes.
+		//Fails if file exists but isn't contiguous
+		boolean open(const char *fileName, uint32_t size);
+		boolean isOpen() const;
+		//Allocated bytes
+		uint32_t size() const;
+		//Reads bytes at a file position through the file system
+		boolean read(uint32_t pos, void *buf, uint16_t n);
+		//Raw access to block n of file
+		boolean readBlock(uint32_t n, uint8_t *buf);
+		boolean writeBlock(uint32_t n, const uint8_t *buf);
+		//Cuts file to length bytes and closes it
+		boolean close(uint32_t length);
+
+	private:
+		//SD's card, owned by SD
+		Sd2Card *_card;
+		SdVolume _volume;
+		SdFile _root;
+		SdFile _file;
+		boolean _ready;
+		//Card blocks the file spans
+		uint32_t _firstBlock;
+		uint32_t _lastBlock;
+};
+
+#endif
@@ -53,7 +53,7 @@ void GUI::start() {
 void GUI::refresh() {
 	Window::Screen actScreen = _window->getType();
 	if ((actScreen == Window::MainScreen) || (actScreen == Window::NightWater)
-		|| (actScreen == Window::LvlCalib))
+		|| (actScreen == Window::LvlCalib) || (actScreen == Window::Diagnostics))
 			_window->update();	
 }
 
@@ -127,6 +127,12 @@ void GUI::updateScreen(Window::Screen newScreen) {
 		case Window::Reservoir:
 			_window = new WinReservoir(_lcd,_touch,_sensors,_settings);
 			break;
+		case Window::Diagnostics:
+			_window = new WinDiagnostics(_lcd,_touch,_sensors,_settings);
+			break;
+		case Window::History:
+			_window = new WinHistory(_lcd,_touch,_sensors,_settings);
+			break;
 		default:
 			_window = new Window(_lcd,_touch,_sensors,_settings);
 			break;
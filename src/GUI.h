@@ -34,6 +34,8 @@
 #include "WinAlarms.h"
 #include "WinControllerMenu.h"
 #include "WinControllerMenuTwo.h"
+#include "WinDiagnostics.h"
+#include "WinHistory.h"
 #include "WinEcAlarms.h"
 #include "WinEcCalib.h"
 #include "WinLvlAlarms.h"
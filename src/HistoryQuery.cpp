@@ -0,0 +1,502 @@
+#include "HistoryQuery.h"
+
+HistoryQuery::HistoryQuery() : _state(Idle), _channel(0), _from(0), _to(0), _day(0), _csv(false),
+	_end(0), _layout(CsvIndex::unknownLayout), _rowStart(0), _lastHour(0xFF), _hasRow(false),
+	_rowTime(0), _bucketStart(0), _bucketLen(1), _min(0), _max(0), _sum(0), _count(0),
+	_totalMin(0), _totalMax(0), _totalSum(0), _totalCount(0) {
+	resetRow();
+	for (uint8_t i = 0; i < 3; i++)
+		_rowValue[i] = 0;
+}
+
+HistoryQuery::HistoryQuery(const HistoryQuery &other) {
+	*this = other;
+}
+
+HistoryQuery& HistoryQuery::operator=(const HistoryQuery &other) {
+	_state = other._state;
+	_channel = other._channel;
+	_from = other._from;
+	_to = other._to;
+	_day = other._day;
+	_file = other._file;
+	_index = other._index;
+	_csv = other._csv;
+	_end = other._end;
+	_layout = other._layout;
+	_rowStart = other._rowStart;
+	_field = other._field;
+	_num = other._num;
+	_digits = other._digits;
+	_decimals = other._decimals;
+	_neg = other._neg;
+	_header = other._header;
+	_hour = other._hour;
+	_minute = other._minute;
+	_found = other._found;
+	_lastHour = other._lastHour;
+	_hasRow = other._hasRow;
+	_rowTime = other._rowTime;
+	for (uint8_t i = 0; i < 3; i++)
+		_rowValue[i] = other._rowValue[i];
+	_bucketStart = other._bucketStart;
+	_bucketLen = other._bucketLen;
+	_min = other._min;
+	_max = other._max;
+	_sum = other._sum;
+	_count = other._count;
+	_totalMin = other._totalMin;
+	_totalMax = other._totalMax;
+	_totalSum = other._totalSum;
+	_totalCount = other._totalCount;
+	return *this;
+}
+
+HistoryQuery::~HistoryQuery() {}
+
+void HistoryQuery::start(uint8_t channel, time_t window) {
+	stop();
+	_channel = channel;
+	_to = now();
+	_from = _to - window;
+	_bucketLen = window / nPoints;
+	if (_bucketLen == 0)
+		_bucketLen = 1;
+	_bucketStart = _from;
+	_count = 0;
+	_totalCount = 0;
+	_hasRow = false;
+	_day = previousMidnight(_from);
+	_state = OpenDay;
+	Serial.println(reinterpret_cast<const __FlashStringHelper*>(historyHeaderTxt));
+}
+
+void HistoryQuery::stop() {
+	if (_file)
+		_file.close();
+	if (_index)
+		_index.close();
+	_state = Idle;
+}
+
+boolean HistoryQuery::busy() const {
+	return _state != Idle;
+}
+
+void HistoryQuery::process() {
+	for (uint8_t i = 0; i < _recordsPerCall; i++) {
+		if (_hasRow) {
+			//Buckets before row are complete
+			while (_rowTime >= _bucketStart + _bucketLen) {
+				if (!sendBucket())
+					return;
+			}
+			addRow();
+		}
+		switch (_state) {
+			case OpenDay:
+				//Today's file may still have data in RAM. SDLogger::process() writes it out
+				if (sdLogger.drain(_day))
+					//One file per call
+					openDay();
+				return;
+			case BuildIndex:
+				readCsv(true);
+				return;
+			case ReadRows:
+				if (_csv)
+					readCsv(false);
+				else
+					readRecords();
+				break;
+			case Finish:
+				while (_bucketStart < _to) {
+					if (!sendBucket())
+						return;
+				}
+				if (sendTotal())
+					stop();
+				return;
+			default:
+				return;
+		}
+	}
+}
+
+boolean HistoryQuery::parseWindow(const char *str, time_t &window) {
+	if ((str == NULL) || !isdigit(str[0]))
+		return false;
+	uint32_t n = 0;
+	while (isdigit(*str)) {
+		n = n * 10 + (*str - '0');
+		if (n > _maxWindow)
+			return false;
+		str++;
+	}
+	if (str[1] != '\0')
+		return false;
+	switch (str[0]) {
+		case 'm':
+			window = n * SECS_PER_MIN;
+			break;
+		case 'h':
+			window = n * SECS_PER_HOUR;
+			break;
+		case 'd':
+			window = n * SECS_PER_DAY;
+			break;
+		default:
+			return false;
+	}
+	return (window > 0) && (window <= _maxWindow);
+}
+
+void HistoryQuery::openDay() {
+	_csv = false;
+	_file = openFile(binExtension);
+	if (!_file) {
+		_csv = true;
+		_file = openFile(csvExtension);
+	}
+	if (!_file) {
+		endDay();
+		return;
+	}
+	_end = _file.size();
+	//Preallocated file being written is bigger than its data
+	uint32_t used = sdLogger.openFileLength(_day);
+	if ((used > 0) && (used < _end))
+		_end = used;
+
+	if (_csv) {
+		_index = openFile(idxExtension, fileUpdate);
+		resetRow();
+		_layout = CsvIndex::unknownLayout;
+		//No index: whole file is read
+		if (!_index) {
+			_file.seek(0);
+			_rowStart = 0;
+			_state = ReadRows;
+			return;
+		}
+		CsvIndex index;
+		if (_index.size() < sizeof(CsvIndex)) {
+			index.scanned = 0;
+			index.layout = CsvIndex::unknownLayout;
+			for (uint8_t i = 0; i < sizeof(index.reserved); i++)
+				index.reserved[i] = 0;
+			for (uint8_t h = 0; h < 24; h++)
+				index.offset[h] = CsvIndex::noRow;
+			_index.seek(0);
+			_index.write((const uint8_t*)&index, sizeof(CsvIndex));
+		} else {
+			_index.seek(0);
+			_index.read(&index, sizeof(CsvIndex));
+		}
+		_layout = index.layout;
+		//Rows added since index was last built are indexed first
+		if (index.scanned < _end) {
+			_file.seek(index.scanned);
+			_rowStart = index.scanned;
+			_lastHour = 0xFF;
+			_state = BuildIndex;
+		} else
+			seekCsv();
+		return;
+	}
+
+	LogFileHeader header;
+	if ((_file.read(&header, sizeof(LogFileHeader)) != sizeof(LogFileHeader)) || !header.valid()) {
+		endDay();
+		return;
+	}
+	//Last indexed hour up to window start. Earlier records are skipped while reading
+	uint8_t startHour = (_from > _day) ? hour(_from) : 0;
+	uint16_t n = 0;
+	for (uint8_t h = 0; h <= startHour; h++) {
+		if (header.hourIndex[h] != LogFileHeader::noRecord)
+			n = header.hourIndex[h];
+	}
+	_file.seek(LogFileHeader::recordOffset(n));
+	_state = ReadRows;
+}
+
+void HistoryQuery::readRecords() {
+	LogRecord record;
+	for (uint8_t i = 0; i < _recordsPerCall; i++) {
+		if ((_file.position() + sizeof(LogRecord) > _end)
+			|| (_file.read(&record, sizeof(LogRecord)) != sizeof(LogRecord))) {
+			endDay();
+			return;
+		}
+		//Padding of torn records is skipped too
+		if (!record.valid() || !(record.present & (1 << _channel)) || (record.time < _from))
+			continue;
+		if (record.time > _to) {
+			endDay();
+			return;
+		}
+		_rowTime = record.time;
+		_rowValue[0] = LogRecord::value(_channel, record.min[_channel]);
+		_rowValue[1] = LogRecord::value(_channel, record.max[_channel]);
+		_rowValue[2] = LogRecord::value(_channel, record.mean[_channel]);
+		_hasRow = true;
+		return;
+	}
+}
+
+void HistoryQuery::readCsv(boolean indexing) {
+	for (uint8_t i = 0; i < _charsPerCall; i++) {
+		int c = (_file.position() < _end) ? _file.read() : -1;
+		if (c < 0) {
+			if (indexing) {
+				//Up to the last complete row
+				_index.seek(0);
+				_index.write((const uint8_t*)&_rowStart, sizeof(_rowStart));
+				_index.write(_layout);
+				seekCsv();
+			} else
+				endDay();
+			return;
+		}
+		if (!feed(c))
+			continue;
+		uint32_t start = _rowStart;
+		_rowStart = _file.position();
+		if (!_header && (_hour < 24) && (_minute < 60)) {
+			if (indexing) {
+				//Rows are in time order, so only the first row of each hour looks at index
+				if (_hour != _lastHour) {
+					if (readOffset(_hour) == CsvIndex::noRow)
+						writeOffset(_hour, start);
+					_lastHour = _hour;
+				}
+			} else if (_found == 0x07) {
+				time_t t = _day + _hour * SECS_PER_HOUR + _minute * SECS_PER_MIN;
+				if (t > _to) {
+					endDay();
+					return;
+				}
+				if (t >= _from) {
+					_rowTime = t;
+					_hasRow = true;
+					resetRow();
+					return;
+				}
+			}
+		}
+		resetRow();
+	}
+}
+
+void HistoryQuery::seekCsv() {
+	//Last indexed hour up to window start. Earlier rows are skipped while reading
+	uint8_t startHour = (_from > _day) ? hour(_from) : 0;
+	uint32_t offset = 0;
+	for (uint8_t h = 0; h <= startHour; h++) {
+		uint32_t o = readOffset(h);
+		if (o != CsvIndex::noRow)
+			offset = o;
+	}
+	_index.close();
+	_file.seek(offset);
+	_rowStart = offset;
+	resetRow();
+	_state = ReadRows;
+}
+
+void HistoryQuery::endDay() {
+	if (_file)
+		_file.close();
+	if (_index)
+		_index.close();
+	_day += SECS_PER_DAY;
+	_state = (_day > _to) ? Finish : OpenDay;
+}
+
+void HistoryQuery::resetRow() {
+	_field = 0;
+	_num = 0;
+	_digits = false;
+	_decimals = 0xFF;
+	_neg = false;
+	_header = false;
+	_hour = 0xFF;
+	_minute = 0xFF;
+	_found = 0;
+}
+
+boolean HistoryQuery::feed(char c) {
+	if (c == '\r')
+		return false;
+	if (c == '\n') {
+		endField();
+		return true;
+	}
+	if (c == ',') {
+		endField();
+		_field++;
+		return false;
+	}
+	//Column names row. Its third one tells the layout
+	if ((_field == 0) && !_digits && isalpha(c)) {
+		_header = true;
+		_layout = CsvIndex::valueLayout;
+	}
+	if (_header) {
+		if ((_field == 2) && (c == 'S'))
+			_layout = CsvIndex::summaryLayout;
+		return false;
+	}
+	if ((c == ':') && (_field == 1)) {
+		if (_digits)
+			_hour = _num;
+		_num = 0;
+		_digits = false;
+	} else if (c == '-')
+		_neg = true;
+	else if (c == '.')
+		_decimals = 0;
+	else if (isdigit(c)) {
+		//Hundredths at most
+		if (_decimals == 0xFF)
+			_num = _num * 10 + (c - '0');
+		else if (_decimals < 2) {
+			_num = _num * 10 + (c - '0');
+			_decimals++;
+		}
+		_digits = true;
+	}
+	return false;
+}
+
+void HistoryQuery::endField() {
+	if (!_header && _digits) {
+		if (_field == 1)
+			_minute = _num;
+		else if (_field >= 2) {
+			//To hundredths and then to channel's fixed-point
+			int32_t v = _num;
+			for (uint8_t dec = (_decimals == 0xFF) ? 0 : _decimals; dec < 2; dec++)
+				v *= 10;
+			if (_neg)
+				v = -v;
+			if ((_channel != 0) && (_channel != 4))
+				v /= 100;
+			for (uint8_t k = 0; k < 3; k++) {
+				if (_field == column(k)) {
+					_rowValue[k] = v;
+					_found |= (1 << k);
+				}
+			}
+		}
+	}
+	_num = 0;
+	_digits = false;
+	_decimals = 0xFF;
+	_neg = false;
+}
+
+uint8_t HistoryQuery::column(uint8_t which) const {
+	//Single value is min, max and mean
+	if (_layout == CsvIndex::valueLayout)
+		return 2 + _channel;
+	return 3 + _channel * 4 + 1 + which;
+}
+
+uint32_t HistoryQuery::readOffset(uint8_t h) {
+	uint32_t offset = CsvIndex::noRow;
+	_index.seek(offsetof(CsvIndex, offset) + h * sizeof(uint32_t));
+	_index.read(&offset, sizeof(offset));
+	return offset;
+}
+
+void HistoryQuery::writeOffset(uint8_t h, uint32_t offset) {
+	_index.seek(offsetof(CsvIndex, offset) + h * sizeof(uint32_t));
+	_index.write((const uint8_t*)&offset, sizeof(offset));
+}
+
+void HistoryQuery::addRow() {
+	if ((_count == 0) || (_rowValue[0] < _min))
+		_min = _rowValue[0];
+	if ((_count == 0) || (_rowValue[1] > _max))
+		_max = _rowValue[1];
+	if (_count == 0)
+		_sum = 0;
+	_sum += _rowValue[2];
+	_count++;
+	_hasRow = false;
+}
+
+//"> DD-MM HH:MM min max mean" or "> DD-MM HH:MM -" if bucket has no records
+boolean HistoryQuery::sendBucket() {
+	if (room() < _maxLine)
+		return false;
+	Serial.print(F("> "));
+	TextFormat::printUInt(Serial, day(_bucketStart), 2, '0');
+	Serial.print('-');
+	TextFormat::printUInt(Serial, month(_bucketStart), 2, '0');
+	Serial.print(' ');
+	TextFormat::printUInt(Serial, hour(_bucketStart), 2, '0');
+	Serial.print(':');
+	TextFormat::printUInt(Serial, minute(_bucketStart), 2, '0');
+	if (_count == 0)
+		Serial.println(F(" -"));
+	else {
+		Serial.print(' ');
+		LogRecord::printValue(Serial, _channel, _min);
+		Serial.print(' ');
+		LogRecord::printValue(Serial, _channel, _max);
+		Serial.print(' ');
+		LogRecord::printValue(Serial, _channel, mean(_sum, _count));
+		Serial.println();
+		if ((_totalCount == 0) || (_min < _totalMin))
+			_totalMin = _min;
+		if ((_totalCount == 0) || (_max > _totalMax))
+			_totalMax = _max;
+		if (_totalCount == 0)
+			_totalSum = 0;
+		_totalSum += _sum;
+		_totalCount += _count;
+	}
+	_bucketStart += _bucketLen;
+	_count = 0;
+	return true;
+}
+
+//"> Min/Max/Mean: min/max/mean (records)"
+boolean HistoryQuery::sendTotal() {
+	if (room() < _maxLine + 20)
+		return false;
+	Serial.print(reinterpret_cast<const __FlashStringHelper*>(historyTotalTxt));
+	if (_totalCount == 0) {
+		Serial.println('-');
+		return true;
+	}
+	LogRecord::printValue(Serial, _channel, _totalMin);
+	Serial.print('/');
+	LogRecord::printValue(Serial, _channel, _totalMax);
+	Serial.print('/');
+	LogRecord::printValue(Serial, _channel, mean(_totalSum, _totalCount));
+	Serial.print(F(" ("));
+	TextFormat::printUInt(Serial, _totalCount);
+	Serial.println(')');
+	return true;
+}
+
+//Rounded to nearest
+int32_t HistoryQuery::mean(int32_t sum, uint32_t count) {
+	int32_t half = (sum < 0) ? -(int32_t)(count / 2) : count / 2;
+	return (sum + half) / (int32_t)count;
+}
+
+File HistoryQuery::openFile(const char *pmExtension, uint8_t mode) {
+	char fileNameArray[13];
+	CharBuffer fileName(fileNameArray, sizeof(fileNameArray));
+	SDLogger::printFileName(fileName, _day, pmExtension);
+	return SD.open(fileNameArray, mode);
+}
+
+int HistoryQuery::room() {
+	return Serial.availableForWrite();
+}
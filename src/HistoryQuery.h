@@ -0,0 +1,178 @@
+// #############################################################################
+//
+// # Name       : HistoryQuery
+//
+// # Description: Min/max/mean of a sensor over a past time window, from the SD logs
+// # Window is split in nPoints buckets, each sent through serial as soon as it's
+// # complete, followed by the figures of the whole window. Only records inside the
+// # window are read: .bin day files are entered through their hour index and .csv
+// # ones through a YYYYMMDD.idx file with the offset of each hour's first row,
+// # built the first time a file is queried and extended as it grows.
+// # Work is done in small steps from process(), once per loop, and RAM use doesn't
+// # depend on window length.
+//
+// #  This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// #############################################################################
+
+#ifndef HISTORYQUERY_H
+#define HISTORYQUERY_H
+
+#include <Arduino.h>
+#include <SD.h>
+#include <Time.h>
+#include <TextFormat.h>
+#include "LogFormat.h"
+#include "SDLogger.h"
+
+const char idxExtension[] PROGMEM = ".idx";
+const char historyHeaderTxt[] PROGMEM = "> Time: min max mean";
+const char historyTotalTxt[] PROGMEM = "> Min/Max/Mean: ";
+
+extern SDLogger sdLogger;
+
+//YYYYMMDD.idx contents
+struct CsvIndex {
+	//Csv layouts
+	static const uint8_t unknownLayout = 0;
+	//Date,Time,Samples and then Last,Min,Max,Mean of each sensor
+	static const uint8_t summaryLayout = 1;
+	//Date,Time and a value of each sensor
+	static const uint8_t valueLayout = 2;
+	//offset value of hours with no rows
+	static const uint32_t noRow = 0xFFFFFFFF;
+
+	//Csv bytes indexed, always up to the end of a row
+	uint32_t scanned;
+	uint8_t layout;
+	uint8_t reserved[3];
+	//Offset of first row of each hour
+	uint32_t offset[24];
+} __attribute__ ((packed));
+
+class HistoryQuery {
+	public:
+		//Buckets window is split in
+		static const uint8_t nPoints = 24;
+
+		HistoryQuery();
+		HistoryQuery(const HistoryQuery &other);
+		HistoryQuery& operator=(const HistoryQuery &other);
+		~HistoryQuery();
+
+		//Starts a query of a LogRecord channel over the last window seconds.
+		//Stops any other
+		void start(uint8_t channel, time_t window);
+		void stop();
+		boolean busy() const;
+		//Reads a few records and sends what's ready. Call it once per loop
+		void process();
+		//Parses "<n>m", "<n>h" or "<n>d", up to 7 days, into seconds
+		static boolean parseWindow(const char *str, time_t &window);
+
+	private:
+		//Keeps window sums of 16 bit values from overflowing
+		static const time_t _maxWindow = 7 * SECS_PER_DAY;
+		enum State {
+			Idle = 0,
+			OpenDay,
+			BuildIndex,
+			ReadRows,
+			Finish
+		};
+		//Longest line sent: "> DD-MM HH:MM -327.68 -327.68 -327.68"
+		static const uint8_t _maxLine = 40;
+		//Work per process() call
+		static const uint8_t _recordsPerCall = 8;
+		static const uint8_t _charsPerCall = 128;
+
+		State _state;
+		uint8_t _channel;
+		time_t _from;
+		time_t _to;
+		//Day being read
+		time_t _day;
+		File _file;
+		File _index;
+		boolean _csv;
+		//End of data in file
+		uint32_t _end;
+
+		//Csv parsing
+		uint8_t _layout;
+		//Offset of row being parsed
+		uint32_t _rowStart;
+		uint8_t _field;
+		int32_t _num;
+		boolean _digits;
+		//Digits after '.', 0xFF before it
+		uint8_t _decimals;
+		boolean _neg;
+		boolean _header;
+		//Hour and minute of row, 0xFF until read
+		uint8_t _hour;
+		uint8_t _minute;
+		//Bits 0..2 tell which of min, max and mean the row had
+		uint8_t _found;
+		//Index build: last hour seen
+		uint8_t _lastHour;
+
+		//Row read ahead, waiting for its bucket
+		boolean _hasRow;
+		time_t _rowTime;
+		int32_t _rowValue[3];
+
+		//Current bucket and whole window
+		time_t _bucketStart;
+		time_t _bucketLen;
+		int32_t _min;
+		int32_t _max;
+		int32_t _sum;
+		uint16_t _count;
+		int32_t _totalMin;
+		int32_t _totalMax;
+		int32_t _totalSum;
+		uint32_t _totalCount;
+
+		//Opens .bin or .csv of _day and goes to the first hour of window in it
+		void openDay();
+		//Binary files: next valid record with channel into row
+		void readRecords();
+		//Csv files: parses rows into row, or into index while building it
+		void readCsv(boolean indexing);
+		//Goes to the first row of the window's start hour using index
+		void seekCsv();
+		void endDay();
+		//Parser
+		void resetRow();
+		//Returns true when c ends a row
+		boolean feed(char c);
+		void endField();
+		//Column of channel's min, max or mean (which is 0, 1 or 2)
+		uint8_t column(uint8_t which) const;
+		//Index entry of hour h
+		uint32_t readOffset(uint8_t h);
+		void writeOffset(uint8_t h, uint32_t offset);
+		//Adds row to bucket
+		void addRow();
+		//Sends current bucket and moves to the next. False if there's no room for it yet
+		boolean sendBucket();
+		boolean sendTotal();
+		static int32_t mean(int32_t sum, uint32_t count);
+		//Opens file of _day with an extension
+		File openFile(const char *pmExtension, uint8_t mode = FILE_READ);
+		static int room();
+};
+
+#endif
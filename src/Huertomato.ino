@@ -54,10 +54,19 @@
 #include "Settings.h"
 #include "Sensors.h"
 #include "SerialInterface.h"
+#include "Profiler.h"
+#include "MemoryMonitor.h"
+#include "SDLogger.h"
+#include "SensorAggregate.h"
+#include "SensorSeries.h"
+#include "RollupLogger.h"
+#include "LogExport.h"
+#include "HistoryQuery.h"
 #include "Window.h"
 #include "WinAlarms.h"
 #include "WinControllerMenu.h"
 #include "WinControllerMenuTwo.h"
+#include "WinDiagnostics.h"
 #include "WinEcAlarms.h"
 #include "WinEcCalib.h"
 #include "WinLvlAlarms.h"
@@ -79,6 +88,7 @@
 #include <SPI.h>
 #include <Wire.h>
 #include <DS1307RTC.h>
+#include <TextFormat.h>
 #include <DHT11.h>
 #include <OneWire.h>
 #include <DallasTemperature.h>
@@ -99,6 +109,7 @@ const float versionNumber = 1.6;
 // TEXTS STORED IN FLASH MEMORY
 // *********************************************
 const char defaultsLoaded[] PROGMEM = "Reset settings to default.";
+const char settingsMigratedTxt[] PROGMEM = "Settings upgraded from older firmware.";
 const char rtcResetTxt[] PROGMEM = "RTC time has been recently reset. Manual adjustment needed.";
 const char rtcInitOkTxt[] PROGMEM = "RTC init OK.";
 const char rtcInitFailTxt[] PROGMEM = "RTC init FAIL! < --";
@@ -172,6 +183,16 @@ Settings settings;
 Sensors sensors(&settings);
 //Human views
 SerialInterface ui; //&sensors,&settings are also used but from global var
+SerialTransmitter serialTx;
+//SD card log writer, current log interval and hourly/daily summaries
+SDLogger sdLogger(SDLogger::Preallocated);
+SensorAggregate logInterval;
+RollupLogger rollups;
+//Last day or so of every sensor, kept in RAM for trend views
+SensorSeries sensorSeries;
+//Sends logs and past sensor figures through serial
+LogExport logExport;
+HistoryQuery history;
 GUI gui(&LCD,&Touch,&sensors,&settings);
 
 //Stores timers ID's and status
@@ -199,11 +220,12 @@ void setup() {
 	led.setOn();
 	ui.init();
 	gui.init();
-	//Reset to default settings if EEPROM version differs from code version
-	if (settings.getVersion() != versionNumber) {
-		settings.loadDefaults();
-		ui.timeStamp(defaultsLoaded);
-	}
+	//Brings settings stored by older firmware up to date, or loads defaults if there are none
+	SettingsStore::Result loaded = settings.upgrade();
+	if (loaded == SettingsStore::Empty)
+		LOG_WARNING(System,defaultsLoaded);
+	else if (loaded == SettingsStore::Migrated)
+		LOG_INFO(System,settingsMigratedTxt);
 	//Actuators
 	pinMode(buzzPin, OUTPUT);
 	pinMode(waterPump, OUTPUT);
@@ -231,11 +253,11 @@ void setupRTC() {
 	if ((timeStatus() == timeSet) && (d == 1) && (mo == 1) && (y = 2000)) {
 		//This prevents a bug when time resets and then loops 00:00 - 00:05
 		settings.setRTCtime(10,10,10,10,10,2010);
-		ui.timeStamp(rtcResetTxt);
+		LOG_WARNING(System,rtcResetTxt);
 	} else if (timeStatus() == timeSet)
-		ui.timeStamp(rtcInitOkTxt);
+		LOG_INFO(System,rtcInitOkTxt);
 	if (timeStatus() != timeSet)
-		ui.timeStamp(rtcInitFailTxt);
+		LOG_ERROR(System,rtcInitFailTxt);
 }
 
 //Inits SD card and creates timer for SD logs
@@ -246,9 +268,9 @@ void setupSD() {
 			sdInit = true;
 			//Timer to log sensor data to SD Card
 			startSDlogTimer();
-			ui.timeStamp(sdInitOkTxt);
+			LOG_INFO(SDCard,sdInitOkTxt);
 		} else 
-			ui.timeStamp(sdInitFailTxt);
+			LOG_ERROR(SDCard,sdInitFailTxt);
 	}
 }
 
@@ -269,19 +291,19 @@ void setupAlarms() {
 void setupWaterModes() {
 	//Not if pump protection activated
 	if (settings.getPumpProtected())
-		ui.timeStamp(noWaterTxt);
+		LOG_WARNING(Water,noWaterTxt);
 	//Not if stopped watering for the night
 	else if (settings.getNightWateringStopped())
-		ui.timeStamp(nightStoppedTxt);
+		LOG_INFO(Water,nightStoppedTxt);
 	else {
 		if (settings.getWaterTimed()) {
 			startWaterTimer();
 			updateNextWateringTime();
-			ui.timeStamp(waterTimedTxt);
+			LOG_INFO(Water,waterTimedTxt);
 		} else {
 			digitalWrite(waterPump,HIGH);
 			settings.setWateringPlants(true);
-			ui.timeStamp(waterContinuousTxt);
+			LOG_INFO(Water,waterContinuousTxt);
 		}
 	}
 }
@@ -324,23 +346,35 @@ void initMusic() {
 // LOOP
 // *********************************************
 void loop() {
-	ui.processInput();
-	gui.refresh();
-	gui.processInput();
+	PROFILE_SCOPE(Loop);
+	PROFILE(SerialInput, ui.processInput());
+	PROFILE(GuiRefresh, gui.refresh());
+	PROFILE(GuiInput, gui.processInput());
 	
 	//Check if led needs color change
-	checkLed();
+	PROFILE(Led, checkLed());
 	//Check if pump protection toggled
-	checkPump();
+	PROFILE(Pump, checkPump());
 	//Trigger alarm if needed
-	checkAlarms();
+	PROFILE(Alarms, checkAlarms());
 	//Check if night time has come and system change necessary
-	checkNightTime();
+	PROFILE(NightTime, checkNightTime());
 	//Checks if settings have changed and system needs updating
-	checkSettingsChanged();
+	PROFILE(SettingsChanged, checkSettingsChanged());
+	//Writes settings changed while EEPROM was busy
+	settings.process();
+	//Writes buffered log data and finished summaries to SD card when due
+	PROFILE(SDWrite, writeSD());
+	//Sends log files through serial, as much as TX buffer takes
+	PROFILE(LogExport, logExport.process());
+	//Answers history queries from SD logs
+	PROFILE(History, history.process());
+	//Keeps lowest free memory seen
+	MemoryMonitor::update();
 	
-	//Delays are needed for alarms to work
-	Alarm.delay(10);
+	//Delays are needed for alarms to work.
+	//Kept short while sending logs or console output so TX buffer is refilled before it runs dry
+	PROFILE(AlarmDelay, Alarm.delay((logExport.busy() || history.busy() || serialTx.queued()) ? 1 : 10));
 }
 
 // *********************************************
@@ -380,7 +414,7 @@ void checkPump() {
 			settings.setPumpProtected(false);
 			stopSerialPumpProtTimer();
 			if (settings.getSerialDebug())
-				ui.timeStamp(pumpOnTxt);
+				LOG_WARNING(Water,pumpOnTxt);
 	}
 }
 
@@ -395,6 +429,7 @@ void checkAlarms() {
 				settings.setAlarmTriggered(true);
 				if (settings.getSerialDebug()) {
 					printAlarm();
+					ui.alarm(sensors.alarmState());
 					startSerialAlarmTimer();
 				}
 		//Theres an alarm triggered but everything is ok
@@ -402,8 +437,10 @@ void checkAlarms() {
 			&& (!sensors.ecOffRange() && !sensors.phOffRange() && !sensors.lvlOffRange())) {		
 				settings.setAlarmTriggered(false);
 				stopSerialAlarmTimer();
-				if (settings.getSerialDebug())
-					ui.timeStamp(alarmOffTxt);
+				if (settings.getSerialDebug()) {
+					LOG_WARNING(Alarms,alarmOffTxt);
+					ui.alarm(0);
+				}
 		}
 		checkSoundAlarm();
 	}
@@ -457,15 +494,23 @@ void checkWater() {
 	}
 }
 
+//Runs SD writers' steps. Sensor timers only queue their data
+void writeSD() {
+	sdLogger.process();
+	rollups.process();
+}
+
 //Checks if SD settings have been changed and updates system
 void checkSD() {
 	if (settings.sdSettingsChanged()) {
 		stopSDlogTimer();
+		sdLogger.close();
+		rollups.close();
 		if (settings.getSDactive()) {
 			setupSD();
-			ui.timeStamp(sdLogOnTxt);
+			LOG_INFO(SDCard,sdLogOnTxt);
 		} else
-			ui.timeStamp(sdLogOffTxt);
+			LOG_INFO(SDCard,sdLogOffTxt);
 	}
 }
 
@@ -475,7 +520,7 @@ void checkSensors() {
 		Alarm.free(sensorAlarm.id);
 		sensorAlarm.id = Alarm.timerOnce(0,0,settings.getSensorSecond(),updateSensors);
 		sensorAlarm.enabled = true;
-		ui.timeStamp(pollingUpdateTxt);
+		LOG_INFO(Sensors,pollingUpdateTxt);
 	}
 }
 
@@ -489,79 +534,59 @@ void checkSerial() {
 // SD AND SERIAL LOG FUNCTIONS
 // *********************************************
 //Logs system data to SDCard
-//File name will be: YYYMMDD.csv
-//Format is: Date,Time,Temp,Humidity,Light,EC,PH,WaterLevel
+//File name will be: YYYYMMDD.bin, see LogFormat.h. Or YYYYMMDD.csv in Csv format:
+//Date,Time,Temp,Humidity,Light,EC,PH,WaterLevel,MinFree,MaxStack,Fragmentation
 void logSensorReadings() {
+	PROFILE_SCOPE(LogSensorReadings);
 	time_t t = now();
-	int d = day(t);
-	int mo = month(t);
-	int y = year(t);
-	int h = hour(t);
-	int m = minute(t);
-	
-	//Filename must be at MAX 8chars + "." + 3chars
-	//We choose it to be YYYY+MM+DD.csv
-	String fileName = "";
-	fileName.reserve(12);
-	fileName = (String)y + ((mo<10)?"0":"") + (String)mo + ((d<10)?"0":"") + (String)d + ".csv";
-	char fileNameArray[fileName.length() + 1];
-	fileName.toCharArray(fileNameArray, sizeof(fileNameArray));
-	File sensorLog = SD.open(fileNameArray, FILE_WRITE);
+	LogRecord record;
+	logInterval.toRecord(record, t);
+	//Memory telemetry
+	record.minFree = MemoryMonitor::minFreeMemory();
+	record.maxStack = MemoryMonitor::maxStackUsed();
+	record.fragmentation = MemoryMonitor::fragmentation();
+	record.seal();
+	logInterval.reset(t);
 	
-	if (sensorLog) {
-		//Date
-		(d < 10) ? sensorLog.print("0") : 0;
-		sensorLog.print(d);
-		sensorLog.print("-");
-		(mo < 10) ? sensorLog.print("0") : 0;
-		sensorLog.print(mo);
-		sensorLog.print("-");
-		sensorLog.print(y);
-		sensorLog.print(",");
-		//Time
-		(h < 10) ? sensorLog.print("0") : 0;
-		sensorLog.print(h);
-		sensorLog.print(":");
-		(m < 10) ? sensorLog.print("0") : 0;
-		sensorLog.print(m);
-		sensorLog.print(",");
-		//Sensors
-		sensorLog.print(sensors.getTemp());
-		sensorLog.print(",");
-		sensorLog.print(sensors.getHumidity());
-		sensorLog.print(",");
-		sensorLog.print(sensors.getLight());
-		sensorLog.print(",");
-		
-		if (settings.getReservoirModule()) {
-			sensorLog.print(sensors.getEC());
-			sensorLog.print(",");
-			sensorLog.print(sensors.getPH());
-			sensorLog.print(",");
-			sensorLog.print(sensors.getWaterLevel());
-			sensorLog.print(",");
-		}
-		
-		//sensorLog << ((d<10)?"0":"") << d << "-" << ((mo<10)?"0":"") << mo << "-" << y << ",";
-		//sensorLog << ((h<10)?"0":"") << h << ":" << ((m<10)?"0":"") << m;
-		//sensorLog << "," << sensors.getTemp() << "," << sensors.getHumidity();
-		//sensorLog << "," << sensors.getLight() << "," << sensors.getEC();
-		//sensorLog << "," << sensors.getPH() << "," << sensors.getWaterLevel() << endl;
-		sensorLog.close();
+	//Record goes to RAM buffer, sdLogger.process() writes it to card
+	if (sdLogger.log(record))
 		//Inform through serial
-		ui.timeStamp(sdLogOk);
-	} else
-		ui.timeStamp(sdLogFail);
+		LOG_INFO(SDCard,sdLogOk);
+	else
+		LOG_ERROR(SDCard,sdLogFail);
+}
+
+//Current sensor values in LogRecord fixed-point
+void readSample(SensorSample &sample) {
+	sample.time = now();
+	sample.present = LogRecord::tempBit | LogRecord::humidityBit | LogRecord::lightBit;
+	if (!settings.getCelsius())
+		sample.present |= LogRecord::fahrenheitBit;
+	sample.alarms = sensors.alarmState();
+	sample.value[0] = TextFormat::toFixed(sensors.getTemp(), 2);
+	sample.value[1] = sensors.getHumidity();
+	sample.value[2] = sensors.getLight();
+	if (settings.getReservoirModule()) {
+		sample.present |= LogRecord::ecBit | LogRecord::phBit | LogRecord::levelBit;
+		sample.value[3] = TextFormat::toFixed(sensors.getEC(), 0);
+		sample.value[4] = TextFormat::toFixed(sensors.getPH(), 2);
+		sample.value[5] = sensors.getWaterLevel();
+	} else {
+		sample.value[3] = 0;
+		sample.value[4] = 0;
+		sample.value[5] = 0;
+	}
 }
 
-//Timestamps to Serial that there's an alarm triggered
 void printAlarm() {
-	ui.timeStamp(alarmTxT);
+	PROFILE_SCOPE(SerialAlarm);
+	LOG_ERROR(Alarms,alarmTxT);
 }
 
 //Timestamps to Serial if pump protection toggled
 void printPump() {
-	ui.timeStamp(noWaterTxt);
+	PROFILE_SCOPE(SerialAlarm);
+	LOG_WARNING(Water,noWaterTxt);
 }
 
 // *********************************************
@@ -569,9 +594,21 @@ void printPump() {
 // *********************************************
 //Updates sensor readings and sets next timer
 void updateSensors() {
+	PROFILE_SCOPE(UpdateSensors);
 	sensors.update();
+	SensorSample sample;
+	readSample(sample);
+	sensorSeries.add(sample);
+	ui.watch(sample);
+	//Every smoothed sample goes into the log interval and hourly/daily summaries
+	if (sdAlarm.enabled) {
+		logInterval.add(sample);
+		//Those are queued when their hour or day ends, writeSD() appends them
+		if (!rollups.add(sample))
+			LOG_ERROR(SDCard,sdLogFail);
+	}
 	gui.refresh();
-	//ui.timeStamp(sensorsReadTxt);
+	LOG_DEBUG(Sensors,sensorsReadTxt);
 	//Set next timer
 	sensorAlarm.id = Alarm.timerOnce(0,0,settings.getSensorSecond(),updateSensors);
 	sensorAlarm.enabled = true;
@@ -579,9 +616,10 @@ void updateSensors() {
 
 //Adjusts EC sensor readings to temperature and sets next timer
 void adjustECtemp() {
+	PROFILE_SCOPE(AdjustECtemp);
 	if (gui.isMainScreen()) {
 		sensors.adjustECtemp();
-		ui.timeStamp(ecAdjTxt);
+		LOG_INFO(Sensors,ecAdjTxt);
 	}
 	//Set next timer
 	Alarm.timerOnce(0,10,0,adjustECtemp);
@@ -589,9 +627,10 @@ void adjustECtemp() {
 
 //Adjusts pH sensor readings to temperature and sets next timer
 void adjustPHtemp() {
+	PROFILE_SCOPE(AdjustPHtemp);
 	if (gui.isMainScreen()) {
 		sensors.adjustPHtemp();
-		ui.timeStamp(phAdjTxt);
+		LOG_INFO(Sensors,phAdjTxt);
 	}
 	//Set next timer
 	Alarm.timerOnce(0,10,0,adjustPHtemp);
@@ -599,12 +638,14 @@ void adjustPHtemp() {
 
 //These handle beeping when an alarm is triggered.
 void beepOn() {
+	PROFILE_SCOPE(Beep);
 	const int onSecs = 1;
 	tone(buzzPin,440.00);
 	Alarm.timerOnce(0,0,onSecs,beepOff);
 }
 
 void beepOff() {
+	PROFILE_SCOPE(Beep);
 	const int offSecs = 2;
 	noTone(buzzPin);
 	if ((settings.getAlarmTriggered() || settings.getPumpProtected()) 
@@ -652,6 +693,7 @@ void startSDlogTimer() {
 	if (!sdAlarm.enabled) {
 		sdAlarm.id = Alarm.timerRepeat(settings.getSDhour(),settings.getSDminute(),0,logSensorReadings);
 		sdAlarm.enabled = true;
+		logInterval.reset(now());
 	}
 }
 
@@ -695,12 +737,13 @@ void stopWaterOffTimer() {
 // TIMED WATERING ROUTINES
 // *********************************************
 void startWatering() {
+	PROFILE_SCOPE(Watering);
 	updateNextWateringTime();	
 	//Only water if pump protection is off & not night 
 	if (!settings.getPumpProtected() && !settings.getNightWateringStopped()) {
 		digitalWrite(waterPump, HIGH);
 		settings.setWateringPlants(true);
-		ui.timeStamp(waterStartTxt);
+		LOG_INFO(Water,waterStartTxt);
 		//Creates timer to stop watering
 		stopWaterOffTimer();
 		startWaterOffTimer();	
@@ -709,8 +752,9 @@ void startWatering() {
 
 //Stops watering pump and updates system status
 void stopWatering() {
+	PROFILE_SCOPE(Watering);
 	stopWaterOffTimer();
 	digitalWrite(waterPump, LOW);
 	settings.setWateringPlants(false);
-	ui.timeStamp(waterStopTxt);
+	LOG_INFO(Water,waterStopTxt);
 }
\ No newline at end of file
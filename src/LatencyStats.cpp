@@ -0,0 +1,124 @@
+#include "LatencyStats.h"
+
+LatencyStats::LatencyStats(uint16_t firstLimit) : _firstLimit(firstLimit) {
+	reset();
+}
+
+LatencyStats::LatencyStats(const LatencyStats &other) {
+	*this = other;
+}
+
+LatencyStats& LatencyStats::operator=(const LatencyStats &other) {
+	_total = other._total;
+	_min = other._min;
+	_max = other._max;
+	_count = other._count;
+	_firstLimit = other._firstLimit;
+	for (uint8_t i = 0; i < nBins; i++)
+		_hist[i] = other._hist[i];
+	return *this;
+}
+
+LatencyStats::~LatencyStats() {}
+
+void LatencyStats::add(uint32_t elapsed) {
+	//Halve everything before a counter overflows. Keeps mean and histogram shape
+	if ((_count == 0xFFFF) || (_total > 0xFFFFFFFF - elapsed)) {
+		//Drop one mean sample first so halving an odd count doesn't skew the mean
+		if (_count & 1) {
+			_total -= _total / _count;
+			_count--;
+		}
+		_count >>= 1;
+		_total >>= 1;
+		for (uint8_t i = 0; i < nBins; i++)
+			_hist[i] >>= 1;
+	}
+	if ((_count == 0) || (elapsed < _min))
+		_min = elapsed;
+	if (elapsed > _max)
+		_max = elapsed;
+	_total += elapsed;
+	_count++;
+
+	uint8_t bin = 0;
+	uint32_t limit = _firstLimit;
+	while ((elapsed >= limit) && (bin < nBins - 1)) {
+		limit <<= 1;
+		bin++;
+	}
+	_hist[bin]++;
+}
+
+void LatencyStats::reset() {
+	_total = 0;
+	_min = 0;
+	_max = 0;
+	_count = 0;
+	for (uint8_t i = 0; i < nBins; i++)
+		_hist[i] = 0;
+}
+
+uint16_t LatencyStats::getCount() const { return _count; }
+
+uint32_t LatencyStats::getMin() const { return _min; }
+
+uint32_t LatencyStats::getMean() const {
+	return (_count == 0) ? 0 : _total / _count;
+}
+
+uint32_t LatencyStats::getMax() const { return _max; }
+
+uint32_t LatencyStats::percentile(uint8_t p) const {
+	//Halving may leave bins summing a bit below count
+	uint32_t total = 0;
+	for (uint8_t i = 0; i < nBins; i++)
+		total += _hist[i];
+	if (total == 0)
+		return 0;
+	uint32_t target = (total * p + 99) / 100;
+	uint32_t seen = 0;
+	uint32_t limit = _firstLimit;
+	for (uint8_t i = 0; i < nBins - 1; i++) {
+		seen += _hist[i];
+		if (seen >= target)
+			return (limit < _max) ? limit : _max;
+		limit <<= 1;
+	}
+	return _max;
+}
+
+void LatencyStats::print(Print &out) const {
+	TextFormat::printUInt(out, _count);
+	out.print(' ');
+	TextFormat::printUInt(out, _min);
+	out.print('/');
+	TextFormat::printUInt(out, getMean());
+	out.print('/');
+	TextFormat::printUInt(out, _max);
+	out.print(' ');
+	TextFormat::printUInt(out, percentile(50));
+	out.print('/');
+	TextFormat::printUInt(out, percentile(90));
+	out.print('/');
+	TextFormat::printUInt(out, percentile(99));
+}
+
+void LatencyStats::printHistogram(Print &out) const {
+	uint32_t limit = _firstLimit;
+	for (uint8_t i = 0; i < nBins; i++) {
+		if (_hist[i] != 0) {
+			out.print(' ');
+			if (i == nBins - 1) {
+				out.print('>');
+				TextFormat::printUInt(out, limit >> 1);
+			} else {
+				out.print('<');
+				TextFormat::printUInt(out, limit);
+			}
+			out.print(':');
+			TextFormat::printUInt(out, _hist[i]);
+		}
+		limit <<= 1;
+	}
+}
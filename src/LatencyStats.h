@@ -0,0 +1,66 @@
+// #############################################################################
+//
+// # Name       : LatencyStats
+//
+// # Description: Latency statistics in constant RAM
+// # Keeps count, min, mean and max of measured times in us plus a log2 histogram,
+// # from which percentiles are estimated. Counters halve before overflowing, so it
+// # can run forever with recent history weighing more. Used by SDLogger for block
+// # writes and by Profiler for every loop phase.
+//
+// #  This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// #############################################################################
+
+#ifndef LATENCYSTATS_H
+#define LATENCYSTATS_H
+
+#include <Arduino.h>
+#include <TextFormat.h>
+
+class LatencyStats {
+	public:
+		//Histogram bin i counts times below firstLimit << i us. Last one holds everything above
+		static const uint8_t nBins = 16;
+		static const uint16_t defaultFirstLimit = 128;
+
+		LatencyStats(uint16_t firstLimit = defaultFirstLimit);
+		LatencyStats(const LatencyStats &other);
+		LatencyStats& operator=(const LatencyStats &other);
+		~LatencyStats();
+
+		//Adds a measurement in us
+		void add(uint32_t elapsed);
+		void reset();
+		uint16_t getCount() const;
+		uint32_t getMin() const;
+		uint32_t getMean() const;
+		uint32_t getMax() const;
+		//Upper limit of the bin where p% of the measurements are reached, never above max
+		uint32_t percentile(uint8_t p) const;
+		//"count min/mean/max p50/p90/p99" in us
+		void print(Print &out) const;
+		//Non empty bins as " <limit:count", last one as " >limit:count"
+		void printHistogram(Print &out) const;
+
+	private:
+		uint32_t _total;
+		uint32_t _min;
+		uint32_t _max;
+		uint16_t _count;
+		uint16_t _firstLimit;
+		uint16_t _hist[nBins];
+};
+
+#endif
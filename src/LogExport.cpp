@@ -0,0 +1,167 @@
+#include "LogExport.h"
+
+LogExport::LogExport() : _mode(Idle), _day(0), _lastDay(0), _remaining(0) {}
+
+LogExport::LogExport(const LogExport &other) {
+	*this = other;
+}
+
+LogExport& LogExport::operator=(const LogExport &other) {
+	_mode = other._mode;
+	_file = other._file;
+	_day = other._day;
+	_lastDay = other._lastDay;
+	_remaining = other._remaining;
+	return *this;
+}
+
+LogExport::~LogExport() {}
+
+boolean LogExport::list() {
+	stop();
+	char root[2];
+	strncpy_P(root, exportRootDir, sizeof(root));
+	_file = SD.open(root);
+	if (!_file)
+		return false;
+	_file.rewindDirectory();
+	_mode = Listing;
+	return true;
+}
+
+boolean LogExport::range(time_t from, time_t to) {
+	stop();
+	_day = previousMidnight(from);
+	_lastDay = previousMidnight(to);
+	_mode = Sending;
+	return true;
+}
+
+void LogExport::stop() {
+	if (_file)
+		_file.close();
+	_mode = Idle;
+}
+
+boolean LogExport::busy() const {
+	return _mode != Idle;
+}
+
+void LogExport::process() {
+	if (_mode == Listing) {
+		if (room() >= _maxLine)
+			listNext();
+		return;
+	}
+	if (_mode != Sending)
+		return;
+	if (!_file) {
+		if (room() < _maxLine)
+			return;
+		//Today's file may still have data in RAM. SDLogger::process() writes it out
+		if (!sdLogger.drain(_day))
+			return;
+		//One open per call, days with no log are skipped
+		if (!openDay()) {
+			_day += SECS_PER_DAY;
+			if (_day > _lastDay)
+				finish();
+		}
+		return;
+	}
+	//Never more than TX buffer takes, so Serial.write() doesn't wait
+	int n = room();
+	while ((n > 0) && (_remaining > 0)) {
+		int c = _file.read();
+		if (c < 0) {
+			_remaining = 0;
+			break;
+		}
+		Serial.write((uint8_t)c);
+		_remaining--;
+		n--;
+	}
+	if ((_remaining == 0) && (room() >= _maxLine)) {
+		_file.close();
+		Serial.println();
+		Serial.println(reinterpret_cast<const __FlashStringHelper*>(exportEndTxt));
+		_day += SECS_PER_DAY;
+		if (_day > _lastDay)
+			finish();
+	}
+}
+
+boolean LogExport::parseDay(const char *str, time_t &day) {
+	if ((str == NULL) || (strlen(str) != 8))
+		return false;
+	for (uint8_t i = 0; i < 8; i++) {
+		if (!isdigit(str[i]))
+			return false;
+	}
+	uint16_t y = (str[0] - '0') * 1000 + (str[1] - '0') * 100 + (str[2] - '0') * 10 + (str[3] - '0');
+	uint8_t m = (str[4] - '0') * 10 + (str[5] - '0');
+	uint8_t d = (str[6] - '0') * 10 + (str[7] - '0');
+	if ((y < 1970) || (m < 1) || (m > 12) || (d < 1) || (d > 31))
+		return false;
+	tmElements_t tm;
+	tm.Year = CalendarYrToTm(y);
+	tm.Month = m;
+	tm.Day = d;
+	tm.Hour = 0;
+	tm.Minute = 0;
+	tm.Second = 0;
+	day = makeTime(tm);
+	return true;
+}
+
+void LogExport::listNext() {
+	File entry = _file.openNextFile();
+	if (!entry) {
+		finish();
+		return;
+	}
+	Serial.print(F("> "));
+	Serial.print(entry.name());
+	if (entry.isDirectory())
+		Serial.println('/');
+	else {
+		Serial.print(' ');
+		TextFormat::printUInt(Serial, entry.size());
+		Serial.println();
+	}
+	entry.close();
+}
+
+boolean LogExport::openDay() {
+	char fileNameArray[13];
+	CharBuffer fileName(fileNameArray, sizeof(fileNameArray));
+	SDLogger::printFileName(fileName, _day, csvExtension);
+	_file = SD.open(fileNameArray);
+	if (!_file) {
+		fileName.clear();
+		SDLogger::printFileName(fileName, _day, binExtension);
+		_file = SD.open(fileNameArray);
+		if (!_file)
+			return false;
+	}
+	_remaining = _file.size();
+	//Preallocated file being written is bigger than its data
+	uint32_t used = sdLogger.openFileLength(_day);
+	if ((used > 0) && (used < _remaining))
+		_remaining = used;
+	Serial.print(reinterpret_cast<const __FlashStringHelper*>(exportBeginTxt));
+	Serial.print(fileNameArray);
+	Serial.print(' ');
+	TextFormat::printUInt(Serial, _remaining);
+	Serial.println();
+	return true;
+}
+
+void LogExport::finish() {
+	stop();
+	Serial.println(reinterpret_cast<const __FlashStringHelper*>(exportDoneTxt));
+}
+
+int LogExport::room() {
+	return Serial.availableForWrite();
+}
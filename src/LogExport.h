@@ -0,0 +1,91 @@
+// #############################################################################
+//
+// # Name       : LogExport
+//
+// # Description: Streams SD card log files through serial
+// # Lists the card or sends the YYYYMMDD.csv (or .bin) files of a range of days.
+// # process() moves bytes straight from the SD library's block cache to the
+// # UART, never more than its TX buffer has room for, so it never blocks and
+// # needs no buffer of its own. Call it once per loop.
+// # Each file is framed by "> Begin <name> <bytes>" and "> End" lines.
+//
+// #  This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// #############################################################################
+
+#ifndef LOGEXPORT_H
+#define LOGEXPORT_H
+
+#include <Arduino.h>
+#include <SD.h>
+#include <Time.h>
+#include <TextFormat.h>
+#include "SDLogger.h"
+
+const char exportBeginTxt[] PROGMEM = "> Begin ";
+const char exportEndTxt[] PROGMEM = "> End";
+const char exportDoneTxt[] PROGMEM = "> Done";
+const char exportRootDir[] PROGMEM = "/";
+
+extern SDLogger sdLogger;
+
+class LogExport {
+	public:
+		LogExport();
+		LogExport(const LogExport &other);
+		LogExport& operator=(const LogExport &other);
+		~LogExport();
+
+		//Each of these stops any transfer going on.
+		//Returns false if card can't be read
+		//Names and sizes of files in root directory
+		boolean list();
+		//Log files of days from to to, both included
+		boolean range(time_t from, time_t to);
+		void stop();
+		//A transfer is going on
+		boolean busy() const;
+		//Sends what fits in serial TX buffer. Call it once per loop
+		void process();
+		//Parses "YYYYMMDD" into midnight of that day
+		static boolean parseDay(const char *str, time_t &day);
+
+	private:
+		//Longest line sent at once: "> Begin YYYYMMDD.csv 4294967295"
+		static const uint8_t _maxLine = 34;
+
+		enum Mode {
+			Idle = 0,
+			Listing,
+			Sending
+		};
+		Mode _mode;
+		//Directory being listed or file being sent
+		File _file;
+		//Next day to send and last one
+		time_t _day;
+		time_t _lastDay;
+		//Bytes of file left to send
+		uint32_t _remaining;
+
+		//Sends one directory entry
+		void listNext();
+		//Opens file of _day, trying csv and bin. Sends its Begin line
+		boolean openDay();
+		void finish();
+		//Serial TX room in bytes
+		static int room();
+};
+
+#endif
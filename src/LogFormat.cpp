@@ -0,0 +1,150 @@
+#include "LogFormat.h"
+
+uint16_t logCrc16(const void *data, size_t length) {
+	const uint8_t *p = (const uint8_t*)data;
+	uint16_t crc = 0xFFFF;
+	while (length--)
+		crc = _crc_xmodem_update(crc, *p++);
+	return crc;
+}
+
+// *********************************************
+// LogRecord
+// *********************************************
+void LogRecord::seal() {
+	version = currentVersion;
+	crc = logCrc16(this, sizeof(LogRecord) - sizeof(crc));
+}
+
+boolean LogRecord::valid() const {
+	return (version == currentVersion) && (crc == logCrc16(this, sizeof(LogRecord) - sizeof(crc)));
+}
+
+void LogRecord::printCsv(Print &out) const {
+	//Date
+	TextFormat::printUInt(out, day(time), 2, '0');
+	out.print('-');
+	TextFormat::printUInt(out, month(time), 2, '0');
+	out.print('-');
+	TextFormat::printUInt(out, year(time));
+	out.print(',');
+	//Time
+	TextFormat::printUInt(out, hour(time), 2, '0');
+	out.print(':');
+	TextFormat::printUInt(out, minute(time), 2, '0');
+	out.print(',');
+	TextFormat::printUInt(out, samples);
+	//Sensors
+	for (uint8_t i = 0; i < nChannels; i++) {
+		if (present & (1 << i)) {
+			out.print(',');
+			printValue(out, i, value(i, last[i]));
+			out.print(',');
+			printValue(out, i, value(i, min[i]));
+			out.print(',');
+			printValue(out, i, value(i, max[i]));
+			out.print(',');
+			printValue(out, i, value(i, mean[i]));
+		} else
+			out.print(F(",,,,"));
+	}
+	//Alarms
+	for (uint8_t i = 0; i < nAlarms; i++) {
+		out.print(',');
+		TextFormat::printUInt(out, alarmTime[i]);
+	}
+	out.print(',');
+	//Memory telemetry
+	TextFormat::printUInt(out, minFree);
+	out.print(',');
+	TextFormat::printUInt(out, maxStack);
+	out.print(',');
+	TextFormat::printUInt(out, fragmentation);
+	out.println();
+}
+
+int32_t LogRecord::value(uint8_t channel) const {
+	return value(channel, last[channel]);
+}
+
+//Temp is signed, the rest unsigned
+int32_t LogRecord::value(uint8_t channel, uint16_t stored) {
+	return (channel == 0) ? (int32_t)(int16_t)stored : (int32_t)stored;
+}
+
+void LogRecord::printValue(Print &out, uint8_t channel, int32_t value) {
+	//Temp and pH are hundredths
+	if ((channel == 0) || (channel == 4))
+		TextFormat::printFixed(out, value, 2);
+	else
+		TextFormat::printInt(out, value);
+}
+
+// *********************************************
+// RollupRecord
+// *********************************************
+void RollupRecord::seal() {
+	version = currentVersion;
+	crc = logCrc16(this, sizeof(RollupRecord) - sizeof(crc));
+}
+
+boolean RollupRecord::valid() const {
+	return (version == currentVersion) && (crc == logCrc16(this, sizeof(RollupRecord) - sizeof(crc)));
+}
+
+void RollupRecord::printCsv(Print &out) const {
+	//Date
+	TextFormat::printUInt(out, day(start), 2, '0');
+	out.print('-');
+	TextFormat::printUInt(out, month(start), 2, '0');
+	out.print('-');
+	TextFormat::printUInt(out, year(start));
+	out.print(',');
+	//Time
+	TextFormat::printUInt(out, hour(start), 2, '0');
+	out.print(F(":00"));
+	for (uint8_t i = 0; i < LogRecord::nChannels; i++) {
+		if (present & (1 << i)) {
+			out.print(',');
+			LogRecord::printValue(out, i, LogRecord::value(i, min[i]));
+			out.print(',');
+			LogRecord::printValue(out, i, LogRecord::value(i, max[i]));
+			out.print(',');
+			LogRecord::printValue(out, i, LogRecord::value(i, mean[i]));
+			out.print(',');
+			TextFormat::printUInt(out, count[i]);
+		} else
+			out.print(F(",,,,"));
+	}
+	out.println();
+}
+
+// *********************************************
+// LogFileHeader
+// *********************************************
+void LogFileHeader::init(time_t t) {
+	memcpy_P(magic, logMagic, sizeof(magic));
+	version = currentVersion;
+	recordSize = sizeof(LogRecord);
+	headerSize = sizeof(LogFileHeader);
+	day = previousMidnight(t);
+	for (uint8_t i = 0; i < 24; i++)
+		hourIndex[i] = noRecord;
+	reserved[0] = 0;
+	reserved[1] = 0;
+	seal();
+}
+
+void LogFileHeader::seal() {
+	crc = logCrc16(this, sizeof(LogFileHeader) - sizeof(crc));
+}
+
+boolean LogFileHeader::valid() const {
+	return (memcmp_P(magic, logMagic, sizeof(magic)) == 0) && (version == currentVersion)
+		&& (recordSize == sizeof(LogRecord)) && (headerSize == sizeof(LogFileHeader))
+		&& (crc == logCrc16(this, sizeof(LogFileHeader) - sizeof(crc)));
+}
+
+uint32_t LogFileHeader::recordOffset(uint16_t n) {
+	return sizeof(LogFileHeader) + (uint32_t)n * sizeof(LogRecord);
+}
@@ -0,0 +1,157 @@
+// #############################################################################
+//
+// # Name       : LogFormat
+//
+// # Description: Binary sensor log format
+// # A YYYYMMDD.bin file is a 64 byte LogFileHeader followed by 80 byte LogRecords.
+// # Header holds the index of the first record of each hour so readers can seek
+// # straight to any time. Each record summarises a log interval: last, min, max and
+// # mean of every sensor as fixed-point values, seconds spent past alarm thresholds,
+// # a bitmask telling which sensors were present and a CRC. All fields are little endian.
+// # CRC is CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF) of all preceding bytes.
+// # HOURLY.BIN and DAILY.BIN are plain arrays of 56 byte RollupRecords.
+//
+// #  This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// #############################################################################
+
+#ifndef LOGFORMAT_H
+#define LOGFORMAT_H
+
+#include <Arduino.h>
+#include <Time.h>
+#include <TextFormat.h>
+#include <util/crc16.h>
+
+const char logMagic[] PROGMEM = "HLOG";
+const char csvHeader[] PROGMEM = "Date,Time,Samples,"
+	"Temp,TempMin,TempMax,TempMean,Humidity,HumidityMin,HumidityMax,HumidityMean,"
+	"Light,LightMin,LightMax,LightMean,EC,ECMin,ECMax,ECMean,PH,PHMin,PHMax,PHMean,"
+	"WaterLevel,WaterLevelMin,WaterLevelMax,WaterLevelMean,"
+	"ECHighSecs,ECLowSecs,PHHighSecs,PHLowSecs,WaterLowSecs,MinFree,MaxStack,Fragmentation";
+const char hourlyFile[] PROGMEM = "HOURLY.BIN";
+const char dailyFile[] PROGMEM = "DAILY.BIN";
+
+//CRC-16/CCITT-FALSE
+uint16_t logCrc16(const void *data, size_t length);
+
+//Summary of all sensor samples taken during a log interval
+struct LogRecord {
+	static const uint8_t currentVersion = 2;
+	//present bits
+	static const uint8_t tempBit = 0x01;
+	static const uint8_t humidityBit = 0x02;
+	static const uint8_t lightBit = 0x04;
+	static const uint8_t ecBit = 0x08;
+	static const uint8_t phBit = 0x10;
+	static const uint8_t levelBit = 0x20;
+	//Not a sensor: temp is in Fahrenheit
+	static const uint8_t fahrenheitBit = 0x80;
+	//Sensor values are channels 0..5 in present bits order
+	static const uint8_t nChannels = 6;
+	//Alarm conditions in Sensors::alarmState() bits order:
+	//EC high, EC low, pH high, pH low, water level low
+	static const uint8_t nAlarms = 5;
+	//Longest row printCsv() writes: "DD-MM-YYYY,HH:MM,65535", then four values with
+	//their commas per channel (temp "-327.68", humidity, light, EC "65535", pH "655.35",
+	//level), ",65535" per alarm, ",65535,65535,255" of memory telemetry and CRLF
+	static const uint16_t maxCsvRow = 22 + 4 * (nChannels + 7 + 5 + 5 + 5 + 6 + 5) + 6 * nAlarms + 16 + 2;
+
+	uint8_t version;
+	//Channels with at least one sample
+	uint8_t present;
+	//Seconds since 1970 when interval ends
+	uint32_t time;
+	//Seconds since 1970 when interval starts
+	uint32_t start;
+	//Sensor updates during interval
+	uint16_t samples;
+	//Fixed-point values: temp and pH in hundredths (temp is signed),
+	//humidity and level in %, light in lux, EC in uS
+	uint16_t last[nChannels];
+	uint16_t min[nChannels];
+	uint16_t max[nChannels];
+	uint16_t mean[nChannels];
+	//Seconds spent in each alarm condition, saturated at 0xFFFF
+	uint16_t alarmTime[nAlarms];
+	//Memory telemetry, bytes and %
+	uint16_t minFree;
+	uint16_t maxStack;
+	uint8_t fragmentation;
+	uint8_t reserved[3];
+	uint16_t crc;
+
+	//Sets version and CRC. Call it once all fields are filled
+	void seal();
+	//Right version and CRC
+	boolean valid() const;
+	//Prints record as a row of csvHeader columns. Absent sensors are left empty
+	void printCsv(Print &out) const;
+	//Last value of a channel
+	int32_t value(uint8_t channel) const;
+	//Converts a stored channel value back to its value
+	static int32_t value(uint8_t channel, uint16_t stored);
+	//Prints a fixed-point channel value with its decimals
+	static void printValue(Print &out, uint8_t channel, int32_t value);
+} __attribute__ ((packed));
+
+//Min, max and mean of each channel over an hour or a day
+struct RollupRecord {
+	static const uint8_t currentVersion = 1;
+
+	uint8_t version;
+	//LogRecord present bits of its samples
+	uint8_t present;
+	//Seconds since 1970 when the hour or day starts
+	uint32_t start;
+	//Fixed-point as in LogRecord
+	uint16_t min[LogRecord::nChannels];
+	uint16_t max[LogRecord::nChannels];
+	uint16_t mean[LogRecord::nChannels];
+	//Samples per channel
+	uint16_t count[LogRecord::nChannels];
+	uint16_t crc;
+
+	void seal();
+	boolean valid() const;
+	//Date,Time and then Min,Max,Mean,Count of each channel. Absent ones are left empty
+	void printCsv(Print &out) const;
+} __attribute__ ((packed));
+
+struct LogFileHeader {
+	static const uint8_t currentVersion = 1;
+	//hourIndex value of hours with no records
+	static const uint16_t noRecord = 0xFFFF;
+
+	char magic[4];
+	uint8_t version;
+	uint8_t recordSize;
+	uint16_t headerSize;
+	//Seconds since 1970 at 00:00 of file's day
+	uint32_t day;
+	//Number of the first record of each hour
+	uint16_t hourIndex[24];
+	uint8_t reserved[2];
+	uint16_t crc;
+
+	//Empty index for the day of t
+	void init(time_t t);
+	void seal();
+	//Magic, version, sizes and CRC match
+	boolean valid() const;
+	//File position of record n
+	static uint32_t recordOffset(uint16_t n);
+} __attribute__ ((packed));
+
+#endif
@@ -0,0 +1,121 @@
+#include "MemoryMonitor.h"
+
+//Linker and avr-libc malloc symbols
+extern char _end;
+extern char __stack;
+extern char __heap_start;
+extern char *__brkval;
+extern size_t __malloc_margin;
+struct __freelist {
+	size_t sz;
+	struct __freelist *nx;
+};
+extern struct __freelist *__flp;
+
+//Pattern untouched RAM is painted with
+static const uint8_t paintByte = 0xC5;
+
+//Fills everything between .bss and top of RAM with paintByte.
+//Runs from .init3: after SP is set up but before constructors and main(), so nothing is there yet.
+//Naked because it must not push anything onto the stack it's painting
+void paintMemory() __attribute__ ((naked)) __attribute__ ((used)) __attribute__ ((section (".init3")));
+void paintMemory() {
+	char *p = &_end;
+	while (p <= &__stack)
+		*p++ = paintByte;
+}
+
+int MemoryMonitor::_minFree = 0x7FFF;
+char* MemoryMonitor::_maxHeapTop = &__heap_start;
+
+char* MemoryMonitor::heapTop() {
+	return (__brkval == 0) ? &__heap_start : __brkval;
+}
+
+void MemoryMonitor::update() {
+	int mem = freeMemory();
+	if (mem < _minFree)
+		_minFree = mem;
+	char *top = heapTop();
+	if (top > _maxHeapTop)
+		_maxHeapTop = top;
+}
+
+int MemoryMonitor::freeMemory() {
+	return ::freeMemory();
+}
+
+int MemoryMonitor::minFreeMemory() {
+	update();
+	return _minFree;
+}
+
+//Painted bytes above the highest the heap has ever been. Heap may also have left
+//its own bytes there, so scan starts at its highest point instead of the current one
+int MemoryMonitor::untouchedMemory() {
+	update();
+	const char *p = _maxHeapTop;
+	while ((p <= &__stack) && (*p == (char)paintByte))
+		p++;
+	return p - _maxHeapTop;
+}
+
+int MemoryMonitor::maxStackUsed() {
+	int untouched = untouchedMemory();
+	return (&__stack - _maxHeapTop + 1) - untouched;
+}
+
+int MemoryMonitor::largestFreeBlock() {
+	//malloc() keeps __malloc_margin bytes below SP and needs 2 bytes for block size
+	int largest = (char*)SP - heapTop() - (int)__malloc_margin - (int)sizeof(size_t);
+	if (largest < 0)
+		largest = 0;
+	for (struct __freelist *fp = __flp; fp; fp = fp->nx) {
+		if ((int)fp->sz > largest)
+			largest = fp->sz;
+	}
+	return largest;
+}
+
+uint8_t MemoryMonitor::fragmentation() {
+	int gap = (char*)SP - heapTop() - (int)__malloc_margin - (int)sizeof(size_t);
+	uint16_t total = (gap > 0) ? gap : 0;
+	for (struct __freelist *fp = __flp; fp; fp = fp->nx)
+		total += fp->sz;
+	if (total == 0)
+		return 0;
+	return 100 - ((uint32_t)largestFreeBlock() * 100) / total;
+}
+
+void MemoryMonitor::print(Print &out) {
+	TextFormat::printP(out, memFreeTxt);
+	TextFormat::printInt(out, freeMemory());
+	out.println(reinterpret_cast<const __FlashStringHelper*>(memBytesTxt));
+	TextFormat::printP(out, memMinFreeTxt);
+	TextFormat::printInt(out, minFreeMemory());
+	out.println(reinterpret_cast<const __FlashStringHelper*>(memBytesTxt));
+	TextFormat::printP(out, memStackTxt);
+	TextFormat::printInt(out, maxStackUsed());
+	out.println(reinterpret_cast<const __FlashStringHelper*>(memBytesTxt));
+	TextFormat::printP(out, memUntouchedTxt);
+	TextFormat::printInt(out, untouchedMemory());
+	out.println(reinterpret_cast<const __FlashStringHelper*>(memBytesTxt));
+	TextFormat::printP(out, memLargestTxt);
+	TextFormat::printInt(out, largestFreeBlock());
+	out.println(reinterpret_cast<const __FlashStringHelper*>(memBytesTxt));
+	TextFormat::printP(out, memFragTxt);
+	TextFormat::printUInt(out, fragmentation());
+	out.println('%');
+}
+
+void MemoryMonitor::printCsv(Print &out) {
+	TextFormat::printInt(out, freeMemory());
+	out.print(',');
+	TextFormat::printInt(out, minFreeMemory());
+	out.print(',');
+	TextFormat::printInt(out, maxStackUsed());
+	out.print(',');
+	TextFormat::printInt(out, largestFreeBlock());
+	out.print(',');
+	TextFormat::printUInt(out, fragmentation());
+}
@@ -0,0 +1,68 @@
+// #############################################################################
+//
+// # Name       : MemoryMonitor
+//
+// # Description: SRAM telemetry. Complements freeMemory() snapshots with
+// # the lowest free memory seen, the stack high-water mark (RAM is painted
+// # with a known pattern at boot before anything runs) and heap fragmentation
+// # obtained walking avr-libc's malloc free list.
+// # Call update() once per loop so minimums are kept.
+//
+// #  This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// #############################################################################
+
+#ifndef MEMORYMONITOR_H
+#define MEMORYMONITOR_H
+
+#include <Arduino.h>
+#include <MemoryFree.h>
+#include <TextFormat.h>
+
+const char memFreeTxt[] PROGMEM = "> Free memory: ";
+const char memMinFreeTxt[] PROGMEM = "> Lowest free memory: ";
+const char memStackTxt[] PROGMEM = "> Max stack used: ";
+const char memUntouchedTxt[] PROGMEM = "> Never used RAM: ";
+const char memLargestTxt[] PROGMEM = "> Largest free block: ";
+const char memFragTxt[] PROGMEM = "> Heap fragmentation: ";
+const char memBytesTxt[] PROGMEM = " bytes";
+
+class MemoryMonitor {
+	public:
+		//Samples free memory and heap top. Call it once per loop
+		static void update();
+		//Current gap between heap and stack plus free list
+		static int freeMemory();
+		//Lowest freeMemory() seen by update()
+		static int minFreeMemory();
+		//Bytes between heap top and the deepest point stack has ever reached
+		static int untouchedMemory();
+		//Deepest the stack has ever been
+		static int maxStackUsed();
+		//Biggest malloc() that would succeed now
+		static int largestFreeBlock();
+		//0% when all free memory is in one block, near 100% when heavily split
+		static uint8_t fragmentation();
+		//Human readable report
+		static void print(Print &out);
+		//"free,minFree,maxStack,largest,frag" for the SD log
+		static void printCsv(Print &out);
+
+	private:
+		static int _minFree;
+		static char *_maxHeapTop;
+		static char* heapTop();
+};
+
+#endif
@@ -0,0 +1,37 @@
+#include "Profiler.h"
+
+#if PROFILING
+
+Profiler::PhaseStats Profiler::_stats[Profiler::nPhases];
+
+void Profiler::record(Phase phase, uint32_t elapsed) {
+	_stats[phase].add(elapsed);
+}
+
+void Profiler::printLine(Print &out, uint8_t line) {
+	if (line == 0) {
+		out.println();
+		out.println(reinterpret_cast<const __FlashStringHelper*>(perfHeaderTxt));
+		return;
+	}
+	const PhaseStats &s = _stats[(line - 1) / 2];
+	if (s.getCount() == 0)
+		return;
+	if (line % 2 == 1) {
+		out.print(F("> "));
+		TextFormat::printP(out, (const char*)pgm_read_word(&phaseNames[(line - 1) / 2]));
+		out.print(F(": "));
+		s.print(out);
+	} else {
+		TextFormat::printP(out, perfHistTxt);
+		s.printHistogram(out);
+	}
+	out.println();
+}
+
+void Profiler::reset() {
+	for (uint8_t p = 0; p < nPhases; p++)
+		_stats[p].reset();
+}
+
+#endif
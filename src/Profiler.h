@@ -0,0 +1,139 @@
+// #############################################################################
+//
+// # Name       : Profiler
+//
+// # Description: Measures time spent in each loop() phase and timer callback
+// # Keeps a LatencyStats of micros() per phase.
+// # Only built when PROFILING is 1, otherwise PROFILE() and PROFILE_SCOPE()
+// # expand to the plain call and to nothing.
+//
+// #  This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// #############################################################################
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+//Set to 1 (or build with -DPROFILING=1) to measure loop phases and enable "perf" command
+#ifndef PROFILING
+#define PROFILING 0
+#endif
+
+#if PROFILING
+
+#include <Arduino.h>
+#include <TextFormat.h>
+#include "LatencyStats.h"
+
+//Phase names
+const char phaseStr0[] PROGMEM = "Loop";
+const char phaseStr1[] PROGMEM = "SerialInput";
+const char phaseStr2[] PROGMEM = "GuiRefresh";
+const char phaseStr3[] PROGMEM = "GuiInput";
+const char phaseStr4[] PROGMEM = "Led";
+const char phaseStr5[] PROGMEM = "Pump";
+const char phaseStr6[] PROGMEM = "Alarms";
+const char phaseStr7[] PROGMEM = "NightTime";
+const char phaseStr8[] PROGMEM = "SettingsChanged";
+const char phaseStr9[] PROGMEM = "AlarmDelay";
+const char phaseStr10[] PROGMEM = "UpdateSensors";
+const char phaseStr11[] PROGMEM = "LogSensorReadings";
+const char phaseStr12[] PROGMEM = "AdjustECtemp";
+const char phaseStr13[] PROGMEM = "AdjustPHtemp";
+const char phaseStr14[] PROGMEM = "Watering";
+const char phaseStr15[] PROGMEM = "Beep";
+const char phaseStr16[] PROGMEM = "SerialAlarm";
+const char phaseStr17[] PROGMEM = "SDWrite";
+const char phaseStr18[] PROGMEM = "LogExport";
+const char phaseStr19[] PROGMEM = "History";
+const char* const phaseNames[] PROGMEM = { phaseStr0, phaseStr1, phaseStr2, phaseStr3,
+	phaseStr4, phaseStr5, phaseStr6, phaseStr7, phaseStr8, phaseStr9, phaseStr10, phaseStr11,
+	phaseStr12, phaseStr13, phaseStr14, phaseStr15, phaseStr16, phaseStr17, phaseStr18, phaseStr19 };
+
+const char perfHeaderTxt[] PROGMEM = "> Phase: count min/mean/max p50/p90/p99 us";
+const char perfHistTxt[] PROGMEM = ">   hist us";
+const char perfResetTxt[] PROGMEM = "Statistics reset.";
+
+class Profiler {
+	public:
+		//Callbacks run from inside Alarm.delay() so AlarmDelay includes their time
+		enum Phase {
+			Loop = 0,
+			SerialInput,
+			GuiRefresh,
+			GuiInput,
+			Led,
+			Pump,
+			Alarms,
+			NightTime,
+			SettingsChanged,
+			AlarmDelay,
+			UpdateSensors,
+			LogSensorReadings,
+			AdjustECtemp,
+			AdjustPHtemp,
+			Watering,
+			Beep,
+			SerialAlarm,
+			SDWrite,
+			LogExport,
+			History,
+			nPhases
+		};
+		//First histogram limit, micros() has a 4us resolution
+		static const uint16_t firstLimit = 4;
+		//Report lines: header, then statistics and histogram of each phase
+		static const uint8_t nLines = 1 + 2 * nPhases;
+
+		//Adds a measurement in us to phase
+		static void record(Phase phase, uint32_t elapsed);
+		//Prints a line of the report, so it can be written as room is left for it.
+		//Those of phases not measured are left out
+		static void printLine(Print &out, uint8_t line);
+		static void reset();
+
+	private:
+		//Phase statistics with bins starting at firstLimit
+		struct PhaseStats : public LatencyStats {
+			PhaseStats() : LatencyStats(firstLimit) {}
+		};
+		static PhaseStats _stats[nPhases];
+};
+
+//Records time elapsed between its construction and destruction
+class ProfileScope {
+	public:
+		ProfileScope(Profiler::Phase phase) : _phase(phase), _start(micros()) {}
+		~ProfileScope() { Profiler::record(_phase, micros() - _start); }
+
+	private:
+		Profiler::Phase _phase;
+		uint32_t _start;
+};
+
+#define PROFILE_CONCAT_(a,b) a##b
+#define PROFILE_CONCAT(a,b) PROFILE_CONCAT_(a,b)
+//Times the rest of the enclosing block
+#define PROFILE_SCOPE(phase) ProfileScope PROFILE_CONCAT(profileScope,__LINE__)(Profiler::phase)
+//Times a single call
+#define PROFILE(phase,call) do { ProfileScope profileScope(Profiler::phase); call; } while (0)
+
+#else
+
+#define PROFILE_SCOPE(phase)
+#define PROFILE(phase,call) call
+
+#endif
+
+#endif
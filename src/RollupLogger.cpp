@@ -0,0 +1,121 @@
+#include "RollupLogger.h"
+
+RollupLogger::RollupLogger() : _head(0), _count(0), _written(false), _dropped(0) {}
+
+RollupLogger::RollupLogger(const RollupLogger &other) {
+	*this = other;
+}
+
+RollupLogger& RollupLogger::operator=(const RollupLogger &other) {
+	_hour = other._hour;
+	_day = other._day;
+	memcpy(_queue, other._queue, sizeof(_queue));
+	memcpy(_daily, other._daily, sizeof(_daily));
+	_head = other._head;
+	_count = other._count;
+	_file = other._file;
+	_written = other._written;
+	_dropped = other._dropped;
+	return *this;
+}
+
+RollupLogger::~RollupLogger() {}
+
+boolean RollupLogger::add(const SensorSample &sample) {
+	boolean res = true;
+	time_t hourStart = sample.time - (sample.time % SECS_PER_HOUR);
+	time_t dayStart = previousMidnight(sample.time);
+	
+	if (hourStart != _hour.getStart()) {
+		res &= queue(_hour, false);
+		_hour.reset(hourStart);
+	}
+	if (dayStart != _day.getStart()) {
+		res &= queue(_day, true);
+		_day.reset(dayStart);
+	}
+	_hour.add(sample);
+	_day.add(sample);
+	return res;
+}
+
+void RollupLogger::process() {
+	uint32_t start = micros();
+	Step step;
+	while ((step = nextStep()) != Idle) {
+		runStep(step);
+		if (micros() - start >= _budget)
+			break;
+	}
+}
+
+void RollupLogger::close() {
+	queue(_hour, false);
+	queue(_day, true);
+	_hour.reset(0);
+	_day.reset(0);
+	Step step;
+	while ((step = nextStep()) != Idle)
+		runStep(step);
+}
+
+uint16_t RollupLogger::getDropped() const {
+	return _dropped;
+}
+
+RollupLogger::Step RollupLogger::nextStep() {
+	if (_written)
+		return Close;
+	if (_count == 0)
+		return Idle;
+	if (!_file)
+		return Open;
+	return Write;
+}
+
+void RollupLogger::runStep(Step step) {
+	switch (step) {
+		case Open: {
+			char fileName[13];
+			strncpy_P(fileName, _daily[_head] ? dailyFile : hourlyFile, sizeof(fileName));
+			_file = SD.open(fileName, FILE_WRITE);
+			//Retrying every loop would stall on a missing card
+			if (!_file) {
+				pop();
+				_dropped++;
+			}
+			break;
+		}
+		case Write:
+			if (_file.write((const uint8_t*)&_queue[_head], sizeof(RollupRecord)) != sizeof(RollupRecord))
+				_dropped++;
+			_written = true;
+			break;
+		case Close:
+			_file.close();
+			_written = false;
+			pop();
+			break;
+		default:
+			break;
+	}
+}
+
+boolean RollupLogger::queue(const SensorAggregate &aggregate, boolean daily) {
+	if (aggregate.empty())
+		return true;
+	if (_count == queueSize) {
+		_dropped++;
+		return false;
+	}
+	uint8_t i = (_head + _count) % queueSize;
+	aggregate.toRecord(_queue[i]);
+	_daily[i] = daily;
+	_count++;
+	return true;
+}
+
+void RollupLogger::pop() {
+	_head = (_head + 1) % queueSize;
+	_count--;
+}
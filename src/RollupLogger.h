@@ -0,0 +1,92 @@
+// #############################################################################
+//
+// # Name       : RollupLogger
+//
+// # Description: Hourly and daily sensor summaries on the SD card
+// # Every sensor sample updates the running aggregate of its hour and day.
+// # When a sample falls in a new hour (or day) the finished bucket is appended
+// # as a RollupRecord to HOURLY.BIN (or DAILY.BIN), so long range queries only
+// # read a few records instead of whole day logs.
+// # add() runs from a sensor timer, so it only queues finished buckets. process()
+// # opens, writes and closes their file from the loop as steps kept within a time
+// # budget, as SDLogger does with day logs.
+//
+// #  This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// #############################################################################
+
+#ifndef ROLLUPLOGGER_H
+#define ROLLUPLOGGER_H
+
+#include <Arduino.h>
+#include <SD.h>
+#include <Time.h>
+#include "LogFormat.h"
+#include "SensorAggregate.h"
+
+class RollupLogger {
+	public:
+		//Finished buckets waiting to be written. An hour and a day end together at midnight
+		static const uint8_t queueSize = 2;
+
+		RollupLogger();
+		RollupLogger(const RollupLogger &other);
+		RollupLogger& operator=(const RollupLogger &other);
+		~RollupLogger();
+
+		//Adds sample to current buckets, queueing them first if sample is past them.
+		//Doesn't touch the card. Returns false if a finished bucket was dropped, queue full
+		boolean add(const SensorSample &sample);
+		//Runs writer steps while within time budget. Call it once per loop
+		void process();
+		//Queues unfinished buckets, empties them and writes everything queued. Blocks.
+		//Used when logging stops
+		void close();
+		//Buckets lost because queue was full or their file couldn't be written
+		uint16_t getDropped() const;
+
+	private:
+		enum Step {
+			Idle = 0,
+			Open,
+			Write,
+			Close
+		};
+		//process() starts no more steps once this many us have gone by
+		static const uint16_t _budget = 2000;
+
+		SensorAggregate _hour;
+		SensorAggregate _day;
+		RollupRecord _queue[queueSize];
+		//Queued record goes to DAILY.BIN instead of HOURLY.BIN
+		boolean _daily[queueSize];
+		//Oldest queued record and number of them
+		uint8_t _head;
+		uint8_t _count;
+		//File of oldest queued record, while it's being written
+		File _file;
+		//Oldest queued record is in file, which only needs closing
+		boolean _written;
+		uint16_t _dropped;
+
+		//Next step to take, Idle if there's nothing to do
+		Step nextStep();
+		void runStep(Step step);
+		//Copies aggregate into queue if it has samples
+		boolean queue(const SensorAggregate &aggregate, boolean daily);
+		//Removes oldest queued record
+		void pop();
+};
+
+#endif
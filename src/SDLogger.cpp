@@ -0,0 +1,473 @@
+#include "SDLogger.h"
+
+SDLogger::SDLogger(Format format) : _format(format), _hasPending(false), _head(0), _count(0),
+	_written(0), _oldestTime(0), _contiguous(false), _fileDay(0), _filePos(0),
+	_prepared(false), _indexDirty(false),
+	_syncDirty(false), _draining(false), _maxStep(0), _dropped(0) {}
+
+SDLogger::SDLogger(const SDLogger &other) {
+	*this = other;
+}
+
+SDLogger& SDLogger::operator=(const SDLogger &other) {
+	_format = other._format;
+	_pending = other._pending;
+	_hasPending = other._hasPending;
+	memcpy(_buffer, other._buffer, _bufferSize);
+	_head = other._head;
+	_count = other._count;
+	_written = other._written;
+	_oldestTime = other._oldestTime;
+	_file = other._file;
+	_contig = other._contig;
+	_contiguous = other._contiguous;
+	_fileDay = other._fileDay;
+	_filePos = other._filePos;
+	_header = other._header;
+	_prepared = other._prepared;
+	_indexDirty = other._indexDirty;
+	_syncDirty = other._syncDirty;
+	_draining = other._draining;
+	_writeStats = other._writeStats;
+	_maxStep = other._maxStep;
+	_dropped = other._dropped;
+	return *this;
+}
+
+SDLogger::~SDLogger() {}
+
+boolean SDLogger::log(const LogRecord &record) {
+	if (_hasPending) {
+		_dropped++;
+		return false;
+	}
+	_pending = record;
+	_hasPending = true;
+	return true;
+}
+
+size_t SDLogger::write(uint8_t c) {
+	if (_count == _bufferSize)
+		return 0;
+	if (_count == _written)
+		_oldestTime = millis();
+	uint16_t tail = _head + _count;
+	if (tail >= _bufferSize)
+		tail -= _bufferSize;
+	_buffer[tail] = c;
+	_count++;
+	return 1;
+}
+
+void SDLogger::process() {
+	uint32_t start = micros();
+	Step step;
+	while ((step = nextStep()) != Idle) {
+		runStep(step);
+		if (micros() - start >= _budget)
+			break;
+	}
+	//Drained, drain() asks again if it still waits
+	if (step == Idle)
+		_draining = false;
+}
+
+void SDLogger::flush() {
+	_draining = true;
+	Step step;
+	while ((step = nextStep()) != Idle)
+		runStep(step);
+	_draining = false;
+}
+
+boolean SDLogger::drain(time_t t) {
+	//A record waiting may be about to open t's file
+	boolean pending = _hasPending && (_pending.time / SECS_PER_DAY == t / SECS_PER_DAY);
+	if (!pending && (!fileOpen() || (t / SECS_PER_DAY != _fileDay)))
+		return true;
+	_draining = true;
+	if (nextStep() != Idle)
+		return false;
+	_draining = false;
+	return true;
+}
+
+void SDLogger::close() {
+	flush();
+	if (fileOpen())
+		runStep(Close);
+}
+
+uint16_t SDLogger::buffered() const {
+	return _count;
+}
+
+void SDLogger::setFormat(Format format) {
+	if (format != _format) {
+		close();
+		_format = format;
+	}
+}
+
+uint32_t SDLogger::openFileLength(time_t t) {
+	if (!fileOpen() || (t / SECS_PER_DAY != _fileDay))
+		return 0;
+	return _filePos + _count;
+}
+
+//Filename must be at MAX 8chars + "." + 3chars
+//We choose it to be YYYY+MM+DD.csv or .bin
+void SDLogger::printFileName(Print &out, time_t t, const char *pmExtension) {
+	TextFormat::printUInt(out, year(t), 4, '0');
+	TextFormat::printUInt(out, month(t), 2, '0');
+	TextFormat::printUInt(out, day(t), 2, '0');
+	TextFormat::printP(out, pmExtension);
+}
+
+SDLogger::Format SDLogger::getFormat() const {
+	return _format;
+}
+
+const LatencyStats& SDLogger::getWriteStats() const { return _writeStats; }
+
+uint32_t SDLogger::getMaxStep() const { return _maxStep; }
+
+uint16_t SDLogger::getDropped() const { return _dropped; }
+
+void SDLogger::resetStats() {
+	_writeStats.reset();
+	_maxStep = 0;
+	_dropped = 0;
+}
+
+SDLogger::Step SDLogger::nextStep() {
+	uint16_t unwritten = _count - _written;
+	if (_hasPending) {
+		//Day changed: old file is finished and closed first
+		if (fileOpen() && (_pending.time / SECS_PER_DAY != _fileDay)) {
+			if (unwritten > 0)
+				return WriteBlock;
+			if (_indexDirty && !_contiguous)
+				return WriteIndex;
+			return Close;
+		}
+		if (!fileOpen())
+			return Open;
+		if (!_prepared)
+			return Prepare;
+		//Not enough room means there's data to write out
+		return hasRoom() ? FormatRecord : WriteBlock;
+	}
+	if (!fileOpen())
+		return Idle;
+	if ((unwritten > 0) && ((_count >= toBoundary()) || _draining || (millis() - _oldestTime >= _maxLatency)))
+		return WriteBlock;
+	//Index and sync follow data writes. Contiguous files need a free block of buffer
+	//to patch it and don't need syncing; closeFile() patches it if there never was one
+	if (_contiguous) {
+		if (_indexDirty && (unwritten == 0) && (_count <= _bufferSize - _blockSize))
+			return WriteIndex;
+		return Idle;
+	}
+	if (_indexDirty && (_syncDirty || _draining))
+		return WriteIndex;
+	if (_syncDirty)
+		return Sync;
+	return Idle;
+}
+
+void SDLogger::runStep(Step step) {
+	uint32_t start = micros();
+	switch (step) {
+		case Open:
+			openDayFile();
+			break;
+		case Prepare:
+			prepare();
+			break;
+		case FormatRecord:
+			formatRecord();
+			break;
+		case WriteBlock:
+			if (_contiguous)
+				writeRawBlock();
+			else
+				writeOut((_count < toBoundary()) ? _count : toBoundary());
+			break;
+		case WriteIndex:
+			if (_contiguous)
+				patchIndex();
+			else
+				writeIndex();
+			break;
+		case Sync:
+			_file.flush();
+			_syncDirty = false;
+			break;
+		case Close:
+			closeFile();
+			break;
+		default:
+			return;
+	}
+	uint32_t elapsed = micros() - start;
+	if (step == WriteBlock)
+		_writeStats.add(elapsed);
+	if (elapsed > _maxStep)
+		_maxStep = elapsed;
+}
+
+void SDLogger::openDayFile() {
+	time_t t = _pending.time;
+	char fileNameArray[13];
+	CharBuffer fileName(fileNameArray, sizeof(fileNameArray));
+	printFileName(fileName, t, (_format == Csv) ? csvExtension : binExtension);
+	_contiguous = false;
+	if (_format == Preallocated) {
+		if (!_contig.ready())
+			_contig.begin();
+		_contiguous = _contig.open(fileNameArray, _preallocSize);
+	}
+	//Opens at end, header rewrites seek back
+	if (!_contiguous)
+		_file = SD.open(fileNameArray, fileUpdate);
+	if (!fileOpen()) {
+		//Retrying every loop would stall on a missing card
+		_hasPending = false;
+		_dropped++;
+		return;
+	}
+	_fileDay = t / SECS_PER_DAY;
+	_filePos = _contiguous ? 0 : _file.size();
+	_prepared = false;
+	_indexDirty = false;
+}
+
+void SDLogger::prepare() {
+	_prepared = true;
+	if (_contiguous) {
+		prepareContiguous();
+		return;
+	}
+	if (_format == Csv) {
+		//New csv files start with column names
+		if (_filePos == 0) {
+			_filePos += _file.println(reinterpret_cast<const __FlashStringHelper*>(csvHeader));
+			_syncDirty = true;
+		}
+		return;
+	}
+	//New file, or a header cut by a power loss: records go after a whole one
+	if (_filePos < sizeof(LogFileHeader)) {
+		_header.init(_pending.time);
+		_file.seek(0);
+		_file.write((const uint8_t*)&_header, sizeof(LogFileHeader));
+		_filePos = sizeof(LogFileHeader);
+		_syncDirty = true;
+		return;
+	}
+	_file.seek(0);
+	if ((_file.read(&_header, sizeof(LogFileHeader)) != sizeof(LogFileHeader)) || !_header.valid()
+		|| (_header.day != previousMidnight(_pending.time))) {
+		//Not readable as ours, or another day's: start a fresh index that will overwrite it
+		_header.init(_pending.time);
+		_indexDirty = true;
+	}
+	_file.seek(_filePos);
+	//A record cut by a power loss would misalign all the following ones: pad it out
+	uint8_t partial = (_filePos - sizeof(LogFileHeader)) % sizeof(LogRecord);
+	if (partial) {
+		for (uint8_t i = partial; i < sizeof(LogRecord); i++)
+			_filePos += _file.write((uint8_t)0);
+		_syncDirty = true;
+	}
+}
+
+void SDLogger::formatRecord() {
+	//Contiguous file is full
+	if (_contiguous && (_filePos + _count + sizeof(LogRecord) > _contig.size())) {
+		_hasPending = false;
+		_dropped++;
+		return;
+	}
+	if (_format != Csv) {
+		//First record of its hour goes into the index
+		uint8_t h = hour(_pending.time);
+		if (_header.hourIndex[h] == LogFileHeader::noRecord) {
+			_header.hourIndex[h] = (_filePos + _count - sizeof(LogFileHeader)) / sizeof(LogRecord);
+			_header.seal();
+			_indexDirty = true;
+		}
+		write((const uint8_t*)&_pending, sizeof(LogRecord));
+	} else
+		_pending.printCsv(*this);
+	_hasPending = false;
+}
+
+void SDLogger::writeIndex() {
+	_file.seek(0);
+	_file.write((const uint8_t*)&_header, sizeof(LogFileHeader));
+	_file.seek(_filePos);
+	_indexDirty = false;
+	_syncDirty = true;
+}
+
+void SDLogger::writeOut(uint16_t n) {
+	if (n > _count)
+		n = _count;
+	//Ring may wrap, then it takes two writes
+	uint16_t first = _bufferSize - _head;
+	if (first > n)
+		first = n;
+	_file.write((const uint8_t*)&_buffer[_head], first);
+	if (n > first)
+		_file.write((const uint8_t*)_buffer, n - first);
+	_filePos += n;
+	_syncDirty = true;
+	consume(n);
+	//Deadline counts again from now for what's left
+	_oldestTime = millis();
+}
+
+void SDLogger::consume(uint16_t n) {
+	_head += n;
+	if (_head >= _bufferSize)
+		_head -= _bufferSize;
+	_count -= n;
+}
+
+void SDLogger::prepareContiguous() {
+	//Ring is empty while a file opens, so it's used to read the first block
+	_head = 0;
+	_count = 0;
+	_written = 0;
+	if (!_contig.read(0, &_header, sizeof(LogFileHeader)) || !_header.valid()
+		|| (_header.day != previousMidnight(_pending.time))) {
+		//New file
+		_header.init(_pending.time);
+		_filePos = 0;
+		write((const uint8_t*)&_header, sizeof(LogFileHeader));
+		_indexDirty = false;
+		return;
+	}
+	//File was left open by a reset: used length is where valid records of its day end.
+	//Index is only written once the records it points to are on card
+	uint16_t n = 0;
+	for (uint8_t h = 0; h < 24; h++) {
+		if ((_header.hourIndex[h] != LogFileHeader::noRecord) && (_header.hourIndex[h] > n))
+			n = _header.hourIndex[h];
+	}
+	//Hours the index missed are filled in on the way
+	LogRecord record;
+	_indexDirty = false;
+	while ((LogFileHeader::recordOffset(n + 1) <= _contig.size())
+		&& _contig.read(LogFileHeader::recordOffset(n), &record, sizeof(LogRecord))
+		&& record.valid() && (record.time / SECS_PER_DAY == _fileDay)) {
+		uint8_t h = hour(record.time);
+		if (_header.hourIndex[h] == LogFileHeader::noRecord) {
+			_header.hourIndex[h] = n;
+			_header.seal();
+			_indexDirty = true;
+		}
+		n++;
+	}
+	//Incomplete last block goes back into buffer
+	uint32_t used = LogFileHeader::recordOffset(n);
+	uint16_t partial = used % _blockSize;
+	_filePos = used - partial;
+	if (partial > 0) {
+		//An unreadable block loses its records but keeps the following ones aligned
+		if (!_contig.readBlock(_filePos / _blockSize, (uint8_t*)_buffer))
+			memset(_buffer, 0, partial);
+		_count = partial;
+		_written = partial;
+	}
+}
+
+void SDLogger::writeRawBlock() {
+	linearize();
+	//First block carries header, so it always takes the latest index
+	if (_filePos == 0) {
+		memcpy(_buffer, &_header, sizeof(LogFileHeader));
+		_indexDirty = false;
+	}
+	uint16_t n = (_count < _blockSize) ? _count : _blockSize;
+	//Incomplete block is padded and kept in buffer to be written again
+	if (n < _blockSize)
+		memset(&_buffer[n], 0, _blockSize - n);
+	_contig.writeBlock(_filePos / _blockSize, (const uint8_t*)_buffer);
+	if (n == _blockSize) {
+		consume(_blockSize);
+		_filePos += _blockSize;
+		_written = 0;
+	} else
+		_written = n;
+	_oldestTime = millis();
+}
+
+void SDLogger::patchIndex() {
+	if (_filePos == 0) {
+		//Still in buffer, goes out with it
+		_indexDirty = false;
+		return;
+	}
+	linearize();
+	uint8_t *block = (uint8_t*)&_buffer[_count];
+	if (_contig.readBlock(0, block)) {
+		memcpy(block, &_header, sizeof(LogFileHeader));
+		_contig.writeBlock(0, block);
+	}
+	_indexDirty = false;
+}
+
+void SDLogger::closeFile() {
+	if (_contiguous) {
+		//Everything is on card by now, buffer is free for the index
+		uint32_t used = _filePos + _count;
+		_head = 0;
+		_count = 0;
+		_written = 0;
+		if (_indexDirty)
+			patchIndex();
+		_contig.close(used);
+		_contiguous = false;
+	} else
+		//Also syncs
+		_file.close();
+	_syncDirty = false;
+	_indexDirty = false;
+	_prepared = false;
+}
+
+boolean SDLogger::fileOpen() {
+	return _contiguous ? _contig.isOpen() : (boolean)_file;
+}
+
+//Rotates buffer contents in place by reversing both parts and then the whole
+void SDLogger::linearize() {
+	if (_head == 0)
+		return;
+	reverse(0, _head);
+	reverse(_head, _bufferSize);
+	reverse(0, _bufferSize);
+	_head = 0;
+}
+
+void SDLogger::reverse(uint16_t from, uint16_t to) {
+	while ((to - from) > 1) {
+		to--;
+		char c = _buffer[from];
+		_buffer[from] = _buffer[to];
+		_buffer[to] = c;
+		from++;
+	}
+}
+
+uint16_t SDLogger::toBoundary() const {
+	return _blockSize - (_filePos % _blockSize);
+}
+
+boolean SDLogger::hasRoom() const {
+	uint16_t needed = (_format == Csv) ? _maxCsvRow : sizeof(LogRecord);
+	return (_bufferSize - _count) >= needed;
+}
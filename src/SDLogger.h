@@ -0,0 +1,189 @@
+// #############################################################################
+//
+// # Name       : SDLogger
+//
+// # Description: Non-blocking buffered SD card log writer
+// # log() only copies the record. process() does the rest as bounded steps spread
+// # over loop iterations: format record into a RAM ring buffer, open the day's
+// # YYYYMMDD.bin (or .csv) and read or write its header, write one block, update
+// # the hour index, sync, close at day change. Each call runs steps while it stays
+// # within a time budget, so a slow card only delays logging, never the control loop.
+// # Data reaches the card as whole 512 byte sectors, when the day changes or when
+// # buffered data gets older than a max latency. Block write times are kept as
+// # LatencyStats.
+// # Preallocated format is Binary in a ContiguousFile: each day file is created at
+// # full size and written with raw block writes, then truncated when it's closed.
+// # If the day file already exists as a plain one it's appended to as Binary.
+//
+// #  This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// #############################################################################
+
+#ifndef SDLOGGER_H
+#define SDLOGGER_H
+
+#include <Arduino.h>
+#include <SD.h>
+#include <Time.h>
+#include <TextFormat.h>
+#include "LogFormat.h"
+#include "LatencyStats.h"
+#include "ContiguousFile.h"
+
+const char csvExtension[] PROGMEM = ".csv";
+const char binExtension[] PROGMEM = ".bin";
+//Read and write, starting at end of file. FILE_WRITE includes O_APPEND in recent SD
+//library versions, which sends every write to the end, even after a seek()
+const uint8_t fileUpdate = O_READ | O_WRITE | O_CREAT;
+
+class SDLogger : public Print {
+	public:
+		enum Format {
+			Csv = 0,
+			Binary = 1,
+			Preallocated = 2
+		};
+		SDLogger(Format format = Binary);
+		SDLogger(const SDLogger &other);
+		SDLogger& operator=(const SDLogger &other);
+		~SDLogger();
+
+		//Queues record for the day file of its time. Doesn't touch the card.
+		//Returns false, dropping it, if previous record is still waiting
+		boolean log(const LogRecord &record);
+		//Raw bytes into buffer. Dropped if it's full
+		size_t write(uint8_t c);
+		using Print::write;
+		//Runs writer steps while within time budget. Call it once per loop
+		void process();
+		//Writes everything queued and syncs file. Blocks. Safe to call from a power-fail hook
+		void flush();
+		//Has process() write out everything queued for t's day file, as flush() does but
+		//in its usual steps. True once it's all on card, right away if nothing of that day is in RAM
+		boolean drain(time_t t);
+		//Flushes and closes day file. Blocks
+		void close();
+		//Bytes waiting in RAM
+		uint16_t buffered() const;
+		//Used length of t's day file if it's the open one, 0 otherwise.
+		//Preallocated files are bigger on card until closed. Call flush() or wait for drain() first
+		uint32_t openFileLength(time_t t);
+		//Prints day file name of t: YYYYMMDD and a PROGMEM extension
+		static void printFileName(Print &out, time_t t, const char *pmExtension);
+		//Closes current file, next record opens one with the new format
+		void setFormat(Format format);
+		Format getFormat() const;
+		//Time taken by each block write
+		const LatencyStats& getWriteStats() const;
+		//Longest single step in us
+		uint32_t getMaxStep() const;
+		//Records lost because queue was busy or their file couldn't be opened
+		uint16_t getDropped() const;
+		void resetStats();
+
+	private:
+		enum Step {
+			Idle = 0,
+			Open,
+			Prepare,
+			FormatRecord,
+			WriteBlock,
+			WriteIndex,
+			Sync,
+			Close
+		};
+		static const uint16_t _blockSize = 512;
+		//One sector plus room for a record arriving until process() runs
+		static const uint16_t _bufferSize = _blockSize + 128;
+		//Room a LogRecord csv row is given in buffer. If there isn't that much
+		//the sector is written before it's complete
+		static const uint16_t _maxCsvRow = LogRecord::maxCsvRow;
+		//Preallocated files hold a day of records at the shortest log interval, 1 minute
+		static const uint32_t _preallocSize = sizeof(LogFileHeader) + 1440UL * sizeof(LogRecord);
+		//Max ms data waits in RAM before being written anyway
+		static const uint32_t _maxLatency = 600000UL;
+		//process() starts no more steps once this many us have gone by
+		static const uint16_t _budget = 2000;
+
+		Format _format;
+		//Record waiting to be formatted into buffer
+		LogRecord _pending;
+		boolean _hasPending;
+		char _buffer[_bufferSize];
+		//Oldest byte and number of bytes buffered
+		uint16_t _head;
+		uint16_t _count;
+		//Contiguous files: buffered bytes already on card. The incomplete block stays
+		//in buffer, starting at _head, so it can be rewritten whole as it grows
+		uint16_t _written;
+		//millis() when oldest buffered byte arrived
+		uint32_t _oldestTime;
+		File _file;
+		ContiguousFile _contig;
+		//Open file is _contig
+		boolean _contiguous;
+		//Day (days since 1970) of open file
+		time_t _fileDay;
+		//Size of open file, used to keep writes aligned to sectors.
+		//Contiguous files: start of the block at _head
+		uint32_t _filePos;
+		//Binary files: copy of the file header, rewritten when its hour index changes
+		LogFileHeader _header;
+		//Open file still needs its header read or written
+		boolean _prepared;
+		boolean _indexDirty;
+		//Data written since last sync
+		boolean _syncDirty;
+		//flush() or drain() asked to write partial blocks too
+		boolean _draining;
+		LatencyStats _writeStats;
+		uint32_t _maxStep;
+		uint16_t _dropped;
+
+		//Next step to take, Idle if there's nothing to do
+		Step nextStep();
+		//Runs a step and times it
+		void runStep(Step step);
+		//Opens day file of pending record
+		void openDayFile();
+		//Reads header of an existing binary file or writes a new one. Csv files get column names
+		void prepare();
+		//Moves pending record into buffer
+		void formatRecord();
+		//Writes header back with the new hour index
+		void writeIndex();
+		//Moves n oldest buffered bytes to file
+		void writeOut(uint16_t n);
+		//Drops n oldest buffered bytes
+		void consume(uint16_t n);
+		//Contiguous files: loads header of an existing file, or queues a new one,
+		//and finds where records end
+		void prepareContiguous();
+		//Contiguous files: writes block at _head, padded if incomplete
+		void writeRawBlock();
+		//Contiguous files: rewrites header in first block using free buffer space
+		void patchIndex();
+		//Flushed file gets truncated if contiguous and closed
+		void closeFile();
+		boolean fileOpen();
+		//Makes buffer start at index 0 so a block can be written from it
+		void linearize();
+		void reverse(uint16_t from, uint16_t to);
+		//Bytes that complete the file's current sector
+		uint16_t toBoundary() const;
+		//Pending record fits in buffer
+		boolean hasRoom() const;
+};
+
+#endif
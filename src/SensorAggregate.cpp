@@ -0,0 +1,143 @@
+#include "SensorAggregate.h"
+
+//Sums are halved past this many samples so 16 bit values can't overflow them
+static const uint16_t maxCount = 0x8000;
+
+SensorAggregate::SensorAggregate() {
+	reset(0);
+}
+
+SensorAggregate::SensorAggregate(const SensorAggregate &other) {
+	*this = other;
+}
+
+SensorAggregate& SensorAggregate::operator=(const SensorAggregate &other) {
+	_start = other._start;
+	_lastSample = other._lastSample;
+	_samples = other._samples;
+	_present = other._present;
+	for (uint8_t i = 0; i < LogRecord::nChannels; i++) {
+		_min[i] = other._min[i];
+		_max[i] = other._max[i];
+		_sum[i] = other._sum[i];
+		_last[i] = other._last[i];
+		_count[i] = other._count[i];
+	}
+	for (uint8_t i = 0; i < LogRecord::nAlarms; i++)
+		_alarmTime[i] = other._alarmTime[i];
+	return *this;
+}
+
+SensorAggregate::~SensorAggregate() {}
+
+void SensorAggregate::reset(time_t start) {
+	_start = start;
+	_lastSample = start;
+	_samples = 0;
+	_present = 0;
+	for (uint8_t i = 0; i < LogRecord::nChannels; i++) {
+		_min[i] = 0;
+		_max[i] = 0;
+		_sum[i] = 0;
+		_last[i] = 0;
+		_count[i] = 0;
+	}
+	for (uint8_t i = 0; i < LogRecord::nAlarms; i++)
+		_alarmTime[i] = 0;
+}
+
+void SensorAggregate::add(const SensorSample &sample) {
+	//Sample holds its alarms since the previous one. Clock going back counts nothing
+	uint32_t elapsed = 0;
+	if ((_lastSample != 0) && (sample.time > _lastSample))
+		elapsed = sample.time - _lastSample;
+	_lastSample = sample.time;
+	for (uint8_t i = 0; i < LogRecord::nAlarms; i++) {
+		if (sample.alarms & (1 << i)) {
+			uint32_t t = _alarmTime[i] + elapsed;
+			_alarmTime[i] = (t > 0xFFFF) ? 0xFFFF : t;
+		}
+	}
+	if (_samples < 0xFFFF)
+		_samples++;
+	_present |= sample.present;
+	for (uint8_t i = 0; i < LogRecord::nChannels; i++) {
+		if (sample.present & (1 << i))
+			add(i, sample.value[i]);
+	}
+}
+
+void SensorAggregate::add(uint8_t channel, int32_t value) {
+	//Keeps mean while making room in the sum
+	if (_count[channel] == maxCount) {
+		_sum[channel] /= 2;
+		_count[channel] /= 2;
+	}
+	if ((_count[channel] == 0) || (value < _min[channel]))
+		_min[channel] = value;
+	if ((_count[channel] == 0) || (value > _max[channel]))
+		_max[channel] = value;
+	_sum[channel] += value;
+	_last[channel] = value;
+	_count[channel]++;
+	_present |= (1 << channel);
+}
+
+boolean SensorAggregate::empty() const {
+	for (uint8_t i = 0; i < LogRecord::nChannels; i++) {
+		if (_count[i] > 0)
+			return false;
+	}
+	return true;
+}
+
+time_t SensorAggregate::getStart() const { return _start; }
+
+uint16_t SensorAggregate::getSamples() const { return _samples; }
+
+uint16_t SensorAggregate::getCount(uint8_t channel) const { return _count[channel]; }
+
+int32_t SensorAggregate::getMin(uint8_t channel) const { return _min[channel]; }
+
+int32_t SensorAggregate::getMax(uint8_t channel) const { return _max[channel]; }
+
+//Rounded to nearest
+int32_t SensorAggregate::getMean(uint8_t channel) const {
+	if (_count[channel] == 0)
+		return 0;
+	int32_t half = (_sum[channel] < 0) ? -(int32_t)(_count[channel] / 2) : _count[channel] / 2;
+	return (_sum[channel] + half) / (int32_t)_count[channel];
+}
+
+int32_t SensorAggregate::getLast(uint8_t channel) const { return _last[channel]; }
+
+uint16_t SensorAggregate::getAlarmTime(uint8_t alarm) const { return _alarmTime[alarm]; }
+
+void SensorAggregate::toRecord(RollupRecord &record) const {
+	record.present = _present;
+	record.start = _start;
+	for (uint8_t i = 0; i < LogRecord::nChannels; i++) {
+		record.min[i] = _min[i];
+		record.max[i] = _max[i];
+		record.mean[i] = getMean(i);
+		record.count[i] = _count[i];
+	}
+	record.seal();
+}
+
+void SensorAggregate::toRecord(LogRecord &record, time_t end) const {
+	record.present = _present;
+	record.time = end;
+	record.start = _start;
+	record.samples = _samples;
+	for (uint8_t i = 0; i < LogRecord::nChannels; i++) {
+		record.last[i] = _last[i];
+		record.min[i] = _min[i];
+		record.max[i] = _max[i];
+		record.mean[i] = getMean(i);
+	}
+	for (uint8_t i = 0; i < LogRecord::nAlarms; i++)
+		record.alarmTime[i] = _alarmTime[i];
+	for (uint8_t i = 0; i < sizeof(record.reserved); i++)
+		record.reserved[i] = 0;
+}
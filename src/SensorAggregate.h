@@ -0,0 +1,85 @@
+// #############################################################################
+//
+// # Name       : SensorAggregate
+//
+// # Description: Running min/max/mean/last/count of every sensor over a time bucket
+// # and seconds spent past each alarm threshold. Fed with every sensor update.
+// # Works on the fixed-point values of LogRecord, so RAM cost is constant.
+//
+// #  This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// #############################################################################
+
+#ifndef SENSORAGGREGATE_H
+#define SENSORAGGREGATE_H
+
+#include <Arduino.h>
+#include <Time.h>
+#include "LogFormat.h"
+
+//One reading of every sensor, fixed-point as in LogRecord
+struct SensorSample {
+	time_t time;
+	//LogRecord present bits
+	uint8_t present;
+	//Sensors::alarmState() bits
+	uint8_t alarms;
+	int32_t value[LogRecord::nChannels];
+};
+
+class SensorAggregate {
+	public:
+		SensorAggregate();
+		SensorAggregate(const SensorAggregate &other);
+		SensorAggregate& operator=(const SensorAggregate &other);
+		~SensorAggregate();
+
+		//Empties aggregate and sets when its bucket starts
+		void reset(time_t start);
+		//Adds the present channels of a sample. Time since previous sample
+		//(or bucket start) counts towards the alarms the sample has on
+		void add(const SensorSample &sample);
+		void add(uint8_t channel, int32_t value);
+		boolean empty() const;
+		time_t getStart() const;
+		uint16_t getSamples() const;
+		uint16_t getCount(uint8_t channel) const;
+		int32_t getMin(uint8_t channel) const;
+		int32_t getMax(uint8_t channel) const;
+		int32_t getMean(uint8_t channel) const;
+		int32_t getLast(uint8_t channel) const;
+		//Seconds spent in an alarm condition, in Sensors::alarmState() bits order
+		uint16_t getAlarmTime(uint8_t alarm) const;
+		//Fills and seals a rollup record
+		void toRecord(RollupRecord &record) const;
+		//Fills the interval summary of a log record ending at end.
+		//Memory telemetry is left to the caller, who then seals it
+		void toRecord(LogRecord &record, time_t end) const;
+
+	private:
+		time_t _start;
+		//Time of last sample, alarm time is measured from it
+		time_t _lastSample;
+		uint16_t _samples;
+		//Present bits of all samples
+		uint8_t _present;
+		int32_t _min[LogRecord::nChannels];
+		int32_t _max[LogRecord::nChannels];
+		int32_t _sum[LogRecord::nChannels];
+		int32_t _last[LogRecord::nChannels];
+		uint16_t _count[LogRecord::nChannels];
+		uint16_t _alarmTime[LogRecord::nAlarms];
+};
+
+#endif
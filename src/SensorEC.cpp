@@ -142,35 +142,34 @@ void SensorEC::setStandby() {
 void SensorEC::setProbeType() {
 	Serial1.print("K,1.00\r");
 	if (_serialDbg)
-		Serial.println("k1.0");
+		serialTx.println("k1.0");
 }
 
 void SensorEC::setDry() {
 	Serial1.print("Cal,dry\r");
  	if (_serialDbg)
- 		Serial.println("dry cal");	
+ 		serialTx.println("dry cal");	
 }
 
 void SensorEC::setLowCalib() {
 	Serial1.print("Cal,low,12880\r");
  	if (_serialDbg)
- 		Serial.println("12,880 uS cal");
+ 		serialTx.println("12,880 uS cal");
 }
 
 void SensorEC::setHighCalib() {
 	Serial1.print("Cal,high,80000\r");
  	if (_serialDbg)
- 		Serial.println("80,000 uS cal");
+ 		serialTx.println("80,000 uS cal");
 }
 
 //Adjusts EC sensor readings to given temperature
 void SensorEC::adjustTemp(float tempt) {
 	if ((tempt != 0) && (!_calibratingEc)) {
-		//Convert temp from float to char*
-		char tempArray[4];
-		dtostrf(tempt,4,2,tempArray);
-		String command = "T," + (String)tempArray + "\r";
-		Serial1.print(command);
+		//Command is "T,<temp>\r", formatted straight into the circuit's port
+		Serial1.print(F("T,"));
+		TextFormat::printFloat(Serial1,tempt,2);
+		Serial1.print('\r');
 	}
 }
 
@@ -191,17 +190,20 @@ void SensorEC::clearECbuffer() {
 void SensorEC::ecToSerial() {
 	if (_serialDbg) {
 		if (Serial1.available() > 0) {
-			String sensorString = "";
-			sensorString.reserve(30);
-			//Read data from sensor
-			char inchar;
-			while (Serial1.peek() != '\r') {
-				inchar = (char)Serial1.read();
-				sensorString += inchar;
+			//Relay data from sensor char by char until <CR>, which gets discarded.
+			//It's an info message of sensors, dropped if TX ring fills up
+			boolean relay = serialTx.enabled(LogModule::Sensors,LOG_LEVEL_INFO);
+			if (relay)
+				serialTx.beginMessage(LOG_LEVEL_INFO);
+			int inchar;
+			while ((inchar = Serial1.read()) != '\r') {
+				if ((inchar >= 0) && relay)
+					serialTx.write((char)inchar);
+			}
+			if (relay) {
+				serialTx.println();
+				serialTx.endMessage();
 			}
-			//Discard <CR>
-			Serial1.read();
-			Serial.println(sensorString);
 		}
 	}
 }
@@ -28,6 +28,8 @@
 #define SENSOREC_H_
 
 #include "Sensor.h"
+#include <TextFormat.h>
+#include "SerialTransmitter.h"
 
 class SensorEC: public Sensor {
 	public:
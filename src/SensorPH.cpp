@@ -139,29 +139,28 @@ void SensorPH::setStandby() {
 void SensorPH::setFour() {
 	Serial2.print("Cal,low,4.00\r");
  	if (_serialDbg)
- 		Serial.println(4.00);	
+ 		serialTx.println(4.00);	
 }
 
 void SensorPH::setSeven() {
  	Serial2.print("Cal,mid,7.00\r");
  	if (_serialDbg)
- 		Serial.println(7.00);	
+ 		serialTx.println(7.00);	
 }
 
 void SensorPH::setTen() {
 	Serial2.print("Cal,high,10.00\r");
  	if (_serialDbg)
- 		Serial.println(10.00);	
+ 		serialTx.println(10.00);	
 }
 
 //Adjust pH readings to given temperature
 void SensorPH::adjustTemp(float tempt) {
 	if ((tempt != 0) && (!_calibratingPh)) {
-		//Convert temp from float to char*
-		char tempArray[4];
-		dtostrf(tempt,4,2,tempArray);
-		String command = "T," + (String)tempArray + "\r";
-		Serial2.print(command);
+		//Command is "T,<temp>\r", formatted straight into the circuit's port
+		Serial2.print(F("T,"));
+		TextFormat::printFloat(Serial2,tempt,2);
+		Serial2.print('\r');
 	}	
 }
 
@@ -182,17 +181,20 @@ void SensorPH::clearPHbuffer() {
 void SensorPH::phToSerial() {
 	if (_serialDbg) {
 		if (Serial2.available() > 0) {
-			String sensorString = "";
-			sensorString.reserve(30);
-			//Read data from sensor
-			char inchar;
-			while (Serial2.peek() != '\r') {
-				inchar = (char)Serial2.read();
-				sensorString += inchar;
+			//Relay data from sensor char by char until <CR>, which gets discarded.
+			//It's an info message of sensors, dropped if TX ring fills up
+			boolean relay = serialTx.enabled(LogModule::Sensors,LOG_LEVEL_INFO);
+			if (relay)
+				serialTx.beginMessage(LOG_LEVEL_INFO);
+			int inchar;
+			while ((inchar = Serial2.read()) != '\r') {
+				if ((inchar >= 0) && relay)
+					serialTx.write((char)inchar);
+			}
+			if (relay) {
+				serialTx.println();
+				serialTx.endMessage();
 			}
-			//Discard <CR>
-			Serial2.read();
-			Serial.println(sensorString);
 		}
 	}
 }
@@ -27,6 +27,8 @@
 #define SENSORPH_H_
 
 #include "Sensor.h"
+#include <TextFormat.h>
+#include "SerialTransmitter.h"
 
 class SensorPH: public Sensor {
 	public:
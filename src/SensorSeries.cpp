@@ -0,0 +1,386 @@
+#include "SensorSeries.h"
+
+// *********************************************
+// Iterator
+// *********************************************
+SensorSeries::Iterator::Iterator(const SensorSeries *series, time_t from) : _series(series), _from(from),
+	_block(0), _point(0) {
+	memset(&_cursor, 0, sizeof(_cursor));
+}
+
+SensorSeries::Iterator::Iterator(const Iterator &other) {
+	*this = other;
+}
+
+SensorSeries::Iterator& SensorSeries::Iterator::operator=(const Iterator &other) {
+	_series = other._series;
+	_from = other._from;
+	_block = other._block;
+	_point = other._point;
+	_cursor = other._cursor;
+	return *this;
+}
+
+SensorSeries::Iterator::~Iterator() {}
+
+boolean SensorSeries::Iterator::next(SensorSample &sample) {
+	if (_series == NULL)
+		return false;
+	while (_block < _series->_used) {
+		const Block &b = _series->block(_block);
+		if (_point == 0) {
+			//Whole block is before from if the next one starts before it too
+			if ((_block + 1 < _series->_used) && (_series->block(_block + 1).start <= _from)) {
+				_block++;
+				continue;
+			}
+			readFirst(b, _cursor);
+		} else if (_point < b.points)
+			readNext(b, _cursor);
+		else {
+			_block++;
+			_point = 0;
+			continue;
+		}
+		_point++;
+		if (_cursor.time < _from)
+			continue;
+		sample.time = _cursor.time;
+		sample.present = b.present;
+		sample.alarms = 0;
+		for (uint8_t i = 0; i < LogRecord::nChannels; i++)
+			sample.value[i] = _cursor.value[i];
+		return true;
+	}
+	return false;
+}
+
+// *********************************************
+// SensorSeries
+// *********************************************
+SensorSeries::SensorSeries() {
+	clear();
+}
+
+SensorSeries::SensorSeries(const SensorSeries &other) {
+	*this = other;
+}
+
+SensorSeries& SensorSeries::operator=(const SensorSeries &other) {
+	memcpy(_blocks, other._blocks, sizeof(_blocks));
+	_first = other._first;
+	_used = other._used;
+	_tail = other._tail;
+	_pointTime = other._pointTime;
+	_pointPresent = other._pointPresent;
+	_samples = other._samples;
+	for (uint8_t i = 0; i < LogRecord::nChannels; i++)
+		_sum[i] = other._sum[i];
+	return *this;
+}
+
+SensorSeries::~SensorSeries() {}
+
+void SensorSeries::add(const SensorSample &sample) {
+	time_t t = sample.time - sample.time % pointInterval;
+	if ((_samples > 0) && ((t != _pointTime) || (sample.present != _pointPresent)))
+		closePoint();
+	if (_samples == 0) {
+		_pointTime = t;
+		_pointPresent = sample.present;
+		for (uint8_t i = 0; i < LogRecord::nChannels; i++)
+			_sum[i] = 0;
+	}
+	for (uint8_t i = 0; i < LogRecord::nChannels; i++) {
+		if (sample.present & (1 << i))
+			_sum[i] += sample.value[i];
+	}
+	_samples++;
+}
+
+SensorSeries::Iterator SensorSeries::begin(time_t from) const {
+	return Iterator(this, from);
+}
+
+void SensorSeries::clear() {
+	_first = 0;
+	_used = 0;
+	memset(&_tail, 0, sizeof(_tail));
+	_pointTime = 0;
+	_pointPresent = 0;
+	_samples = 0;
+	for (uint8_t i = 0; i < LogRecord::nChannels; i++)
+		_sum[i] = 0;
+}
+
+time_t SensorSeries::getStart() const {
+	return (_used > 0) ? block(0).start : 0;
+}
+
+uint16_t SensorSeries::getPoints() const {
+	uint16_t points = 0;
+	for (uint8_t i = 0; i < _used; i++)
+		points += block(i).points;
+	return points;
+}
+
+uint16_t SensorSeries::getBytesUsed() const {
+	uint16_t bytes = 0;
+	for (uint8_t i = 0; i < _used; i++)
+		bytes += sizeof(Block) - sizeof(_blocks[0].data) + (block(i).bits + 7) / 8;
+	return bytes;
+}
+
+void SensorSeries::closePoint() {
+	int32_t value[LogRecord::nChannels];
+	//Rounded to nearest
+	for (uint8_t i = 0; i < LogRecord::nChannels; i++) {
+		int32_t half = (_sum[i] < 0) ? -(int32_t)(_samples / 2) : _samples / 2;
+		value[i] = (_sum[i] + half) / (int32_t)_samples;
+	}
+	append(_pointTime, _pointPresent, value);
+	_samples = 0;
+}
+
+void SensorSeries::append(time_t t, uint8_t present, const int32_t *value) {
+	//Points in a block share present bits
+	if ((_used == 0) || (present != last().present) || !appendPoint(last(), _tail, t, value))
+		newBlock(t, present, value);
+}
+
+void SensorSeries::newBlock(time_t t, uint8_t present, const int32_t *value) {
+	if ((_used == nBlocks) && !compact(t - horizon)) {
+		_first = (_first + 1) % nBlocks;
+		_used--;
+	}
+	_used++;
+	startBlock(last(), _tail, t, present, value);
+}
+
+boolean SensorSeries::compact(time_t from) {
+	//Oldest block holds nothing from from on once the next one starts before it
+	if (block(1).start <= from)
+		return false;
+	trim(from);
+	//Pair spanning the shortest time has the most points to spare
+	uint8_t pair = nBlocks;
+	time_t shortest = 0;
+	Cursor end;
+	readLast(block(0), end);
+	for (uint8_t n = 0; n + 1 < _used; n++) {
+		//Sensors came or went, or clock went back, between them
+		boolean joinable = (block(n).present == block(n + 1).present) && (block(n + 1).start > end.time);
+		time_t start = block(n).start;
+		readLast(block(n + 1), end);
+		if (joinable && ((pair == nBlocks) || (end.time - start < shortest))) {
+			pair = n;
+			shortest = end.time - start;
+		}
+	}
+	if (pair == nBlocks)
+		return false;
+	//Both are thinned until their points fit a block
+	while (!merge(pair)) {
+		if (!(thin(pair) | thin(pair + 1)))
+			return false;
+	}
+	return true;
+}
+
+void SensorSeries::trim(time_t from) {
+	Block &b = block(0);
+	//Point from falls in stays
+	Cursor in;
+	Cursor next;
+	readFirst(b, in);
+	uint8_t p = 0;
+	while (p + 1 < b.points) {
+		next = in;
+		readNext(b, next);
+		if (next.time > from)
+			break;
+		in = next;
+		p++;
+	}
+	if ((p == 0) && (b.start >= from))
+		return;
+	//What it averages before from goes with it
+	Block trimmed;
+	Cursor out;
+	startBlock(trimmed, out, max(in.time, from), b.present, in.value);
+	while (++p < b.points) {
+		readNext(b, in);
+		//Left whole, it's only dropped later
+		if (!appendPoint(trimmed, out, in.time, in.value))
+			return;
+	}
+	memcpy(&b, &trimmed, sizeof(Block));
+}
+
+boolean SensorSeries::thin(uint8_t n) {
+	Block &b = block(n);
+	if (b.points < 2)
+		return false;
+	Block thinned;
+	Cursor in;
+	Cursor out;
+	int32_t value[LogRecord::nChannels];
+	readFirst(b, in);
+	for (uint8_t p = 0; p < b.points; p += 2) {
+		//Joined point keeps time of the first
+		time_t t = in.time;
+		for (uint8_t i = 0; i < LogRecord::nChannels; i++)
+			value[i] = in.value[i];
+		if (p + 1 < b.points) {
+			readNext(b, in);
+			for (uint8_t i = 0; i < LogRecord::nChannels; i++)
+				value[i] = (value[i] + in.value[i]) / 2;
+		}
+		if (p == 0)
+			startBlock(thinned, out, t, b.present, value);
+		else if (!appendPoint(thinned, out, t, value))
+			return false;
+		if (p + 2 < b.points)
+			readNext(b, in);
+	}
+	memcpy(&b, &thinned, sizeof(Block));
+	return true;
+}
+
+boolean SensorSeries::merge(uint8_t n) {
+	const Block &next = block(n + 1);
+	Block merged;
+	memcpy(&merged, &block(n), sizeof(Block));
+	Cursor out;
+	Cursor in;
+	readLast(merged, out);
+	readFirst(next, in);
+	for (uint8_t p = 0; p < next.points; p++) {
+		if (p > 0)
+			readNext(next, in);
+		if (!appendPoint(merged, out, in.time, in.value))
+			return false;
+	}
+	memcpy(&block(n), &merged, sizeof(Block));
+	//Later blocks move down one
+	for (uint8_t i = n + 1; i + 1 < _used; i++)
+		memcpy(&block(i), &block(i + 1), sizeof(Block));
+	_used--;
+	return true;
+}
+
+const SensorSeries::Block& SensorSeries::block(uint8_t n) const {
+	return _blocks[(_first + n) % nBlocks];
+}
+
+SensorSeries::Block& SensorSeries::block(uint8_t n) {
+	return _blocks[(_first + n) % nBlocks];
+}
+
+SensorSeries::Block& SensorSeries::last() {
+	return _blocks[(_first + _used - 1) % nBlocks];
+}
+
+void SensorSeries::startBlock(Block &b, Cursor &c, time_t t, uint8_t present, const int32_t *value) {
+	b.start = t;
+	b.present = present;
+	b.points = 1;
+	b.bits = 0;
+	for (uint8_t i = 0; i < LogRecord::nChannels; i++)
+		b.first[i] = (present & (1 << i)) ? (uint16_t)value[i] : 0;
+	readFirst(b, c);
+}
+
+boolean SensorSeries::appendPoint(Block &b, Cursor &c, time_t t, const int32_t *value) {
+	if ((t <= c.time) || (b.points == 0xFF))
+		return false;
+	uint16_t bits = b.bits;
+	int32_t delta = t - c.time;
+	boolean fits = encode(b, delta - c.delta, seriesTimeBits);
+	for (uint8_t i = 0; fits && (i < LogRecord::nChannels); i++) {
+		if (b.present & (1 << i))
+			fits = encode(b, value[i] - c.value[i], seriesValueBits);
+	}
+	if (!fits) {
+		b.bits = bits;
+		return false;
+	}
+	b.points++;
+	c.time = t;
+	c.delta = delta;
+	for (uint8_t i = 0; i < LogRecord::nChannels; i++) {
+		if (b.present & (1 << i))
+			c.value[i] = value[i];
+	}
+	c.bit = b.bits;
+	return true;
+}
+
+void SensorSeries::readFirst(const Block &b, Cursor &c) {
+	c.time = b.start;
+	c.delta = pointInterval;
+	c.bit = 0;
+	for (uint8_t i = 0; i < LogRecord::nChannels; i++)
+		c.value[i] = (b.present & (1 << i)) ? LogRecord::value(i, b.first[i]) : 0;
+}
+
+void SensorSeries::readNext(const Block &b, Cursor &c) {
+	c.delta += decode(b, c.bit, seriesTimeBits);
+	c.time += c.delta;
+	for (uint8_t i = 0; i < LogRecord::nChannels; i++) {
+		if (b.present & (1 << i))
+			c.value[i] += decode(b, c.bit, seriesValueBits);
+	}
+}
+
+void SensorSeries::readLast(const Block &b, Cursor &c) {
+	readFirst(b, c);
+	for (uint8_t p = 1; p < b.points; p++)
+		readNext(b, c);
+}
+
+//Zigzag number (0, -1, 1, -2...) after the prefix of the narrowest width it fits in
+boolean SensorSeries::encode(Block &b, int32_t n, const uint8_t *pmWidths) {
+	uint32_t z = ((uint32_t)n << 1) ^ (uint32_t)(n >> 31);
+	uint8_t code = 0;
+	uint8_t width = pgm_read_byte(&pmWidths[0]);
+	while ((code < 4) && ((z >> width) != 0))
+		width = pgm_read_byte(&pmWidths[++code]);
+	//code ones, then a zero unless it's the last code
+	boolean fits = (code < 4) ? writeBits(b, ((1UL << code) - 1) << 1, code + 1) : writeBits(b, 0x0F, 4);
+	return fits && writeBits(b, z, width);
+}
+
+//Most significant bit first
+boolean SensorSeries::writeBits(Block &b, uint32_t value, uint8_t n) {
+	if (b.bits + n > sizeof(b.data) * 8)
+		return false;
+	while (n > 0) {
+		n--;
+		uint8_t mask = 0x80 >> (b.bits & 7);
+		if ((value >> n) & 1)
+			b.data[b.bits >> 3] |= mask;
+		else
+			b.data[b.bits >> 3] &= ~mask;
+		b.bits++;
+	}
+	return true;
+}
+
+int32_t SensorSeries::decode(const Block &b, uint16_t &bit, const uint8_t *pmWidths) {
+	uint8_t code = 0;
+	while ((code < 4) && readBits(b, bit, 1))
+		code++;
+	uint32_t z = readBits(b, bit, pgm_read_byte(&pmWidths[code]));
+	return (int32_t)(z >> 1) ^ -(int32_t)(z & 1);
+}
+
+uint32_t SensorSeries::readBits(const Block &b, uint16_t &bit, uint8_t n) {
+	uint32_t value = 0;
+	while (n > 0) {
+		n--;
+		value = (value << 1) | ((b.data[bit >> 3] >> (7 - (bit & 7))) & 1);
+		bit++;
+	}
+	return value;
+}
@@ -0,0 +1,167 @@
+// #############################################################################
+//
+// # Name       : SensorSeries
+//
+// # Description: Compressed in-RAM history of every sensor, at least the last day
+// # Sensor updates are averaged into one point every pointInterval seconds. Points
+// # are packed in a ring of fixed-size blocks: each block header holds its first
+// # point, the rest are bit-packed as the delta-of-delta of their timestamps and
+// # the delta of each fixed-point value from the previous point, both with short
+// # prefix codes that take a single bit when nothing changed. RAM use is fixed at
+// # nBlocks * blockSize.
+// # When the ring is full its oldest block is only dropped if the next one starts
+// # horizon or more ago. Otherwise points before the horizon are trimmed, and the
+// # two neighbouring blocks spanning the shortest time have each pair of their
+// # points averaged into one until they fit a single block. Points get evenly
+// # coarser instead of the series getting shorter: they stay pointInterval apart
+// # over the day while each sensor moves about 7 LSB or less a point, and are 40
+// # minutes apart at worst, with every reading jumping across its whole range.
+// # Blocks with different present bits can't be joined, so the day is only cut
+// # short if sensors come and go nBlocks - 1 times within it.
+// # Consumers read it oldest first through an Iterator.
+//
+// #  This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// #############################################################################
+
+#ifndef SENSORSERIES_H
+#define SENSORSERIES_H
+
+#include <Arduino.h>
+#include <Time.h>
+#include "LogFormat.h"
+#include "SensorAggregate.h"
+
+//Bits after each prefix code: '0', '10', '110', '1110' and '1111'
+const uint8_t seriesTimeBits[] PROGMEM = { 0, 7, 12, 20, 32 };
+const uint8_t seriesValueBits[] PROGMEM = { 0, 4, 8, 12, 17 };
+
+class SensorSeries {
+	public:
+		//Seconds each point averages, before it's thinned
+		static const uint16_t pointInterval = 600;
+		//Seconds of points kept whole
+		static const uint32_t horizon = SECS_PER_DAY;
+		static const uint8_t nBlocks = 10;
+		static const uint8_t blockSize = 128;
+
+		//Fixed-size block of points
+		struct Block {
+			//Time and LogRecord stored values of first point
+			uint32_t start;
+			uint16_t first[LogRecord::nChannels];
+			//LogRecord present bits of all its points
+			uint8_t present;
+			uint8_t points;
+			//Bits used in data
+			uint16_t bits;
+			uint8_t data[blockSize - 20];
+		} __attribute__ ((packed));
+
+		//A point in a block and the bit after it. Points are decoded from the previous one
+		struct Cursor {
+			time_t time;
+			int32_t delta;
+			int32_t value[LogRecord::nChannels];
+			uint16_t bit;
+		};
+
+		//Reads points oldest first. Only valid until the series is next added to
+		class Iterator {
+			public:
+				Iterator(const SensorSeries *series = NULL, time_t from = 0);
+				Iterator(const Iterator &other);
+				Iterator& operator=(const Iterator &other);
+				~Iterator();
+
+				//Next point into sample. Returns false when there are no more
+				boolean next(SensorSample &sample);
+
+			private:
+				const SensorSeries *_series;
+				time_t _from;
+				//Block, 0 being the oldest, and point in it
+				uint8_t _block;
+				uint8_t _point;
+				//Previous point
+				Cursor _cursor;
+		};
+
+		SensorSeries();
+		SensorSeries(const SensorSeries &other);
+		SensorSeries& operator=(const SensorSeries &other);
+		~SensorSeries();
+
+		//Adds a sensor update to the current point. Its present bits or a new
+		//interval close the point and append it
+		void add(const SensorSample &sample);
+		//Iterator starting at the first point at or after from
+		Iterator begin(time_t from = 0) const;
+		void clear();
+		//Time of oldest point, 0 if empty
+		time_t getStart() const;
+		uint16_t getPoints() const;
+		//Bytes holding points, out of nBlocks * blockSize
+		uint16_t getBytesUsed() const;
+
+	private:
+		Block _blocks[nBlocks];
+		//Oldest block and blocks in use
+		uint8_t _first;
+		uint8_t _used;
+		//Last point appended
+		Cursor _tail;
+		//Point being averaged
+		time_t _pointTime;
+		uint8_t _pointPresent;
+		uint16_t _samples;
+		int32_t _sum[LogRecord::nChannels];
+
+		//Averages current point and appends it
+		void closePoint();
+		void append(time_t t, uint8_t present, const int32_t *value);
+		//Starts a block with a point. If ring is full, makes room with compact() or
+		//by dropping the oldest block
+		void newBlock(time_t t, uint8_t present, const int32_t *value);
+		//Frees a block without losing points from from on: joins two, oldest first.
+		//False if the oldest block can go as it's all before from, or no two can be joined
+		boolean compact(time_t from);
+		//Drops points of the oldest block that end before from
+		void trim(time_t from);
+		//Averages each pair of points of block n into one. False if it has a single
+		//point or they don't fit
+		boolean thin(uint8_t n);
+		//Appends points of block n + 1 to block n and removes it. False if they don't fit
+		boolean merge(uint8_t n);
+		//Block n, 0 being the oldest
+		const Block& block(uint8_t n) const;
+		Block& block(uint8_t n);
+		Block& last();
+		//Puts a point in b as its first and cursor on it
+		static void startBlock(Block &b, Cursor &c, time_t t, uint8_t present, const int32_t *value);
+		//Encodes a point after cursor and moves it there. False, leaving b as it was,
+		//if it doesn't fit or doesn't come after cursor
+		static boolean appendPoint(Block &b, Cursor &c, time_t t, const int32_t *value);
+		//Cursor on first, next or last point of b
+		static void readFirst(const Block &b, Cursor &c);
+		static void readNext(const Block &b, Cursor &c);
+		static void readLast(const Block &b, Cursor &c);
+		//Bit packing. Writes return false when the block is full
+		static boolean encode(Block &b, int32_t n, const uint8_t *pmWidths);
+		static boolean writeBits(Block &b, uint32_t value, uint8_t n);
+		static int32_t decode(const Block &b, uint16_t &bit, const uint8_t *pmWidths);
+		static uint32_t readBits(const Block &b, uint16_t &bit, uint8_t n);
+};
+
+#endif
@@ -0,0 +1,104 @@
+#include "SensorWatch.h"
+
+SensorWatch::SensorWatch() : _active(false), _period(0), _channels(0), _lastSent(0), _known(0), _alarms(0) {
+	memset(_value, 0, sizeof(_value));
+}
+
+SensorWatch::SensorWatch(const SensorWatch &other) {
+	*this = other;
+}
+
+SensorWatch& SensorWatch::operator=(const SensorWatch &other) {
+	_active = other._active;
+	_period = other._period;
+	_channels = other._channels;
+	_lastSent = other._lastSent;
+	_known = other._known;
+	_alarms = other._alarms;
+	memcpy(_value, other._value, sizeof(_value));
+	return *this;
+}
+
+SensorWatch::~SensorWatch() {}
+
+void SensorWatch::start(time_t period, uint8_t channels) {
+	_active = true;
+	_period = period;
+	_channels = channels & allChannels;
+	_lastSent = 0;
+	_known = 0;
+}
+
+void SensorWatch::stop() {
+	_active = false;
+}
+
+boolean SensorWatch::active() const {
+	return _active;
+}
+
+time_t SensorWatch::getPeriod() const {
+	return _period;
+}
+
+uint8_t SensorWatch::getChannels() const {
+	return _channels;
+}
+
+boolean SensorWatch::update(const SensorSample &sample, SensorSample &changes) {
+	if (!_active || ((_known != 0) && (sample.time - _lastSent < _period)))
+		return false;
+	changes.time = sample.time;
+	changes.present = 0;
+	changes.alarms = sample.alarms;
+	uint8_t watched = sample.present & _channels;
+	for (uint8_t i = 0; i < LogRecord::nChannels; i++) {
+		uint8_t bit = 1 << i;
+		changes.value[i] = sample.value[i];
+		if ((watched & bit) && (!(_known & bit) || (_value[i] != sample.value[i]))) {
+			changes.present |= bit;
+			_value[i] = sample.value[i];
+		}
+	}
+	if (!(_known & alarmsBit) || (_alarms != sample.alarms)) {
+		changes.present |= alarmsBit;
+		_alarms = sample.alarms;
+	}
+	//Sensors gone, as reservoir ones when module is turned off, are sent again when back
+	_known = watched | alarmsBit;
+	if (changes.present == 0)
+		return false;
+	if (changes.present & LogRecord::tempBit)
+		changes.present |= sample.present & LogRecord::fahrenheitBit;
+	_lastSent = sample.time;
+	return true;
+}
+
+boolean SensorWatch::parsePeriod(const char *str, time_t &period) {
+	if ((str == NULL) || !isdigit(str[0]))
+		return false;
+	uint32_t n = 0;
+	while (isdigit(*str)) {
+		n = n * 10 + (*str - '0');
+		if (n > maxPeriod)
+			return false;
+		str++;
+	}
+	if ((str[0] != '\0') && (str[1] != '\0'))
+		return false;
+	switch (str[0]) {
+		case '\0':
+		case 's':
+			period = n;
+			break;
+		case 'm':
+			period = n * SECS_PER_MIN;
+			break;
+		case 'h':
+			period = n * SECS_PER_HOUR;
+			break;
+		default:
+			return false;
+	}
+	return (period > 0) && (period <= maxPeriod);
+}
@@ -0,0 +1,73 @@
+// #############################################################################
+//
+// # Name       : SensorWatch
+//
+// # Description: Decides what a serial watch pushes after each sensors update
+// # A host watching the unit used to send "status" over and over, getting every
+// # reading back each time. Here the unit remembers what it last sent and, once the
+// # watch period has gone by, hands out only the watched readings and alarm bits
+// # that changed since. If nothing did, nothing is sent, so traffic follows change.
+// # Readings are compared as the fixed-point figures they are sent as.
+//
+// #  This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// #############################################################################
+
+#ifndef SENSORWATCH_H
+#define SENSORWATCH_H
+
+#include <Arduino.h>
+#include <Time.h>
+#include <Telemetry.h>
+#include "SensorAggregate.h"
+
+class SensorWatch {
+	public:
+		//Every sensor channel, LogRecord present bits
+		static const uint8_t allChannels = LogRecord::tempBit | LogRecord::humidityBit | LogRecord::lightBit
+			| LogRecord::ecBit | LogRecord::phBit | LogRecord::levelBit;
+		//Changes present bit: alarm bits changed
+		static const uint8_t alarmsBit = TelemetryChanges::alarmsBit;
+		static const time_t maxPeriod = SECS_PER_DAY;
+
+		SensorWatch();
+		SensorWatch(const SensorWatch &other);
+		SensorWatch& operator=(const SensorWatch &other);
+		~SensorWatch();
+
+		//Watches channels, LogRecord present bits, sending at most once each period seconds.
+		//First changes after it hold every watched reading
+		void start(time_t period, uint8_t channels);
+		void stop();
+		boolean active() const;
+		time_t getPeriod() const;
+		uint8_t getChannels() const;
+		//Fills changes with watched readings and alarms that differ from the ones last handed
+		//out, setting their present bits. False if period hasn't gone by or nothing changed
+		boolean update(const SensorSample &sample, SensorSample &changes);
+		//"<n>", "<n>s", "<n>m" or "<n>h", from 1s up to maxPeriod
+		static boolean parsePeriod(const char *str, time_t &period);
+
+	private:
+		boolean _active;
+		time_t _period;
+		uint8_t _channels;
+		time_t _lastSent;
+		//Channels, and alarmsBit, whose last value the host already has
+		uint8_t _known;
+		uint8_t _alarms;
+		int32_t _value[LogRecord::nChannels];
+};
+
+#endif
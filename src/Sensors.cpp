@@ -141,6 +141,23 @@ boolean Sensors::lvlOffRange() {
 	return false;
 }
 
+uint8_t Sensors::alarmState() {
+	uint8_t res = 0;
+	if (_reservoir) {
+		if (_ec.get() > _settings->getECalarmUp())
+			res |= ecHighBit;
+		else if (_ec.get() < _settings->getECalarmDown())
+			res |= ecLowBit;
+		if (_ph.get() > _settings->getPHalarmUp())
+			res |= phHighBit;
+		else if (_ph.get() < _settings->getPHalarmDown())
+			res |= phLowBit;
+		if (_water.get() < _settings->getWaterAlarm())
+			res |= lvlLowBit;
+	}
+	return res;
+}
+
 //Updates sample arrays with readings from sensors and performs smoothing
 void Sensors::update() {
 	_humidity.update();
@@ -54,6 +54,13 @@ class Sensors {
 		Ph,
 		Level
 	};
+	//alarmState() bits
+	static const uint8_t ecHighBit = 0x01;
+	static const uint8_t ecLowBit = 0x02;
+	static const uint8_t phHighBit = 0x04;
+	static const uint8_t phLowBit = 0x08;
+	static const uint8_t lvlLowBit = 0x10;
+	static const uint8_t nAlarmBits = 5;
     //Constructors
     Sensors(Settings *settings);
 	Sensors(const Sensors &other);
@@ -83,6 +90,8 @@ class Sensors {
 	boolean ecOffRange();
 	boolean phOffRange();
 	boolean lvlOffRange();
+	//Which way each reading is off range, as a mask of alarm bits
+	uint8_t alarmState();
     //Updates sample arrays with readings from sensors and smoothes data
     void update();
 	//Reads once from each sensor, fills the array with this measurement and smoothes
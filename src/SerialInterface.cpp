@@ -1,6 +1,54 @@
 #include "SerialInterface.h"
 
 SerialCommand SerialInterface::_cmd(SerialCommand::SERIAL0);
+SettingsTransaction SerialInterface::_transaction;
+BinaryTelemetry SerialInterface::_telemetry;
+boolean SerialInterface::_binary = false;
+uint8_t SerialInterface::_alarmState = 0;
+boolean SerialInterface::_alarmLost = false;
+SensorWatch SerialInterface::_watch;
+SerialInterface::ReplyStep SerialInterface::_reply = NULL;
+uint8_t SerialInterface::_replyStep = 0;
+
+//constexpr so its layout can be checked when building
+constexpr SerialCommandEntry SerialInterface::_commandTable[commandSlots] PROGMEM = {
+	{ commandStr10, SerialInterface::commandBegin },
+	{ NULL, NULL },
+	#if PROFILING
+	{ commandStr17, SerialInterface::commandPerf },
+	#else
+	{ NULL, NULL },
+	#endif
+	{ NULL, NULL },
+	{ commandStr13, SerialInterface::commandBinary },
+	{ commandStr9, SerialInterface::commandSerial },
+	{ NULL, NULL },
+	{ commandStr11, SerialInterface::commandCommit },
+	{ NULL, NULL },
+	{ commandStr15, SerialInterface::commandUnwatch },
+	{ NULL, NULL },
+	{ NULL, NULL },
+	{ commandStr12, SerialInterface::commandAbort },
+	{ NULL, NULL },
+	{ commandStr14, SerialInterface::commandWatch },
+	{ commandStr2, SerialInterface::commandSettings },
+	{ commandStr7, SerialInterface::commandHistory },
+	{ commandStr4, SerialInterface::commandStatus },
+	{ commandStr6, SerialInterface::commandLogs },
+	{ commandStr16, SerialInterface::commandLog },
+	{ commandStr5, SerialInterface::commandSD },
+	{ commandStr3, SerialInterface::commandMemory },
+	{ commandStr1, SerialInterface::commandSensors },
+	{ commandStr8, SerialInterface::commandEeprom },
+	{ NULL, NULL },
+	{ NULL, NULL },
+	{ NULL, NULL },
+	{ NULL, NULL },
+	{ NULL, NULL },
+	{ NULL, NULL },
+	{ commandStr0, SerialInterface::help },
+	{ NULL, NULL }
+};
 
 //Constructors
 SerialInterface::SerialInterface() {}
@@ -16,79 +64,226 @@ SerialInterface& SerialInterface::operator=(const SerialInterface &other) {
 
 SerialInterface::~SerialInterface() {}
 
+//Fails to build if a command isn't in the slot its name hashes to
+#define COMMAND_SLOT(name, slot) static_assert((SerialCommand::hash(name, commandSeed, commandSlots) == slot) \
+	&& (_commandTable[slot].command == name), "Command table out of hash order")
+
 //Adds commands keywords to corresponding processing functions
 void SerialInterface::init() {
+	//Private table is checked here, where SerialCommand is given it
+	COMMAND_SLOT(commandStr0, 30);
+	COMMAND_SLOT(commandStr1, 22);
+	COMMAND_SLOT(commandStr2, 15);
+	COMMAND_SLOT(commandStr3, 21);
+	COMMAND_SLOT(commandStr4, 17);
+	COMMAND_SLOT(commandStr5, 20);
+	COMMAND_SLOT(commandStr6, 18);
+	COMMAND_SLOT(commandStr7, 16);
+	COMMAND_SLOT(commandStr8, 23);
+	COMMAND_SLOT(commandStr9, 5);
+	COMMAND_SLOT(commandStr10, 0);
+	COMMAND_SLOT(commandStr11, 7);
+	COMMAND_SLOT(commandStr12, 12);
+	COMMAND_SLOT(commandStr13, 4);
+	COMMAND_SLOT(commandStr14, 14);
+	COMMAND_SLOT(commandStr15, 9);
+	COMMAND_SLOT(commandStr16, 19);
+	#if PROFILING
+	COMMAND_SLOT(commandStr17, 2);
+	#endif
+	#undef COMMAND_SLOT
 	if (settings.getSerialDebug()) {
 		Serial.begin(115200);
+		SerialReceiver::begin();
 		//Welcome message
-		Serial.println();
-		Serial.println(pmChar(welcome0));
-		Serial.println(pmChar(welcome1));
-		Serial.println();
+		serialTx.println();
+		serialTx.println(pmChar(welcome0));
+		serialTx.println(pmChar(welcome1));
+		serialTx.println();
 		// Setup callbacks for SerialCommand commands
-		_cmd.addCommand(pmChar(commands[0]),SerialInterface::help);
-		_cmd.addCommand(pmChar(commands[1]),SerialInterface::commandSensors);
-		_cmd.addCommand(pmChar(commands[2]),SerialInterface::commandSettings);
-		_cmd.addCommand(pmChar(commands[3]),SerialInterface::commandMemory);
-		_cmd.addCommand(pmChar(commands[4]),SerialInterface::commandStatus);
+		_cmd.setCommands(_commandTable,commandSlots,commandSeed);
 		// Handler for command that isn't found
 		_cmd.addDefaultHandler(notFound);
-		timeStamp(serialRdyTxt);
+		timeStamp(serialRdyTxt,LOG_LEVEL_INFO,LogModule::Console);
 	}
 }
 
 //Ends serial communication
 void SerialInterface::end() {
-	timeStamp(serialOffTxt);
+	timeStamp(serialOffTxt,LOG_LEVEL_INFO,LogModule::Console);
+	serialTx.flush();
+	SerialReceiver::end();
 	Serial.end();
 }
 
-//Checks in buffers and calls appropriate handle
+//Runs oldest command line received, one per loop. Rest wait in SerialReceiver.
+//Commands in a line are separated by ';' and run in order, each once output of
+//the one before is out of TX ring. While a transfer is going on lines wait there
+//too, as any reply would wait for it to end. Only those starting with a logs
+//command get past them, so it can be stopped
 void SerialInterface::processInput() {
-	_cmd.readSerial();
-	_cmd.clearBuffer();
-	//Clears incoming Serial buffer
-	while (Serial.available() > 0)
-		Serial.read();
+	holdForTransfer();
+	serialTx.poll();
+	continueReply();
+	if (!serialTx.held() && outputBusy())
+		return;
+	char line[SerialReceiver::lineSize];
+	uint8_t n = 0;
+	while (true) {
+		if (!SerialReceiver::peekLine(line,n))
+			return;
+		if (!serialTx.held() || isCommand(line,commandStr6))
+			break;
+		n++;
+	}
+	uint8_t length = strlen(line) + 1;
+	char *command = line;
+	while (command != NULL) {
+		//Rest of the line waits in the ring for the transfer or output to end
+		if (serialTx.held() ? !isCommand(command,commandStr6) : outputBusy()) {
+			SerialReceiver::dropLine(n,command - line);
+			return;
+		}
+		char *next = strchr(command,';');
+		if (next != NULL)
+			*next++ = '\0';
+		if (strlen(command) < SERIALCOMMANDBUFFER) {
+			_cmd.dispatch(command);
+			holdForTransfer();
+		} else {
+			serialTx.println();
+			printLn(tooLongTxt);
+			if (_transaction.active())
+				_transaction.reject();
+		}
+		command = next;
+	}
+	SerialReceiver::dropLine(n,length);
+}
+
+void SerialInterface::holdForTransfer() {
+	boolean busy = logExport.busy() || history.busy();
+	if (busy == serialTx.held())
+		return;
+	//Whatever was queued before goes out first
+	if (busy)
+		serialTx.flush();
+	serialTx.hold(busy);
+	if (!busy && _alarmLost)
+		sendAlarm();
+}
+
+void SerialInterface::reply(ReplyStep first) {
+	_reply = first;
+	_replyStep = 0;
+	continueReply();
+}
+
+void SerialInterface::continueReply() {
+	while ((_reply != NULL) && (serialTx.room() >= replyRoom)) {
+		if (!_reply(_replyStep++))
+			_reply = NULL;
+	}
+}
+
+boolean SerialInterface::outputBusy() {
+	return (_reply != NULL) || (serialTx.queued() > 0);
+}
+
+boolean SerialInterface::isCommand(const char *line, const char *pmName) {
+	while (*line == ' ')
+		line++;
+	size_t n = strlen_P(pmName);
+	return (strncmp_P(line,pmName,n) == 0) && ((line[n] == '\0') || (line[n] == ' ') || (line[n] == ';'));
 }
 
 //Prints number preceeded by a '0' if needed
 void SerialInterface::printDecNum(const uint8_t num) {
-	(num < 10) ? Serial.print(F("0")) : 0;
-	Serial.print(num);
+	TextFormat::printUInt(serialTx, num, 2, '0');
 }
 
-//Writes "HH:MM:SS - <Text>" to serial console if serial debugging is on
-//Assumes a PROGMEM char* as input
-void SerialInterface::timeStamp(const char* txt) const {
-	if (settings.getSerialDebug()) {
+//Writes "HH:MM:SS - <Text>" to serial console if serial debugging is on, or an event frame
+//if binary telemetry is. Assumes a PROGMEM char* as input.
+//Queued as a message so a debug or info one is dropped whole, frame included, if TX ring is
+//full or held for a transfer
+void SerialInterface::timeStamp(const char* txt, uint8_t level, uint8_t module) const {
+	if (settings.getSerialDebug() && serialTx.enabled(module,level)) {
+		serialTx.beginMessage(level);
+		if (_binary) {
+			_telemetry.sendEvent(serialTx, now(), txt);
+			serialTx.endMessage();
+			return;
+		}
 		time_t t = now();
 		uint8_t h = hour(t);
 		uint8_t m = minute(t);
 		uint8_t s = second(t);
 		printDecNum(h);
-		Serial.print(pmChar(timeDots));
+		serialTx.print(pmChar(timeDots));
 		printDecNum(m);
-		Serial.print(pmChar(timeDots));
+		serialTx.print(pmChar(timeDots));
 		printDecNum(s);
-		Serial.print(pmChar(timeStampSeparator));
-		Serial.println(pmChar(txt));
+		serialTx.print(pmChar(timeStampSeparator));
+		serialTx.println(pmChar(txt));
+		serialTx.endMessage();
 	}
 }
 
-//Converts a char array from PROGMEM to variable in SRAM
-char* SerialInterface::pmChar(const char *pmArray) {
-	strcpy_P(charBuffer, (char*)pmArray);
-	return charBuffer;
+void SerialInterface::alarm(uint8_t state) const {
+	_alarmState = state;
+	sendAlarm();
+}
+
+//An error message, so it waits out a transfer in TX ring. If ring had no room
+//current state is sent once the transfer is over
+void SerialInterface::sendAlarm() {
+	if (!_binary || !settings.getSerialDebug())
+		return;
+	serialTx.beginMessage(LOG_LEVEL_ERROR);
+	_telemetry.sendAlarm(serialTx, now(), _alarmState);
+	_alarmLost = !serialTx.endMessage();
+}
+
+//Quiet while logs or history are being sent; changes keep adding up meanwhile
+void SerialInterface::watch(const SensorSample &sample) const {
+	SensorSample changes;
+	if (!settings.getSerialDebug() || logExport.busy() || history.busy() || !_watch.update(sample,changes))
+		return;
+	if (_binary) {
+		_telemetry.sendChanges(serialTx, changes);
+		return;
+	}
+	//HH:MM:SS, then a column per watched sensor, empty if it didn't change
+	printDecNum(hour(changes.time));
+	serialTx.print(pmChar(timeDots));
+	printDecNum(minute(changes.time));
+	serialTx.print(pmChar(timeDots));
+	printDecNum(second(changes.time));
+	for (uint8_t i = 0; i < LogRecord::nChannels; i++) {
+		if (_watch.getChannels() & (1 << i)) {
+			serialTx.print(',');
+			if (changes.present & (1 << i))
+				LogRecord::printValue(serialTx, i, changes.value[i]);
+		}
+	}
+	serialTx.print(',');
+	if (changes.present & SensorWatch::alarmsBit)
+		TextFormat::printUInt(serialTx, changes.alarms);
+	serialTx.println();
+}
+
+//Tags a char array in PROGMEM so it gets printed from flash with no SRAM copy
+const __FlashStringHelper* SerialInterface::pmChar(const char *pmArray) {
+	return reinterpret_cast<const __FlashStringHelper*>(pmArray);
 }
 
 //Prints a decorated line with optional leading and trailing blank lines
 //Assumes a PROGMEM char* as input
 void SerialInterface::printLn(const char* ln, boolean leadingBlankLine, boolean trailingBlankLine) {
-	(leadingBlankLine) ? Serial.println() : 0;
-	Serial.print(pmChar(lineDeco));
-	Serial.println(pmChar(ln));
-	(trailingBlankLine) ? Serial.println() : 0;
+	(leadingBlankLine) ? serialTx.println() : 0;
+	serialTx.print(pmChar(lineDeco));
+	serialTx.println(pmChar(ln));
+	(trailingBlankLine) ? serialTx.println() : 0;
 }
 
 //Lists an array ending with an additional blank line
@@ -102,38 +297,33 @@ void SerialInterface::list(int length, const char* const names[]) {
 //Prints "> Text: "
 //Assumes a PROGMEM char* as input
 void SerialInterface::printName(const char* ln) {
-	Serial.print(pmChar(lineDeco));
-	Serial.print(pmChar(ln));
-	Serial.print(pmChar(textSeparator));
-}
-
-//Prints "> 'ln' successfuly updated to: 'arg'"
-void SerialInterface::printUpdated(const char* ln, const char* arg) {
-	Serial.print(pmChar(lineDeco));
-	Serial.print(pmChar(ln));
-	Serial.print(pmChar(successTxt));
-	Serial.println(arg);
+	serialTx.print(pmChar(lineDeco));
+	serialTx.print(pmChar(ln));
+	serialTx.print(pmChar(textSeparator));
 }
 
 void SerialInterface::notFound() {
-	Serial.println();
-	Serial.print(pmChar(helpTxt0));
-	Serial.println(versionNumber,2);
+	if (_transaction.active())
+		_transaction.reject();
+	serialTx.println();
+	serialTx.print(pmChar(helpTxt0));
+	serialTx.println(versionNumber,2);
 	printLn(helpTxt1,false,true);
-	list(nCommands,commands);
+	reply(replyCommands);
 }
 
 //This gets set as the default handler, and gets called when no other command matches.
 void SerialInterface::help() {
 	//Read argument following "help"
 	char *arg = _cmd.next();
-	Serial.println();
+	serialTx.println();
 	//Not more words or "help help"
 	if ((arg == NULL) || (strcmp_P(arg,commands[0]) == 0)) {
-		Serial.print(pmChar(helpTxt0));
-		Serial.println(versionNumber,2);
-		printLn(helpTxt1,false,true);
-		list(nCommands,commands);
+		serialTx.print(pmChar(helpTxt0));
+		serialTx.println(versionNumber,2);
+		printLn(helpTxt1);
+		printLn(helpTxt2,false,true);
+		reply(replyCommands);
 	//help sensors
 	//if arg == commands[1]
 	} else if (strcmp_P(arg,commands[1]) == 0) {
@@ -149,22 +339,52 @@ void SerialInterface::help() {
 	//help status
 	else if (strcmp_P(arg,commands[4]) == 0)
 		printLn(statusHelpTxt);
+	//help sd
+	else if (strcmp_P(arg,commands[5]) == 0)
+		printLn(sdHelpTxt);
+	//help logs
+	else if (strcmp_P(arg,commands[6]) == 0)
+		printLn(logsHelpTxt);
+	//help history
+	else if (strcmp_P(arg,commands[7]) == 0)
+		printLn(historyHelpTxt);
+	//help eeprom
+	else if (strcmp_P(arg,commands[8]) == 0)
+		printLn(eepromHelpTxt);
+	//help serial
+	else if (strcmp_P(arg,commands[9]) == 0)
+		printLn(serialHelpTxt);
+	//help begin, commit, abort
+	else if ((strcmp_P(arg,commands[10]) == 0) || (strcmp_P(arg,commands[11]) == 0) || (strcmp_P(arg,commands[12]) == 0))
+		printLn(transactionHelpTxt);
+	//help binary
+	else if (strcmp_P(arg,commands[13]) == 0)
+		printLn(binaryHelpTxt);
+	//help watch, unwatch
+	else if ((strcmp_P(arg,commands[14]) == 0) || (strcmp_P(arg,commands[15]) == 0))
+		printLn(watchHelpTxt);
+	//help log
+	else if (strcmp_P(arg,commands[16]) == 0)
+		printLn(logHelpTxt);
+	#if PROFILING
+	//help perf
+	else if (strcmp_P(arg,commands[17]) == 0)
+		printLn(perfHelpTxt);
+	#endif
 	//not recognized
 	else {
-		Serial.println();
-		Serial.print(pmChar(noHelp));
-		Serial.print(arg);
-		Serial.println(pmChar(lineDeco));
+		serialTx.println();
+		serialTx.print(pmChar(noHelp));
+		serialTx.print(arg);
+		serialTx.println(pmChar(lineDeco));
 	}
 		
 }
 
-//Uses external FreeMemory library
+//Prints MemoryMonitor telemetry
 void SerialInterface::commandMemory() {
-	Serial.println();
-	Serial.print(pmChar(memoryTxt));
-	Serial.print(freeMemory());
-	Serial.println(pmChar(memoryTxt1));
+	serialTx.println();
+	MemoryMonitor::print(serialTx);
 }
 
 //Sends sensor data through serial
@@ -179,55 +399,321 @@ void SerialInterface::commandStatus() {
 		uint16_t y = year(t);
 		int mem = freeMemory();
 		
-		Serial.println();
+		serialTx.println();
 		//Date
-		Serial.print(pmChar(dateTxt));
+		serialTx.print(pmChar(dateTxt));
 		printDecNum(d);
-		Serial.print(pmChar(dateSlash));
+		serialTx.print(pmChar(dateSlash));
 		printDecNum(mo);
-		Serial.print(pmChar(dateSlash));
-		Serial.println(y);
+		serialTx.print(pmChar(dateSlash));
+		TextFormat::printUInt(serialTx, y);
+		serialTx.println();
 		//Time
-		Serial.print(pmChar(timeTxt));
+		serialTx.print(pmChar(timeTxt));
 		printDecNum(h);
-		Serial.print(pmChar(timeDots));
+		serialTx.print(pmChar(timeDots));
 		printDecNum(m);
-		Serial.print(pmChar(timeDots));
+		serialTx.print(pmChar(timeDots));
 		printDecNum(s);
-		Serial.println();
+		serialTx.println();
 		//Memory
-		Serial.print(pmChar(memoryTxt));
-		Serial.print(mem);
-		Serial.println(pmChar(memoryTxt1));
+		serialTx.print(pmChar(memoryTxt));
+		TextFormat::printInt(serialTx, mem);
+		serialTx.println(pmChar(memoryTxt1));
 		//Temp
-		Serial.print(pmChar(tempTxt));
-		Serial.print(sensors.getTemp());
-		(settings.getCelsius()) ? Serial.println(pmChar(celsTxt)) : Serial.println(pmChar(fahrTxt));
+		serialTx.print(pmChar(tempTxt));
+		TextFormat::printFloat(serialTx, sensors.getTemp(), 2);
+		(settings.getCelsius()) ? serialTx.println(pmChar(celsTxt)) : serialTx.println(pmChar(fahrTxt));
 		//Humidity
-		Serial.print(pmChar(humidTxt));
-		Serial.print(sensors.getHumidity());
-		Serial.println(pmChar(percentTxt));
+		serialTx.print(pmChar(humidTxt));
+		TextFormat::printUInt(serialTx, sensors.getHumidity());
+		serialTx.println(pmChar(percentTxt));
 		//Light
-		Serial.print(pmChar(lightTxt));
-		Serial.print(sensors.getLight());
-		Serial.println(pmChar(luxTxt));
+		serialTx.print(pmChar(lightTxt));
+		TextFormat::printUInt(serialTx, sensors.getLight());
+		serialTx.println(pmChar(luxTxt));
 		//Reservoir module
 		if (settings.getReservoirModule()) {
 			//EC
-			Serial.print(pmChar(elecTxt));
-			Serial.print(sensors.getEC());
-			Serial.println(pmChar(ecUnitsTxt));
+			serialTx.print(pmChar(elecTxt));
+			TextFormat::printFloat(serialTx, sensors.getEC(), 2);
+			serialTx.println(pmChar(ecUnitsTxt));
 			//pH
-			Serial.print(pmChar(pihTxt));
-			Serial.println(sensors.getPH());
+			serialTx.print(pmChar(pihTxt));
+			TextFormat::printFloat(serialTx, sensors.getPH(), 2);
+			serialTx.println();
 			//Level
-			Serial.print(pmChar(levelTxt));
-			Serial.print(sensors.getWaterLevel());
-			Serial.println(pmChar(percentTxt));
+			serialTx.print(pmChar(levelTxt));
+			TextFormat::printUInt(serialTx, sensors.getWaterLevel());
+			serialTx.println(pmChar(percentTxt));
 		}
 	}
 }
 
+void SerialInterface::commandSD() {
+	serialTx.println();
+	serialTx.println(pmChar(sdWritesTxt));
+	serialTx.print(pmChar(lineDeco));
+	sdLogger.getWriteStats().print(serialTx);
+	serialTx.println();
+	serialTx.print(pmChar(sdMaxStepTxt));
+	TextFormat::printUInt(serialTx, sdLogger.getMaxStep());
+	serialTx.println(pmChar(usTxt));
+	serialTx.print(pmChar(sdDroppedTxt));
+	TextFormat::printUInt(serialTx, sdLogger.getDropped());
+	serialTx.println();
+	serialTx.print(pmChar(sdRollupsDroppedTxt));
+	TextFormat::printUInt(serialTx, rollups.getDropped());
+	serialTx.println();
+	serialTx.print(pmChar(sdBufferedTxt));
+	TextFormat::printUInt(serialTx, sdLogger.buffered());
+	serialTx.println(pmChar(memoryTxt1));
+	sdLogger.resetStats();
+}
+
+void SerialInterface::commandLogs() {
+	char *arg = _cmd.next();
+	serialTx.println();
+	//A history query is stopped too, both write Serial directly
+	//logs list
+	if ((arg != NULL) && (strcmp_P(arg,logsCommands[0]) == 0)) {
+		history.stop();
+		if (!logExport.list())
+			printLn(noCardTxt);
+	//logs cat YYYYMMDD
+	} else if ((arg != NULL) && (strcmp_P(arg,logsCommands[1]) == 0)) {
+		time_t day;
+		if (LogExport::parseDay(_cmd.next(),day)) {
+			history.stop();
+			logExport.range(day,day);
+		} else
+			printLn(dayTxt);
+	//logs range YYYYMMDD YYYYMMDD
+	} else if ((arg != NULL) && (strcmp_P(arg,logsCommands[2]) == 0)) {
+		time_t from, to;
+		if (LogExport::parseDay(_cmd.next(),from) && LogExport::parseDay(_cmd.next(),to) && (from <= to)) {
+			history.stop();
+			logExport.range(from,to);
+		} else
+			printLn(dayTxt);
+	//logs stop
+	} else if ((arg != NULL) && (strcmp_P(arg,logsCommands[3]) == 0)) {
+		logExport.stop();
+		history.stop();
+	} else {
+		printLn(commandsTxT);
+		list(nLogsC,logsCommands);
+	}
+}
+
+//serial
+void SerialInterface::commandSerial() {
+	serialTx.println();
+	reply(replySerial);
+}
+
+//log, log <module> <level> or log * <level>
+void SerialInterface::commandLog() {
+	char *arg = _cmd.next();
+	serialTx.println();
+	if (arg == NULL) {
+		for (uint8_t i = 0; i < nModules; i++) {
+			printName((char*)pgm_read_word(&moduleNames[i]));
+			serialTx.println(pmChar((char*)pgm_read_word(&levelNames[serialTx.getLevel(i)])));
+		}
+		return;
+	}
+	int8_t module = -1;
+	for (uint8_t i = 0; i < nModules; i++) {
+		if (strcmp_P(arg,(char*)pgm_read_word(&moduleNames[i])) == 0)
+			module = i;
+	}
+	boolean all = (strcmp_P(arg,allSettingsStr) == 0);
+	char *levelArg = _cmd.next();
+	int8_t level = -1;
+	for (uint8_t i = 0; (levelArg != NULL) && (i < nLevels); i++) {
+		if (strcmp_P(levelArg,(char*)pgm_read_word(&levelNames[i])) == 0)
+			level = i;
+	}
+	if (((module < 0) && !all) || (level < 0)) {
+		printLn(logLevelTxt);
+		printLn(modulesTxt);
+		list(nModules,moduleNames);
+		printLn(levelsTxt);
+		list(nLevels,levelNames);
+		return;
+	}
+	for (uint8_t i = 0; i < nModules; i++) {
+		if (all || (i == module)) {
+			serialTx.setLevel(i,level);
+			printName((char*)pgm_read_word(&moduleNames[i]));
+			serialTx.println(pmChar((char*)pgm_read_word(&levelNames[level])));
+		}
+	}
+}
+
+//<binary status>, <binary settings>, <binary on> or <binary off>
+void SerialInterface::commandBinary() {
+	char *arg = _cmd.next();
+	if ((arg != NULL) && (strcmp_P(arg,commandStr4) == 0)) {
+		SensorSample sample;
+		readSample(sample);
+		_telemetry.sendSnapshot(serialTx, sample);
+	} else if ((arg != NULL) && (strcmp_P(arg,commandStr2) == 0))
+		_telemetry.sendSettings(serialTx, settings);
+	else if ((arg != NULL) && (strcmp_P(arg,boolOnStr) == 0)) {
+		serialTx.println();
+		printLn(binaryOnTxt);
+		_binary = true;
+	} else if ((arg != NULL) && (strcmp_P(arg,boolOffStr) == 0)) {
+		_binary = false;
+		serialTx.println();
+		printLn(binaryOffTxt);
+	} else {
+		serialTx.println();
+		printLn(binaryHelpTxt);
+	}
+}
+
+//watch <period> [sensors]
+void SerialInterface::commandWatch() {
+	time_t period;
+	boolean valid = SensorWatch::parsePeriod(_cmd.next(),period);
+	uint8_t channels = 0;
+	char *arg;
+	while (valid && ((arg = _cmd.next()) != NULL)) {
+		Sensors::Sensor sens = interpretSensor(arg);
+		if (sens == Sensors::None)
+			valid = false;
+		else
+			channels |= 1 << (sens - 1);
+	}
+	serialTx.println();
+	if (!valid) {
+		printLn(periodTxt);
+		printLn(sensorsTxT);
+		list(nSensors,sensorsNames);
+		return;
+	}
+	if (channels == 0)
+		channels = SensorWatch::allChannels;
+	_watch.start(period,channels);
+	printLn(watchStartTxt);
+	//CSV header
+	if (!_binary) {
+		serialTx.print(pmChar(timeColumnTxt));
+		for (uint8_t i = 0; i < nSensors; i++) {
+			if (channels & (1 << i)) {
+				serialTx.print(',');
+				serialTx.print(pmChar((char*)pgm_read_word(&sensorsNames[i])));
+			}
+		}
+		serialTx.println(pmChar(alarmsColumnTxt));
+	}
+}
+
+void SerialInterface::commandUnwatch() {
+	serialTx.println();
+	if (_watch.active()) {
+		_watch.stop();
+		printLn(watchStopTxt);
+	} else
+		printLn(watchNoneTxt);
+}
+
+void SerialInterface::commandBegin() {
+	serialTx.println();
+	if (_transaction.active())
+		printLn(txnOpenTxt);
+	else {
+		_transaction.begin();
+		printLn(txnBeginTxt);
+	}
+}
+
+//Prints every committed setting with its new value
+void SerialInterface::commandCommit() {
+	serialTx.println();
+	if (!_transaction.active()) {
+		printLn(txnNoneTxt);
+		return;
+	}
+	if (_transaction.commit(settings)) {
+		for (uint8_t n = 0; n < _transaction.staged(); n++) {
+			SettingInfo info;
+			SettingsRegistry::info(_transaction.setting(n),info);
+			applySetting(info.id);
+		}
+		reply(replyCommitted);
+	} else {
+		serialTx.print(pmChar(lineDeco));
+		TextFormat::printUInt(serialTx, _transaction.rejected());
+		serialTx.println(pmChar(txnRejectedTxt));
+	}
+}
+
+void SerialInterface::commandAbort() {
+	serialTx.println();
+	if (!_transaction.active()) {
+		printLn(txnNoneTxt);
+		return;
+	}
+	_transaction.abort();
+	serialTx.print(pmChar(lineDeco));
+	TextFormat::printUInt(serialTx, _transaction.staged());
+	serialTx.println(pmChar(txnAbortedTxt));
+}
+
+//eeprom [flush]
+void SerialInterface::commandEeprom() {
+	char *arg = _cmd.next();
+	if ((arg != NULL) && (strcmp_P(arg,eepromStr0) == 0))
+		settings.flush();
+	const SettingsStore &store = settings.getStore();
+	serialTx.println();
+	serialTx.print(pmChar(eeDirtyTxt));
+	TextFormat::printUInt(serialTx, store.dirty());
+	serialTx.println();
+	serialTx.print(pmChar(eePendingTxt));
+	TextFormat::printUInt(serialTx, store.pending());
+	serialTx.println(pmChar(memoryTxt1));
+	serialTx.print(pmChar(eeSavesTxt));
+	TextFormat::printUInt(serialTx, store.getSaves());
+	serialTx.print('/');
+	TextFormat::printUInt(serialTx, store.getCoalesced());
+	serialTx.print('/');
+	TextFormat::printUInt(serialTx, store.getRecordsWritten());
+	serialTx.println();
+	serialTx.print(pmChar(eeBytesTxt));
+	TextFormat::printUInt(serialTx, store.getBytesWritten());
+	serialTx.println();
+	serialTx.print(pmChar(eeSlotTxt));
+	TextFormat::printUInt(serialTx, store.getSlot());
+	serialTx.println();
+}
+
+//history <sensor> <window>
+void SerialInterface::commandHistory() {
+	Sensors::Sensor sens = interpretSensor(_cmd.next());
+	time_t window;
+	serialTx.println();
+	//HistoryQuery writes its header to Serial directly
+	serialTx.flush();
+	if ((sens != Sensors::None) && HistoryQuery::parseWindow(_cmd.next(),window))
+		history.start(sens - 1,window);
+	else {
+		printLn(windowTxt);
+		printLn(sensorsTxT);
+		list(nSensors,sensorsNames);
+	}
+}
+
+#if PROFILING
+void SerialInterface::commandPerf() {
+	reply(replyPerf);
+}
+#endif
+
 //Returns command contained in input keyword or Invalid
 SerialInterface::Command SerialInterface::interpretCommand(char* keyword) {
 	if (keyword == NULL)
@@ -239,6 +725,8 @@ SerialInterface::Command SerialInterface::interpretCommand(char* keyword) {
 		return Get;
 	else if (strcmp_P(keyword,settingsCommands[2]) == 0)
 		return Set;
+	else if (strcmp_P(keyword,settingsCommands[3]) == 0)
+		return Help;
 	else
 		return Invalid;
 }
@@ -264,73 +752,6 @@ Sensors::Sensor SerialInterface::interpretSensor(char* keyword) {
 		return Sensors::None;
 }
 
-//Returns setting contained in input keyword or None
-Settings::Setting SerialInterface::interpretSetting(char* keyword) {
-	if (keyword == NULL)
-		return Settings::None;
-	else if (strcmp_P(keyword,settingsNames[0]) == 0)
-		return Settings::WaterTimed;
-	else if (strcmp_P(keyword,settingsNames[1]) == 0)
-		return Settings::WaterHour;
-	else if (strcmp_P(keyword,settingsNames[2]) == 0)
-		return Settings::WaterMinute;
-	else if (strcmp_P(keyword,settingsNames[3]) == 0)
-		return Settings::FloodMinute;
-	else if (strcmp_P(keyword,settingsNames[4]) == 0)
-		return Settings::PHalarmUp;
-	else if (strcmp_P(keyword,settingsNames[5]) == 0)
-		return Settings::PHalarmDown;
-	else if (strcmp_P(keyword,settingsNames[6]) == 0)
-		return Settings::ECalarmUp;
-	else if (strcmp_P(keyword,settingsNames[7]) == 0)
-		return Settings::ECalarmDown;
-	else if (strcmp_P(keyword,settingsNames[8]) == 0)
-			return Settings::WaterAlarm;
-	else if (strcmp_P(keyword,settingsNames[9]) == 0)
-		return Settings::NightWatering;
-	else if (strcmp_P(keyword,settingsNames[10]) == 0)
-		return Settings::LightThreshold;
-	else if (strcmp_P(keyword,settingsNames[11]) == 0)
-		return Settings::MaxWaterLvl;
-	else if (strcmp_P(keyword,settingsNames[12]) == 0)
-		return Settings::MinWaterLvl;
-	else if (strcmp_P(keyword,settingsNames[13]) == 0)
-		return Settings::PumpProtectionLvl;
-	else if (strcmp_P(keyword,settingsNames[14]) == 0)
-		return Settings::PumpProtection;
-	else if (strcmp_P(keyword,settingsNames[15]) == 0)
-		return Settings::SensorSecond;
-	else if (strcmp_P(keyword,settingsNames[16]) == 0)
-		return Settings::SDactive;
-	else if (strcmp_P(keyword,settingsNames[17]) == 0)
-		return Settings::SDhour;
-	else if (strcmp_P(keyword,settingsNames[18]) == 0)
-		return Settings::SDminute;
-	else if (strcmp_P(keyword,settingsNames[19]) == 0)
-		return Settings::Sound;
-	else if (strcmp_P(keyword,settingsNames[20]) == 0)
-		return Settings::SerialDebug;
-	else if (strcmp_P(keyword,settingsNames[21]) == 0)
-		return Settings::ReservoirModule;
-	else if (strcmp_P(keyword,settingsNames[22]) == 0)
-		return Settings::NextWhour;
-	else if (strcmp_P(keyword,settingsNames[23]) == 0)
-		return Settings::NextWminute;
-	else if (strcmp_P(keyword,settingsNames[24]) == 0)
-		return Settings::NightWateringStopped;
-	else if (strcmp_P(keyword,settingsNames[25]) == 0)
-		return Settings::WateringPlants;
-	else if (strcmp_P(keyword,settingsNames[26]) == 0)
-		return Settings::AlarmTriggered;
-	else if (strcmp_P(keyword,settingsNames[27]) == 0)
-		return Settings::Led;
-	else if (strcmp_P(keyword,settingsNames[28]) == 0)
-		return Settings::Celsius;
-	//Word unrecognised
-	else
-		return Settings::None;
-}
-
 //In charge when first word is sensors
 void SerialInterface::commandSensors() {
 	Command comm;
@@ -341,7 +762,7 @@ void SerialInterface::commandSensors() {
 	arg = _cmd.next();
 	sens = interpretSensor(arg);
 	
-	Serial.println();
+	serialTx.println();
 	switch (comm) {
 		case Invalid:
 			printLn(commandsTxT);
@@ -372,43 +793,44 @@ void SerialInterface::getSensor(Sensors::Sensor sens) {
 			break;
 		case Sensors::Temperature:
 			printName(sensorsNames[0]);
-			Serial.print(sensors.getTemp());
-			(settings.getCelsius()) ? Serial.println(pmChar(celsTxt)) : Serial.println(pmChar(fahrTxt));
+			TextFormat::printFixed(serialTx, TextFormat::toFixed(sensors.getTemp(), 2), 2);
+			(settings.getCelsius()) ? serialTx.println(pmChar(celsTxt)) : serialTx.println(pmChar(fahrTxt));
 			break;
 		case Sensors::Humidity:
 			printName(sensorsNames[1]);
-			Serial.print(sensors.getHumidity());
-			Serial.println(pmChar(percentTxt));
+			TextFormat::printUInt(serialTx, sensors.getHumidity());
+			serialTx.println(pmChar(percentTxt));
 			break;
 		case Sensors::Light:
 			printName(sensorsNames[2]);
-			Serial.print(sensors.getLight());
-			Serial.println(pmChar(luxTxt));
+			TextFormat::printUInt(serialTx, sensors.getLight());
+			serialTx.println(pmChar(luxTxt));
 			break;
 		case Sensors::Ec:
 			if (settings.getReservoirModule()) {
 				printName(sensorsNames[3]);
-				Serial.print(sensors.getEC());	
-				Serial.println(pmChar(ecUnitsTxt));			
+				TextFormat::printFixed(serialTx, TextFormat::toFixed(sensors.getEC(), 2), 2);
+				serialTx.println(pmChar(ecUnitsTxt));			
 			} else {
-				Serial.println(pmChar(noReservoir));
+				serialTx.println(pmChar(noReservoir));
 			}
 			break;
 		case Sensors::Ph:
 			if (settings.getReservoirModule()) {
 				printName(sensorsNames[4]);
-				Serial.println(sensors.getPH());				
+				TextFormat::printFixed(serialTx, TextFormat::toFixed(sensors.getPH(), 2), 2);
+				serialTx.println();				
 			} else {
-				Serial.println(pmChar(noReservoir));
+				serialTx.println(pmChar(noReservoir));
 			}
 			break;
 		case Sensors::Level:
 			if (settings.getReservoirModule()) {
 				printName(sensorsNames[5]);
-				Serial.print(sensors.getWaterLevel());
-				Serial.println(pmChar(percentTxt));				
+				TextFormat::printUInt(serialTx, sensors.getWaterLevel());
+				serialTx.println(pmChar(percentTxt));				
 			} else {
-				Serial.println(pmChar(noReservoir));
+				serialTx.println(pmChar(noReservoir));
 			}
 			break;
 	}
@@ -417,478 +839,185 @@ void SerialInterface::getSensor(Sensors::Sensor sens) {
 //Links keywords to program logic and executes commands
 void SerialInterface::commandSettings() {
 	Command comm;
-	Settings::Setting sett;
+	int8_t sett;
 	//Read second word and get command
 	char *arg = _cmd.next();
 	comm = interpretCommand(arg);
 	arg = _cmd.next();
-	sett = interpretSetting(arg);
+	sett = SettingsRegistry::find(arg);
 	
-	Serial.println();
+	serialTx.println();
 	switch (comm) {
-		case Invalid:
-			printLn(commandsTxT);
-			list(nSettingsC,settingsCommands);
-			break;
 		case List:
-			printLn(settingsTxt);
-			list(nSettings,settingsNames);
+			listSettings();
 			break;
 		case Get:
-			if (sett == Settings::None) {
-				printLn(settingsTxt);
-				list(nSettings,settingsNames);
-			} else
+			if ((arg != NULL) && (strcmp_P(arg,allSettingsStr) == 0))
+				reply(replySettings);
+			else if (sett == SettingsRegistry::notFound)
+				listSettings();
+			else
 				getSetting(sett);
 			break;
 		case Set:
-			if (sett == Settings::None) {
-				printLn(settingsTxt);
-				list(nSettings,settingsNames);
+			if (sett == SettingsRegistry::notFound) {
+				if (_transaction.active())
+					_transaction.reject();
+				listSettings();
 			} else
-				setSetting(sett);
+				setSetting(sett,_cmd.next());
+			break;
+		case Help:
+			if (sett == SettingsRegistry::notFound)
+				reply(replySettingRanges);
+			else
+				helpSetting(sett);
 			break;
 		default:
 			printLn(commandsTxT);
-			list(nSensorsC,sensorCommands);
+			list(nSettingsC,settingsCommands);
 			break;
 	}
 }
 
-//Displays info from input setting to screen
-void SerialInterface::getSetting(Settings::Setting sett) {
-		switch (sett) {
-			case Settings::None:
-				break;
-			case Settings::WaterTimed:
-				printName(settingsNames[0]);
-				Serial.println(settings.getWaterTimed());				
-				break;
-			case Settings::WaterHour:
-				printName(settingsNames[1]);
-				Serial.println(settings.getWaterHour());				
-				break;
-			case Settings::WaterMinute:
-				printName(settingsNames[2]);
-				Serial.println(settings.getWaterMinute());				
-				break;
-			case Settings::FloodMinute:
-				printName(settingsNames[3]);
-				Serial.println(settings.getFloodMinute());				
-				break;
-			case Settings::PHalarmUp:
-				printName(settingsNames[4]);
-				Serial.println(settings.getPHalarmUp());				
-				break;
-			case Settings::PHalarmDown:
-				printName(settingsNames[5]);
-				Serial.println(settings.getPHalarmDown());				
-				break;
-			case Settings::ECalarmUp:
-				printName(settingsNames[6]);
-				Serial.println(settings.getECalarmUp());				
-				break;
-			case Settings::ECalarmDown:
-				printName(settingsNames[7]);
-				Serial.println(settings.getECalarmDown());				
-				break;
-			case Settings::WaterAlarm:
-				printName(settingsNames[8]);
-				Serial.println(settings.getWaterAlarm());				
-				break;
-			case Settings::NightWatering:
-				printName(settingsNames[9]);
-				Serial.println(settings.getNightWatering());				
-				break;
-			case Settings::LightThreshold:
-				printName(settingsNames[10]);
-				Serial.println(settings.getLightThreshold());				
-				break;
-			case Settings::MaxWaterLvl:
-				printName(settingsNames[11]);
-				Serial.println(settings.getMaxWaterLvl());				
-				break;
-			case Settings::MinWaterLvl:
-				printName(settingsNames[12]);
-				Serial.println(settings.getMinWaterLvl());				
-				break;
-			case Settings::PumpProtectionLvl:
-				printName(settingsNames[13]);
-				Serial.println(settings.getPumpProtectionLvl());				
-				break;
-			case Settings::PumpProtection:
-				printName(settingsNames[14]);
-				Serial.println(settings.getPumpProtection());
-				break;
-			case Settings::SensorSecond:
-				printName(settingsNames[15]);
-				Serial.println(settings.getSensorSecond());				
-				break;
-			case Settings::SDactive:
-				printName(settingsNames[16]);
-				Serial.println(settings.getSDactive());				
-				break;
-			case Settings::SDhour:
-				printName(settingsNames[17]);
-				Serial.println(settings.getSDhour());				
-				break;
-			case Settings::SDminute:
-				printName(settingsNames[18]);
-				Serial.println(settings.getSDminute());				
-				break;
-			case Settings::Sound:
-				printName(settingsNames[19]);
-				Serial.println(settings.getSound());				
-				break;
-			case Settings::SerialDebug:
-				printName(settingsNames[20]);
-				Serial.println(settings.getSerialDebug());				
-				break;
-			case Settings::ReservoirModule:
-				printName(settingsNames[21]);
-				Serial.println(settings.getReservoirModule());				
-				break;
-			case Settings::NextWhour:
-				printName(settingsNames[22]);
-				Serial.println(settings.getNextWhour());				
-				break;
-			case Settings::NextWminute:
-				printName(settingsNames[23]);
-				Serial.println(settings.getNextWminute());				
-				break;
-			case Settings::NightWateringStopped:
-				printName(settingsNames[24]);
-				Serial.println(settings.getNightWateringStopped());				
-				break;
-			case Settings::WateringPlants:
-				printName(settingsNames[25]);
-				Serial.println(settings.getWateringPlants());				
-				break;
-			case Settings::AlarmTriggered:
-				printName(settingsNames[26]);
-				Serial.println(settings.getAlarmTriggered());				
-				break;
-			case Settings::Led:
-				printName(settingsNames[27]);
-				Serial.println(settings.getLed());				
-				break;
-			case Settings::Celsius:
-				printName(settingsNames[28]);
-				Serial.println(settings.getCelsius());				
-				break;
-		}
+void SerialInterface::listSettings() {
+	printLn(settingsTxt);
+	reply(replySettingNames);
 }
 
-
-//Checks if inputs are valid and convert methods
-boolean SerialInterface::isBoolean(const char* str) {
-	return ((strcmp(str, "true") == 0) || (strcmp(str, "True") == 0) || (strcmp(str, "1") == 0) 
-			|| (strcmp(str, "on") == 0) || (strcmp(str, "On") == 0) || (strcmp(str, "false") == 0) 
-			|| (strcmp(str, "False") == 0) || (strcmp(str, "0") == 0) || (strcmp(str, "off") == 0)
-			|| (strcmp(str, "Off") == 0));
+//Prints "> Name: value unit"
+void SerialInterface::getSetting(uint8_t sett) {
+	printName(SettingsRegistry::name(sett));
+	SettingsRegistry::printValue(serialTx,sett,SettingsRegistry::get(settings,sett));
+	serialTx.println();
 }
 
-boolean SerialInterface::getBoolean(const char* str) {
-	if (str == NULL)
-		return false;
-	else if ((strcmp(str, "true") == 0) || (strcmp(str, "1") == 0) || (strcmp(str, "on") == 0) 
-		|| (strcmp(str, "True") == 0) || (strcmp(str, "On") == 0))
-		return true;
-	else if ((strcmp(str, "false") == 0) || (strcmp(str, "0") == 0) || (strcmp(str, "off") == 0)
-		|| (strcmp(str, "False") == 0) || (strcmp(str, "Off") == 0))
-		return false;
+//Checks arg against setting's type and range, then stores it or stages it if
+//a transaction is open. A failure makes the transaction fail
+void SerialInterface::setSetting(uint8_t sett, const char *arg) {
+	SettingInfo info;
+	SettingsRegistry::info(sett,info);
+	int32_t value;
+	boolean valid = !(info.flags & SettingInfo::readOnly) && SettingsRegistry::parse(sett,arg,value);
+	if (!valid && _transaction.active())
+		_transaction.reject();
+	if (info.flags & SettingInfo::readOnly)
+		printLn(innerTxt);
+	else if (valid && _transaction.active()) {
+		_transaction.stage(sett,value);
+		serialTx.print(pmChar(lineDeco));
+		serialTx.print(pmChar(info.name));
+		serialTx.print(pmChar(txnStagedTxt));
+		SettingsRegistry::printValue(serialTx,sett,value);
+		serialTx.println();
+	} else if (valid && SettingsRegistry::set(settings,sett,value)) {
+		applySetting(info.id);
+		serialTx.print(pmChar(lineDeco));
+		serialTx.print(pmChar(info.name));
+		serialTx.print(pmChar(successTxt));
+		SettingsRegistry::printValue(serialTx,sett,value);
+		serialTx.println();
+	} else {
+		serialTx.print(pmChar(lineDeco));
+		serialTx.print(pmChar(expectedTxt));
+		SettingsRegistry::printRange(serialTx,sett);
+		serialTx.println();
+	}
 }
 
-boolean SerialInterface::isUint8_t(const char* str) {
-	if (str == NULL)
-		return false;
-	//Check if at least first char is a number
-	if (!(isDigit(str[0])))
-		return false;
-	//We use an order of magnitude bigger number to cast and check correctness
-	long num = atol(str);
-	return ((num >= 0) && (num < 256));
+//Prints "> Name: range unit"
+void SerialInterface::helpSetting(uint8_t sett) {
+	printName(SettingsRegistry::name(sett));
+	SettingsRegistry::printRange(serialTx,sett);
+	serialTx.println();
 }
 
-//Doesn't check if input is right... use method above
-uint8_t SerialInterface::getUint8_t(const char* str) {
-	return (uint8_t)atoi(str);
+//Passes settings Sensors keeps its own copy of
+void SerialInterface::applySetting(uint8_t id) {
+	switch (id) {
+		case Settings::MaxWaterLvl:
+			sensors.setMaxLvl(settings.getMaxWaterLvl());
+			break;
+		case Settings::MinWaterLvl:
+			sensors.setMinLvl(settings.getMinWaterLvl());
+			break;
+		case Settings::SerialDebug:
+			sensors.setSerialDebug(settings.getSerialDebug());
+			break;
+		case Settings::ReservoirModule:
+			sensors.setReservoir(settings.getReservoirModule());
+			break;
+		case Settings::Celsius:
+			sensors.setCelsius(settings.getCelsius());
+			break;
+		default:
+			break;
+	}
 }
 
-boolean SerialInterface::isUint16_t(const char* str) {
-	if (str == NULL)
+boolean SerialInterface::replyCommands(uint8_t step) {
+	if (step >= nCommands)
 		return false;
-	if (!(isDigit(str[0])))
-		return false;
-	long num = atol(str);
-	return ((num >= 0) && (num < 65536));
+	printLn((char*)pgm_read_word(&commands[step]));
+	return true;
 }
 
-//Doesn't check if input is right... use method above
-uint16_t SerialInterface::getUint16_t(const char* str) {
-	return (uint16_t)atol(str);
+boolean SerialInterface::replySettingNames(uint8_t step) {
+	if (step >= SettingsRegistry::nSettings)
+		return false;
+	printLn(SettingsRegistry::name(step));
+	return true;
 }
 
-//Strangest way if checking for data.
-boolean SerialInterface::isFloat(const char* str) {
-	if (str == NULL)
+//settings get *
+boolean SerialInterface::replySettings(uint8_t step) {
+	if (step >= SettingsRegistry::nSettings)
 		return false;
-	if (!(isDigit(str[0])))
+	getSetting(step);
+	return true;
+}
+
+//settings help
+boolean SerialInterface::replySettingRanges(uint8_t step) {
+	if (step >= SettingsRegistry::nSettings)
 		return false;
-	float num = atof(str);
-	return ((num >= 0) && (num < 99.99));	
+	helpSetting(step);
+	return true;
 }
 
-//Doesn't check if input is right... use method above
-float SerialInterface::getFloat(const char* str) {
-	return atof(str);
+//Every committed setting with its new value, then how many there were
+boolean SerialInterface::replyCommitted(uint8_t step) {
+	if (step < _transaction.staged())
+		getSetting(_transaction.setting(step));
+	else if (step == _transaction.staged()) {
+		serialTx.print(pmChar(lineDeco));
+		TextFormat::printUInt(serialTx, _transaction.staged());
+		serialTx.println(pmChar(txnCommittedTxt));
+	} else
+		return false;
+	return true;
 }
 
-//Gets info from input, checks validity and modifies data
-void SerialInterface::setSetting(Settings::Setting sett) {
-	char* arg = _cmd.next();
-	switch (sett) {
-		case Settings::None:
-			break;
-			
-		case Settings::WaterTimed:
-			if (isBoolean(arg)) {
-				(getBoolean(arg)) ? settings.setWaterTimed(true) : settings.setWaterTimed(false);
-				printUpdated(settingsNames[0],arg);
-			} else
-				printLn(boolTxt);
-			break;
-			
-		case Settings::WaterHour: 
-			if (isUint8_t(arg)) {
-				if (settings.setWaterHour(getUint8_t(arg)))
-					printUpdated(settingsNames[1],arg);
-				else
-					printLn(hourTxt);
-			} else
-				printLn(hourTxt);
-			break;
-			
-		case Settings::WaterMinute:
-			if (isUint8_t(arg)) {
-				if (settings.setWaterMinute(getUint8_t(arg)))
-					printUpdated(settingsNames[2],arg);
-				else
-					printLn(minSecTxt);
-			} else
-				printLn(minSecTxt);
-			break;
-			
-		case Settings::FloodMinute:
-			if (isUint8_t(arg)) {
-				if (settings.setFloodMinute(getUint8_t(arg)))
-					printUpdated(settingsNames[3],arg);
-				else
-					printLn(minSecTxt);
-			} else
-				printLn(minSecTxt);
-			break;
-			
-		case Settings::PHalarmUp:
-			if (isFloat(arg)) {
-				if (settings.setPHalarmUp(getFloat(arg)))
-					printUpdated(settingsNames[4],arg);
-				else
-					printLn(phTxt);
-			} else
-				printLn(phTxt);
-			break;
-			
-		case Settings::PHalarmDown:
-			if (isFloat(arg)) {
-				if (settings.setPHalarmDown(getFloat(arg)))
-					printUpdated(settingsNames[5],arg);
-				else
-					printLn(phTxt);
-			} else
-				printLn(phTxt);
-			break;
-			
-		case Settings::ECalarmUp:
-			if (isUint16_t(arg)) {
-				if (settings.setECalarmUp(getUint16_t(arg)))
-					printUpdated(settingsNames[6],arg);
-				else
-					printLn(ecTxt);
-			} else
-				printLn(ecTxt);
-			break;
-			
-		case Settings::ECalarmDown:
-			if (isUint16_t(arg)) {
-				if (settings.setECalarmDown(getUint16_t(arg)))
-					printUpdated(settingsNames[7],arg);
-				else
-					printLn(ecTxt);
-			} else
-				printLn(ecTxt);
-			break;
-			
-		case Settings::WaterAlarm:
-			if (isUint8_t(arg)) {
-				if (settings.setWaterAlarm(getUint8_t(arg)))
-					printUpdated(settingsNames[8],arg);
-				else
-					printLn(percentTxT);
-			} else
-				printLn(percentTxT);
-			break;
-			
-		case Settings::NightWatering:
-			if (isBoolean(arg)) {
-				(getBoolean(arg)) ? settings.setNightWatering(true) : settings.setNightWatering(false);
-				printUpdated(settingsNames[9],arg);
-			} else
-				printLn(boolTxt);
-			break;
-			
-		case Settings::LightThreshold:
-			if (isUint8_t(arg)) {
-				if (settings.setLightThreshold(getUint8_t(arg)))
-					printUpdated(settingsNames[10],arg);
-				else
-					printLn(percentTxT);
-			} else
-				printLn(percentTxT);
-			break;
-			
-		case Settings::MaxWaterLvl:
-			if (isUint16_t(arg)) {
-				uint16_t l = getUint16_t(arg);
-				if (settings.setMaxWaterLvl(l)) {
-					sensors.setMaxLvl(l);
-					printUpdated(settingsNames[11],arg);
-				} else
-					printLn(lvlTxt);
-			} else
-				printLn(lvlTxt);
-			break;
-			
-		case Settings::MinWaterLvl:
-			if (isUint16_t(arg)) {
-				uint16_t l = getUint16_t(arg);
-				if (settings.setMinWaterLvl(l)) {
-					sensors.setMinLvl(l);
-					printUpdated(settingsNames[12],arg);
-				} else
-					printLn(lvlTxt);
-			} else
-				printLn(lvlTxt);
-			break;
-			
-		case Settings::PumpProtectionLvl:
-			if (isUint8_t(arg)) {
-				if (settings.setPumpProtectionLvl(getUint8_t(arg)))
-					printUpdated(settingsNames[13],arg);
-				else
-					printLn(percentTxT);
-			} else
-				printLn(percentTxT);
-			break;
-		
-		case Settings::PumpProtection:
-			if (isBoolean(arg)) {
-				(getBoolean(arg)) ? settings.setPumpProtection(true) : settings.setPumpProtection(false);
-				printUpdated(settingsNames[14],arg);
-			} else
-				printLn(boolTxt);
-			break;
-			
-		case Settings::SensorSecond:
-			if (isUint8_t(arg)) {
-				if (settings.setSensorSecond(getUint8_t(arg)))
-					printUpdated(settingsNames[15],arg);
-				else
-					printLn(minSecTxt);
-			} else
-				printLn(minSecTxt);
-			break;
-			
-		case Settings::SDactive:
-			if (isBoolean(arg)) {
-				(getBoolean(arg)) ? settings.setSDactive(true) : settings.setSDactive(false);
-				printUpdated(settingsNames[16],arg);
-			} else
-				printLn(boolTxt);
-			break;
-			
-		case Settings::SDhour:
-			if (isUint8_t(arg)) {
-				if (settings.setSDhour(getUint8_t(arg)))
-					printUpdated(settingsNames[17],arg);
-				else
-					printLn(hourTxt);
-			} else
-				printLn(hourTxt);
-			break;
-			
-		case Settings::SDminute:
-			if (isUint8_t(arg)) {
-				if (settings.setSDminute(getUint8_t(arg)))
-					printUpdated(settingsNames[18],arg);
-				else
-					printLn(minSecTxt);
-			} else
-				printLn(minSecTxt);
-			break;
-			
-		case Settings::Sound:
-			if (isBoolean(arg)) {
-				(getBoolean(arg)) ? settings.setSound(true) : settings.setSound(false);
-				printUpdated(settingsNames[19],arg);
-			} else
-				printLn(boolTxt);
-			break;
-			
-		case Settings::SerialDebug:
-			if (isBoolean(arg)) {
-				(getBoolean(arg)) ? settings.setSerialDebug(true) : settings.setSerialDebug(false);
-				(getBoolean(arg)) ? sensors.setSerialDebug(true) : sensors.setSerialDebug(false);
-				printUpdated(settingsNames[20],arg);
-			} else
-				printLn(boolTxt);
-			break;
+boolean SerialInterface::replySerial(uint8_t step) {
+	if (step == 0)
+		SerialReceiver::print(serialTx);
+	else if (step == 1)
+		serialTx.report(serialTx);
+	else
+		return false;
+	return true;
+}
 
-		case Settings::ReservoirModule:
-			if (isBoolean(arg)) {
-				(getBoolean(arg)) ? settings.setReservoirModule(true) : settings.setReservoirModule(false);
-				(getBoolean(arg)) ? sensors.setReservoir(true) : sensors.setReservoir(false);
-				printUpdated(settingsNames[21],arg);
-			} else
-				printLn(boolTxt);
-			break;
-		
-		case Settings::Led:
-			if (isBoolean(arg)) {
-				(getBoolean(arg)) ? settings.setLed(true) : settings.setLed(false);
-				printUpdated(settingsNames[27],arg);
-			} else
-				printLn(boolTxt);
-			break;
-			
-		case Settings::Celsius:
-			if (isBoolean(arg)) {
-				(getBoolean(arg)) ? settings.setCelsius(true) : settings.setCelsius(false);
-				(getBoolean(arg)) ? sensors.setCelsius(true) : sensors.setCelsius(false);
-				printUpdated(settingsNames[28],arg);
-			} else
-				printLn(boolTxt);
-			break;
-			
-		//These are left blank on purpose. Only main .ino logic should touch these 
-		//as they are internal states not user-selectable settings per se
-		case Settings::NextWhour:
-		case Settings::NextWminute:
-		case Settings::NightWateringStopped:
-		case Settings::WateringPlants:
-		case Settings::AlarmTriggered:
-		default:
-			printLn(innerTxt);
-			break;
-	}
-}
\ No newline at end of file
+#if PROFILING
+//Statistics are reset once they're all printed
+boolean SerialInterface::replyPerf(uint8_t step) {
+	if (step < Profiler::nLines)
+		Profiler::printLine(serialTx,step);
+	else if (step == Profiler::nLines) {
+		Profiler::reset();
+		printLn(perfResetTxt);
+	} else
+		return false;
+	return true;
+}
+#endif
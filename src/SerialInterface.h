@@ -9,6 +9,8 @@
 // # Description: Class in charge of attending communication with input serial commands
 // # Works at 115200. Commands must end with a carriage return to work properly.
 // # You initiate it and then just have to call processSerialCommand() from outside
+// # Output goes through SerialTransmitter. Console messages are sent with LOG_DEBUG(),
+// # LOG_INFO(), LOG_WARNING() or LOG_ERROR(), which aren't built below LOG_LEVEL
 //
 // #  This program is free software: you can redistribute it and/or modify
 //    it under the terms of the GNU General Public License as published by
@@ -33,6 +35,19 @@
 #include <SerialCommand.h>
 #include <Time.h>  
 #include <MemoryFree.h>
+#include "MemoryMonitor.h"
+#include "SDLogger.h"
+#include "RollupLogger.h"
+#include "LogExport.h"
+#include "HistoryQuery.h"
+#include "SettingsRegistry.h"
+#include "SerialReceiver.h"
+#include "SettingsTransaction.h"
+#include "BinaryTelemetry.h"
+#include "SensorWatch.h"
+#include "SerialTransmitter.h"
+#include <TextFormat.h>
+#include "Profiler.h"
 #include <ctype.h>
 
 extern const float versionNumber;
@@ -45,14 +60,36 @@ const char serialOffTxt[] PROGMEM = "Deactivating serial communications.";
 
 const char helpTxt0[] PROGMEM = "> Huertomato version ";
 const char helpTxt1[] PROGMEM = "Type <help name> to find out more about the function <name>.";
-const char memHelpTxt[] PROGMEM = "Displays current system's free memory.";
+const char helpTxt2[] PROGMEM = "Several commands can go in one line separated by ';'.";
+const char memHelpTxt[] PROGMEM = "Displays free memory, stack high-water mark and heap fragmentation.";
 const char statusHelpTxt[] PROGMEM = "Displays system status and sensor info.";
+const char perfHelpTxt[] PROGMEM = "Displays time spent per loop phase and resets it.";
+const char sdHelpTxt[] PROGMEM = "Displays SD card write latency and resets it.";
+const char logsHelpTxt[] PROGMEM = "Sends SD card logs: <logs list>, <logs cat YYYYMMDD>, <logs range YYYYMMDD YYYYMMDD>. <logs stop> stops them or a history query.";
+const char serialHelpTxt[] PROGMEM = "Displays serial input counters: lines received, queued and dropped.";
+const char transactionHelpTxt[] PROGMEM = "Groups settings changes: <begin>, <settings set>s, then <commit> to apply and save them all at once or <abort>. Nothing is applied if any of them failed.";
+const char eepromHelpTxt[] PROGMEM = "Displays settings EEPROM write-back state. <eeprom flush> waits for pending writes first.";
+const char binaryHelpTxt[] PROGMEM = "Binary telemetry frames: <binary status> sends sensors, <binary settings> sends settings, <binary on> turns console messages and alarms into frames, <binary off> back to text.";
+const char watchHelpTxt[] PROGMEM = "Sends the readings that changed after each sensors update, at most once per period: <watch 10s> or <watch 1m Temperature Ph>. Rows are CSV, or frames after <binary on>. <unwatch> stops it.";
+const char logHelpTxt[] PROGMEM = "Console messages: <log> lists each module's lowest level shown, <log water debug> or <log * warning> changes it.";
+const char historyHelpTxt[] PROGMEM = "Sends min/max/mean of a sensor over a past window from SD logs: <history Ec 24h>. Window is <n>m, <n>h or <n>d up to 7d.";
 const char commandsTxT[] PROGMEM = "Available commands are:";
 const char sensorsTxT[] PROGMEM = "Available sensors are:";
 const char settingsTxt[] PROGMEM = "Available settings are:";
 
 const char memoryTxt[] PROGMEM = "> Available memory: ";
 const char memoryTxt1[] PROGMEM = " bytes";
+const char sdWritesTxt[] PROGMEM = "> SD block writes: count min/mean/max p50/p90/p99 us";
+const char sdMaxStepTxt[] PROGMEM = "> Longest step: ";
+const char sdDroppedTxt[] PROGMEM = "> Dropped records: ";
+const char sdRollupsDroppedTxt[] PROGMEM = "> Dropped summaries: ";
+const char sdBufferedTxt[] PROGMEM = "> Buffered: ";
+const char usTxt[] PROGMEM = " us";
+const char eeDirtyTxt[] PROGMEM = "> Dirty: ";
+const char eePendingTxt[] PROGMEM = "> Pending: ";
+const char eeSavesTxt[] PROGMEM = "> Saves/coalesced/records: ";
+const char eeBytesTxt[] PROGMEM = "> Bytes written: ";
+const char eeSlotTxt[] PROGMEM = "> Slot: ";
 const char dateTxt[] PROGMEM = "> Date: ";
 const char timeTxt[] PROGMEM = "> Time: ";
 const char tempTxt[] PROGMEM = "> Temp: ";
@@ -66,14 +103,30 @@ const char ecUnitsTxt[] PROGMEM = "uS";
 const char pihTxt[] PROGMEM = "> pH: ";
 const char levelTxt[] PROGMEM = "> Water level: ";
 
-const char boolTxt[] PROGMEM = "Expected a 'true' or 'false'";
-const char hourTxt[] PROGMEM = "Expected an hour 0 .. 23";
-const char minSecTxt[] PROGMEM = "Expected 0 .. 59";
-const char phTxt[] PROGMEM = "Expected pH 0.00 .. 14.00";
-const char ecTxt[] PROGMEM = "Expected ec 0 .. 9999";
-const char percentTxT[] PROGMEM = "Expected 0 .. 100";
-const char lvlTxt[] PROGMEM = "Expected 0 .. 1024";
+const char expectedTxt[] PROGMEM = "Expected ";
+const char tooLongTxt[] PROGMEM = "> Command too long";
+const char txnBeginTxt[] PROGMEM = "> Transaction open, settings are staged until <commit> or <abort>";
+const char txnOpenTxt[] PROGMEM = "> Transaction already open";
+const char txnNoneTxt[] PROGMEM = "> No transaction open";
+const char txnStagedTxt[] PROGMEM = " staged: ";
+const char txnCommittedTxt[] PROGMEM = " settings committed";
+const char txnRejectedTxt[] PROGMEM = " sets failed, nothing changed";
+const char txnAbortedTxt[] PROGMEM = " staged settings discarded";
+const char binaryOnTxt[] PROGMEM = "> Console messages and alarms sent as binary frames";
+const char binaryOffTxt[] PROGMEM = "> Console messages and alarms sent as text";
 const char innerTxt[] PROGMEM = "Inner var not to be changed";
+const char dayTxt[] PROGMEM = "Expected a day as YYYYMMDD";
+const char noCardTxt[] PROGMEM = "SD card can't be read";
+const char periodTxt[] PROGMEM = "Expected <n>s, <n>m or <n>h up to 24h and optional sensors";
+const char watchStartTxt[] PROGMEM = "> Watch started";
+const char watchStopTxt[] PROGMEM = "> Watch stopped";
+const char watchNoneTxt[] PROGMEM = "> No watch running";
+const char timeColumnTxt[] PROGMEM = "Time";
+const char alarmsColumnTxt[] PROGMEM = ",Alarms";
+const char logLevelTxt[] PROGMEM = "Expected <module> or * and <level>";
+const char modulesTxt[] PROGMEM = "Available modules are:";
+const char levelsTxt[] PROGMEM = "Available levels are:";
+const char windowTxt[] PROGMEM = "Expected <sensor> <n>m, <n>h or <n>d up to 7d";
 
 const char successTxt[] PROGMEM = " successfuly updated to: ";
 const char noHelp[] PROGMEM = "> No help found for command <";
@@ -86,14 +139,40 @@ const char dateSlash[] PROGMEM = "/";
 const char percentTxt[] PROGMEM = "%";
 
 //Command Strings
-const char commandStr0[] PROGMEM = "help";
-const char commandStr1[] PROGMEM = "sensors";
-const char commandStr2[] PROGMEM = "settings";
-const char commandStr3[] PROGMEM = "memory";
-const char commandStr4[] PROGMEM = "status";
-static const int nCommands = 5;
+constexpr char commandStr0[] PROGMEM = "help";
+constexpr char commandStr1[] PROGMEM = "sensors";
+constexpr char commandStr2[] PROGMEM = "settings";
+constexpr char commandStr3[] PROGMEM = "memory";
+constexpr char commandStr4[] PROGMEM = "status";
+constexpr char commandStr5[] PROGMEM = "sd";
+constexpr char commandStr6[] PROGMEM = "logs";
+constexpr char commandStr7[] PROGMEM = "history";
+constexpr char commandStr8[] PROGMEM = "eeprom";
+constexpr char commandStr9[] PROGMEM = "serial";
+constexpr char commandStr10[] PROGMEM = "begin";
+constexpr char commandStr11[] PROGMEM = "commit";
+constexpr char commandStr12[] PROGMEM = "abort";
+constexpr char commandStr13[] PROGMEM = "binary";
+constexpr char commandStr14[] PROGMEM = "watch";
+constexpr char commandStr15[] PROGMEM = "unwatch";
+constexpr char commandStr16[] PROGMEM = "log";
+#if PROFILING
+constexpr char commandStr17[] PROGMEM = "perf";
+static const int nCommands = 18;
 const char* const commands[] PROGMEM = { commandStr0, commandStr1, commandStr2,
-	commandStr3, commandStr4 };
+	commandStr3, commandStr4, commandStr5, commandStr6, commandStr7, commandStr8, commandStr9,
+	commandStr10, commandStr11, commandStr12, commandStr13, commandStr14, commandStr15, commandStr16,
+	commandStr17 };
+#else
+static const int nCommands = 17;
+const char* const commands[] PROGMEM = { commandStr0, commandStr1, commandStr2,
+	commandStr3, commandStr4, commandStr5, commandStr6, commandStr7, commandStr8, commandStr9,
+	commandStr10, commandStr11, commandStr12, commandStr13, commandStr14, commandStr15, commandStr16 };
+#endif
+//Slots of SerialInterface's hashed command table, a power of two, and its seed.
+//Names are constexpr so the table's layout is checked when building
+static const uint8_t commandSlots = 32;
+static const uint8_t commandSeed = 203;
 
 //Sensor commands strings
 const char sensorStr0[] PROGMEM = "list";
@@ -103,8 +182,21 @@ const char* const sensorCommands[] PROGMEM = { sensorStr0, sensorStr1 };
 
 //Settings commands strings
 const char settingsStr2[] PROGMEM = "set";
-static const int nSettingsC = 3;
-const char* const settingsCommands[] PROGMEM = { sensorStr0, sensorStr1, settingsStr2 };
+const char settingsStr3[] PROGMEM = "help";
+static const int nSettingsC = 4;
+const char* const settingsCommands[] PROGMEM = { sensorStr0, sensorStr1, settingsStr2, settingsStr3 };
+//<settings get *>
+const char allSettingsStr[] PROGMEM = "*";
+
+//EEPROM commands strings
+const char eepromStr0[] PROGMEM = "flush";
+
+//Logs commands strings
+const char logsStr1[] PROGMEM = "cat";
+const char logsStr2[] PROGMEM = "range";
+const char logsStr3[] PROGMEM = "stop";
+static const int nLogsC = 4;
+const char* const logsCommands[] PROGMEM = { sensorStr0, logsStr1, logsStr2, logsStr3 };
 
 //Sensor strings
 const char sensorNameStr0[] PROGMEM = "Temperature";
@@ -117,51 +209,15 @@ static const int nSensors = 6;
 const char* const sensorsNames[] PROGMEM = { sensorNameStr0, sensorNameStr1, sensorNameStr2,
 sensorNameStr3, sensorNameStr4, sensorNameStr5 };
 
-//Settings strings
-const char settingsNameStr0[] PROGMEM = "WaterTimed";
-const char settingsNameStr1[] PROGMEM = "WaterHour";
-const char settingsNameStr2[] PROGMEM = "WaterMinute";
-const char settingsNameStr3[] PROGMEM = "FloodMinute";
-const char settingsNameStr4[] PROGMEM = "PHalarmUp";
-const char settingsNameStr5[] PROGMEM = "PHalarmDown";
-const char settingsNameStr6[] PROGMEM = "ECalarmUp";
-const char settingsNameStr7[] PROGMEM = "ECalarmDown";
-const char settingsNameStr8[] PROGMEM = "WaterAlarm";
-const char settingsNameStr9[] PROGMEM = "NightWatering";
-const char settingsNameStr10[] PROGMEM = "LightThreshold";
-const char settingsNameStr11[] PROGMEM = "MaxWaterLvl";
-const char settingsNameStr12[] PROGMEM = "MinWaterLvl";
-const char settingsNameStr13[] PROGMEM = "PumpProtectionLvl";
-const char settingsNameStr14[] PROGMEM = "PumpProtection";
-const char settingsNameStr15[] PROGMEM = "SensorSecond";
-const char settingsNameStr16[] PROGMEM = "SDactive";
-const char settingsNameStr17[] PROGMEM = "SDhour";
-const char settingsNameStr18[] PROGMEM = "SDminute";
-const char settingsNameStr19[] PROGMEM = "Sound";
-const char settingsNameStr20[] PROGMEM = "SerialDebug";
-const char settingsNameStr21[] PROGMEM = "ReservoirModule";
-const char settingsNameStr22[] PROGMEM = "NextWhour";
-const char settingsNameStr23[] PROGMEM = "NextWminute";
-const char settingsNameStr24[] PROGMEM = "NightWateringStopped";
-const char settingsNameStr25[] PROGMEM = "WateringPlants";
-const char settingsNameStr26[] PROGMEM = "AlarmTriggered";
-const char settingsNameStr27[] PROGMEM = "Led";
-const char settingsNameStr28[] PROGMEM = "Celsius";
-
-static const int nSettings = 29;
-const char* const settingsNames[] PROGMEM = { settingsNameStr0, settingsNameStr1, settingsNameStr2,
-	settingsNameStr3, settingsNameStr4, settingsNameStr5, settingsNameStr6, settingsNameStr7,
-	settingsNameStr8, settingsNameStr9, settingsNameStr10, settingsNameStr11, settingsNameStr12,
-	settingsNameStr13, settingsNameStr14, settingsNameStr15, settingsNameStr16, settingsNameStr17,
-	settingsNameStr18, settingsNameStr19, settingsNameStr20, settingsNameStr21, settingsNameStr22,
-	settingsNameStr23, settingsNameStr24, settingsNameStr25, settingsNameStr26, settingsNameStr27,
-	settingsNameStr28 };
-
-//This makes things static so we can use SerialCommand.addCommand("str",function)
+//This makes things static so they can be SerialCommand handlers
 extern Settings settings;
 extern Sensors sensors;
-
-static char charBuffer[64];
+extern SDLogger sdLogger;
+extern RollupLogger rollups;
+extern LogExport logExport;
+extern HistoryQuery history;
+//Fills a sample with current readings. Defined in Huertomato.ino
+void readSample(SensorSample &sample);
 
 class SerialInterface {
 	public:
@@ -169,7 +225,8 @@ class SerialInterface {
 			Invalid = 0,
 			List = 1,
 			Get = 2, 
-			Set = 3
+			Set = 3,
+			Help = 4
 		};
 		SerialInterface();
 		SerialInterface(const SerialInterface &other);
@@ -179,24 +236,65 @@ class SerialInterface {
 		void init();
 		//Ends serial communication
 		void end();
-		//Checks in buffers and calls to handle
+		//Runs oldest command line received, one per call, carries on a long reply and hands
+		//queued output to Serial
 		void processInput();
-		//Writes "HH:MM:SS - <Text>" to serial console if serial debugging is on
-		void timeStamp(const char* txt) const;
+		//Writes "HH:MM:SS - <Text>" to serial console if serial debugging is on and
+		//module's filter lets level through. Use LOG_*() so levels under LOG_LEVEL aren't built.
+		//While logs or history are being sent, warnings and errors wait in TX ring and
+		//the rest are dropped
+		void timeStamp(const char* txt, uint8_t level = LOG_LEVEL_INFO, uint8_t module = LogModule::System) const;
+		//Sends alarm state as a frame if binary telemetry is on. Sensors::alarmState() bits.
+		//Call it when state changes
+		void alarm(uint8_t state) const;
+		//Sends watched readings that changed, as a CSV row or a frame. Call it after each sensors update
+		void watch(const SensorSample &sample) const;
 		
 	private:	
+		//Prints a step of a long reply, a line or two. False once step is past its end
+		typedef boolean (*ReplyStep)(uint8_t step);
+		//A reply step only starts while TX ring has this much room. Steps are a line or
+		//two shorter than that, but for a perf histogram with most of its bins in use
+		static const uint8_t replyRoom = 160;
+
 		//Static to prevent multiple instances and is also required to handle methods
 		static SerialCommand _cmd;
+		//Commands in PROGMEM, each in the slot SerialCommand::hash() gives its name
+		static const SerialCommandEntry _commandTable[commandSlots];
+		//Open between begin and commit or abort
+		static SettingsTransaction _transaction;
+		static BinaryTelemetry _telemetry;
+		//Console messages and alarms go out as frames
+		static boolean _binary;
+		static SensorWatch _watch;
+		//Last alarm state, and whether its frame was dropped
+		static uint8_t _alarmState;
+		static boolean _alarmLost;
+		//Long reply being printed, NULL if none, and its next step
+		static ReplyStep _reply;
+		static uint8_t _replyStep;
 		
+		//Logs and history write Serial directly. TX ring is held while either is busy
+		static void holdForTransfer();
+		//Alarm frame of _alarmState
+		static void sendAlarm();
+		//Starts printing a long reply, a step at a time as TX ring empties
+		static void reply(ReplyStep first);
+		//Prints the reply steps there's room for
+		static void continueReply();
+		//Whether a command's output would have to wait: a reply is still being printed
+		//or TX ring isn't empty
+		static boolean outputBusy();
+		//Whether a command line starts with a PROGMEM command name, with or without arguments
+		static boolean isCommand(const char *line, const char *pmName);
 		//Prints number preceeded by a '0' if < 10
 		static void printDecNum(const uint8_t num);
-		//These are used to read data from PROGMEM and store them into SRAM
-		static char* pmChar(const char* pmArray);
+		//Tags a PROGMEM char* so Serial prints it straight from flash
+		static const __FlashStringHelper* pmChar(const char* pmArray);
 		//Printers
 		static void printLn(const char* ln, boolean leadingBlankLine = false, boolean trailingBlankLine = false);
 		static void list(int length, const char* const names[]);
 		static void printName(const char* ln);
-		static void printUpdated(const char* ln, const char* arg);
 		
 		//Each of these functions are used when certain keywords are found in processInput
 		//They need to be static so handler finds them correctly
@@ -205,33 +303,80 @@ class SerialInterface {
 		static void notFound();
 		//Help command function
 		static void help();
-		//Uses external FreeMemory library
+		//Uses MemoryMonitor telemetry
 		static void commandMemory();
 		//Sends all sensor data through serial
 		static void commandStatus();
+		//Dumps and resets SD writer statistics
+		static void commandSD();
+		//Starts or stops a LogExport transfer
+		static void commandLogs();
+		//Starts a HistoryQuery
+		static void commandHistory();
+		//Displays settings write-back state, flushing it first if asked
+		static void commandEeprom();
+		//Displays SerialReceiver counters
+		static void commandSerial();
+		//Settings transaction
+		static void commandBegin();
+		static void commandCommit();
+		static void commandAbort();
+		//Sends telemetry frames or switches console to them
+		static void commandBinary();
+		//Starts or stops pushing readings that change
+		static void commandWatch();
+		static void commandUnwatch();
+		//Lists or sets console message filters
+		static void commandLog();
+		#if PROFILING
+		//Dumps and resets loop profiling statistics
+		static void commandPerf();
+		#endif
 		//Returns enum contained in input keyword or Invalid/Nobne
 		static Command interpretCommand(char* keyword);
 		static Sensors::Sensor interpretSensor(char* keyword);
-		static Settings::Setting interpretSetting(char* keyword);
 		//Gets called when "sensors" detected
 		static void commandSensors();
 		//Executes get command
 		static void getSensor(Sensors::Sensor sens);
 		//Gets called when "settings" detected
 		static void commandSettings();
-		//Executes get command
-		static void getSetting(Settings::Setting sett);
-		//Checks if inputs are valid and convert methods
-		static boolean isBoolean(const char* str);
-		static boolean getBoolean(const char* str);
-		static boolean isUint8_t(const char* str);
-		static uint8_t getUint8_t(const char* str);
-		static boolean isUint16_t(const char* str);
-		static uint16_t getUint16_t(const char* str);
-		static boolean isFloat(const char* str);
-		static float getFloat(const char* str);
-		//Executes the set commands
-		static void setSetting(Settings::Setting sett);
+		//Settings subcommands, on SettingsRegistry entries
+		static void listSettings();
+		static void getSetting(uint8_t sett);
+		static void setSetting(uint8_t sett, const char *arg);
+		static void helpSetting(uint8_t sett);
+		//Updates what Sensors keeps of a Settings::Setting just set
+		static void applySetting(uint8_t id);
+		//Reply steps of listings that don't fit TX ring at once
+		static boolean replyCommands(uint8_t step);
+		static boolean replySettingNames(uint8_t step);
+		static boolean replySettings(uint8_t step);
+		static boolean replySettingRanges(uint8_t step);
+		static boolean replyCommitted(uint8_t step);
+		static boolean replySerial(uint8_t step);
+		#if PROFILING
+		static boolean replyPerf(uint8_t step);
+		#endif
 };
 
+//Console messages of each level, "HH:MM:SS - <Text>" if their module lets them through.
+//Below LOG_LEVEL they expand to nothing. Module is a LogModule name: LOG_INFO(Water,waterStartTxt)
+#if LOG_LEVEL <= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(module,txt) ui.timeStamp(txt,LOG_LEVEL_DEBUG,LogModule::module)
+#else
+#define LOG_DEBUG(module,txt)
+#endif
+#if LOG_LEVEL <= LOG_LEVEL_INFO
+#define LOG_INFO(module,txt) ui.timeStamp(txt,LOG_LEVEL_INFO,LogModule::module)
+#else
+#define LOG_INFO(module,txt)
+#endif
+#if LOG_LEVEL <= LOG_LEVEL_WARNING
+#define LOG_WARNING(module,txt) ui.timeStamp(txt,LOG_LEVEL_WARNING,LogModule::module)
+#else
+#define LOG_WARNING(module,txt)
+#endif
+#define LOG_ERROR(module,txt) ui.timeStamp(txt,LOG_LEVEL_ERROR,LogModule::module)
+
 #endif
\ No newline at end of file
@@ -0,0 +1,182 @@
+#include "SerialReceiver.h"
+
+char SerialReceiver::_ring[ringSize];
+volatile uint8_t SerialReceiver::_head = 0;
+volatile uint8_t SerialReceiver::_tail = 0;
+uint8_t SerialReceiver::_lineStart = 0;
+boolean SerialReceiver::_dropping = false;
+volatile boolean SerialReceiver::_polling = false;
+volatile uint8_t SerialReceiver::_lines = 0;
+volatile uint16_t SerialReceiver::_received = 0;
+volatile uint16_t SerialReceiver::_fullDrops = 0;
+volatile uint16_t SerialReceiver::_longDrops = 0;
+volatile uint8_t SerialReceiver::_peak = 0;
+
+//Timer0 runs millis() and fires this once per overflow, about every millisecond.
+//Interrupts stay on while it runs so HardwareSerial's own one isn't held up
+ISR(TIMER0_COMPB_vect, ISR_NOBLOCK) {
+	SerialReceiver::poll();
+}
+
+//OCR0B is left as it is: any value matches once per Timer0 cycle.
+//OCR0A can't be used, it sets PWM of pin 13
+void SerialReceiver::begin() {
+	TIMSK0 |= _BV(OCIE0B);
+}
+
+void SerialReceiver::end() {
+	TIMSK0 &= ~_BV(OCIE0B);
+	_head = 0;
+	_tail = 0;
+	_lineStart = 0;
+	_dropping = false;
+	_lines = 0;
+}
+
+boolean SerialReceiver::readLine(char *line) {
+	if (!peekLine(line,0))
+		return false;
+	dropLine(0,strlen(line) + 1);
+	return true;
+}
+
+//Terminator of the line is its last byte in the ring
+boolean SerialReceiver::peekLine(char *line, uint8_t n) {
+	if (n >= _lines)
+		return false;
+	uint8_t i = lineAt(n);
+	char c;
+	do {
+		c = _ring[i];
+		*line++ = c;
+		i++;
+	} while (c != '\0');
+	return true;
+}
+
+//Only bytes between _tail and the line are moved, the interrupt never writes there
+void SerialReceiver::dropLine(uint8_t n, uint8_t count) {
+	uint8_t from = lineAt(n);
+	uint8_t to = from + count;
+	boolean whole = (_ring[(uint8_t)(to - 1)] == '\0');
+	while (from != _tail) {
+		from--;
+		to--;
+		_ring[to] = _ring[from];
+	}
+	_tail += count;
+	if (whole) {
+		uint8_t oldSREG = SREG;
+		cli();
+		_lines--;
+		SREG = oldSREG;
+	}
+}
+
+uint8_t SerialReceiver::queued() {
+	return _lines;
+}
+
+void SerialReceiver::poll() {
+	uint8_t oldSREG = SREG;
+	cli();
+	if (_polling) {
+		SREG = oldSREG;
+		return;
+	}
+	_polling = true;
+	SREG = oldSREG;
+	while (Serial.available() > 0)
+		store(Serial.read());
+	_polling = false;
+}
+
+uint16_t SerialReceiver::getLinesReceived() {
+	return atomicRead(_received);
+}
+
+uint16_t SerialReceiver::getFullDrops() {
+	return atomicRead(_fullDrops);
+}
+
+uint16_t SerialReceiver::getLongDrops() {
+	return atomicRead(_longDrops);
+}
+
+uint8_t SerialReceiver::getPeak() {
+	return _peak;
+}
+
+void SerialReceiver::print(Print &out) {
+	out.print(reinterpret_cast<const __FlashStringHelper*>(rxLinesTxt));
+	TextFormat::printUInt(out, getLinesReceived());
+	out.println();
+	out.print(reinterpret_cast<const __FlashStringHelper*>(rxQueuedTxt));
+	TextFormat::printUInt(out, queued());
+	out.println();
+	out.print(reinterpret_cast<const __FlashStringHelper*>(rxFullTxt));
+	TextFormat::printUInt(out, getFullDrops());
+	out.println();
+	out.print(reinterpret_cast<const __FlashStringHelper*>(rxLongTxt));
+	TextFormat::printUInt(out, getLongDrops());
+	out.println();
+	out.print(reinterpret_cast<const __FlashStringHelper*>(rxPeakTxt));
+	TextFormat::printUInt(out, getPeak());
+	out.println(reinterpret_cast<const __FlashStringHelper*>(rxBytesTxt));
+}
+
+//Empty lines, such as the '\n' of a "\r\n", are skipped
+void SerialReceiver::store(char c) {
+	if ((c == '\r') || (c == '\n')) {
+		if (_dropping) {
+			//Takes back what got in of it
+			_head = _lineStart;
+			_dropping = false;
+		} else if (_head != _lineStart) {
+			//Room for it was kept when last char was stored
+			_ring[_head] = '\0';
+			_head++;
+			_lines++;
+			_received++;
+		}
+		_lineStart = _head;
+		return;
+	}
+	if (_dropping || !isprint(c))
+		return;
+	if ((uint8_t)(_head - _lineStart) >= lineSize - 1) {
+		_longDrops++;
+		_dropping = true;
+		return;
+	}
+	//One byte is always left free so a full ring doesn't look empty,
+	//and one more for the terminator
+	uint8_t used = _head - _tail;
+	if (used + 3 > ringSize) {
+		_fullDrops++;
+		_dropping = true;
+		return;
+	}
+	_ring[_head] = c;
+	_head++;
+	if (used + 1 > _peak)
+		_peak = used + 1;
+}
+
+uint8_t SerialReceiver::lineAt(uint8_t n) {
+	uint8_t i = _tail;
+	while (n > 0) {
+		if (_ring[i] == '\0')
+			n--;
+		i++;
+	}
+	return i;
+}
+
+uint16_t SerialReceiver::atomicRead(volatile uint16_t &counter) {
+	uint8_t oldSREG = SREG;
+	cli();
+	uint16_t value = counter;
+	SREG = oldSREG;
+	return value;
+}
@@ -0,0 +1,101 @@
+// #############################################################################
+//
+// # Name       : SerialReceiver
+//
+// # Description: Assembles serial input into command lines behind the loop's back
+// # HardwareSerial only holds 64 bytes, about 5ms of input at 115200 baud, so
+// # commands arriving while the loop was busy reading EC or writing to SD got lost.
+// # Here a Timer0 compare interrupt moves whatever Serial received into a 256 byte
+// # ring every millisecond, splitting it into lines at '\r' or '\n'. The loop
+// # takes out one complete line at a time with readLine().
+// # Input is only dropped a whole line at a time, when the ring is full or the line
+// # is longer than lineSize, and every dropped line is counted.
+//
+// #  This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// #############################################################################
+
+#ifndef SERIALRECEIVER_H
+#define SERIALRECEIVER_H
+
+#include <Arduino.h>
+#include <avr/interrupt.h>
+#include <SerialCommand.h>
+#include <TextFormat.h>
+
+const char rxLinesTxt[] PROGMEM = "> Lines received: ";
+const char rxQueuedTxt[] PROGMEM = "> Lines queued: ";
+const char rxFullTxt[] PROGMEM = "> Lines dropped, ring full: ";
+const char rxLongTxt[] PROGMEM = "> Lines dropped, too long: ";
+const char rxPeakTxt[] PROGMEM = "> Ring peak use: ";
+const char rxBytesTxt[] PROGMEM = " bytes";
+
+class SerialReceiver {
+	public:
+		//Longest line, terminator included. Room for a few ';' separated commands,
+		//each of them no longer than SerialCommand's buffer
+		static const uint8_t lineSize = 2 * SERIALCOMMANDBUFFER;
+		//Indexes are bytes, so they wrap on their own
+		static const uint16_t ringSize = 256;
+
+		//Starts moving input into the ring. Call it after Serial.begin()
+		static void begin();
+		//Stops it and forgets anything queued
+		static void end();
+		//Copies oldest complete line into line, lineSize bytes long. False if there's none
+		static boolean readLine(char *line);
+		//Same for nth oldest one, 0 being the oldest, but it stays queued
+		static boolean peekLine(char *line, uint8_t n);
+		//Takes first count bytes off nth oldest line, all of it once count reaches
+		//its terminator. Lines before it move up to fill the gap
+		static void dropLine(uint8_t n, uint8_t count);
+		//Complete lines waiting
+		static uint8_t queued();
+		//Moves everything Serial holds into the ring. Called from the interrupt
+		static void poll();
+		static uint16_t getLinesReceived();
+		//Lines dropped because the ring was full
+		static uint16_t getFullDrops();
+		//Lines dropped for being longer than lineSize - 1
+		static uint16_t getLongDrops();
+		//Most ring bytes ever in use
+		static uint8_t getPeak();
+		//Human readable report
+		static void print(Print &out);
+
+	private:
+		static char _ring[ringSize];
+		//Written by interrupt only
+		static volatile uint8_t _head;
+		//Written by dropLine() only
+		static volatile uint8_t _tail;
+		//Start of line being received
+		static uint8_t _lineStart;
+		//Rest of line being received is to be dropped
+		static boolean _dropping;
+		static volatile boolean _polling;
+		static volatile uint8_t _lines;
+		static volatile uint16_t _received;
+		static volatile uint16_t _fullDrops;
+		static volatile uint16_t _longDrops;
+		static volatile uint8_t _peak;
+
+		static void store(char c);
+		//Ring index where nth oldest line starts
+		static uint8_t lineAt(uint8_t n);
+		//Reads a counter the interrupt may be writing
+		static uint16_t atomicRead(volatile uint16_t &counter);
+};
+
+#endif
@@ -0,0 +1,164 @@
+#include "SerialTransmitter.h"
+
+SerialTransmitter::SerialTransmitter() : _head(0), _tail(0), _messageStart(0), _inMessage(false),
+	_droppable(false), _dropping(false), _held(false), _dropped(0), _waits(0), _cut(0), _peak(0) {
+	memset(_level, LOG_LEVEL, sizeof(_level));
+}
+
+SerialTransmitter::SerialTransmitter(const SerialTransmitter &other) {
+	*this = other;
+}
+
+SerialTransmitter& SerialTransmitter::operator=(const SerialTransmitter &other) {
+	memcpy(_ring, other._ring, sizeof(_ring));
+	_head = other._head;
+	_tail = other._tail;
+	_messageStart = other._messageStart;
+	_inMessage = other._inMessage;
+	_droppable = other._droppable;
+	_dropping = other._dropping;
+	_held = other._held;
+	memcpy(_level, other._level, sizeof(_level));
+	_dropped = other._dropped;
+	_waits = other._waits;
+	_cut = other._cut;
+	_peak = other._peak;
+	return *this;
+}
+
+SerialTransmitter::~SerialTransmitter() {}
+
+void SerialTransmitter::beginMessage(uint8_t level) {
+	//Every message tops up Serial, so output keeps flowing while the loop is held up
+	poll();
+	_messageStart = _head;
+	_inMessage = true;
+	_droppable = (level < LOG_LEVEL_WARNING);
+	_dropping = _droppable && _held;
+	if (_dropping)
+		_dropped++;
+}
+
+boolean SerialTransmitter::endMessage() {
+	boolean sent = !_dropping;
+	_inMessage = false;
+	_droppable = false;
+	_dropping = false;
+	return sent;
+}
+
+boolean SerialTransmitter::enabled(uint8_t module, uint8_t level) const {
+	return (module < nModules) && (level >= _level[module]);
+}
+
+void SerialTransmitter::setLevel(uint8_t module, uint8_t level) {
+	if (module < nModules)
+		_level[module] = level;
+}
+
+uint8_t SerialTransmitter::getLevel(uint8_t module) const {
+	return _level[module];
+}
+
+size_t SerialTransmitter::write(uint8_t c) {
+	if (_dropping)
+		return 0;
+	if (full()) {
+		//Whatever is queued before the message can still make room
+		poll();
+		if (full() && _droppable) {
+			_head = _messageStart;
+			_dropping = true;
+			_dropped++;
+			return 0;
+		}
+		//Nothing leaves a held ring
+		if (full() && _held && _inMessage) {
+			_head = _messageStart;
+			_dropping = true;
+			_dropped++;
+			return 0;
+		}
+		//Replies are written as room is left, so they aren't waited for
+		if (full() && !_inMessage) {
+			_cut++;
+			return 0;
+		}
+		if (full()) {
+			_waits++;
+			while (full())
+				poll();
+		}
+	}
+	_ring[_head++] = c;
+	uint8_t used = _head - _tail;
+	if (used > _peak)
+		_peak = used;
+	return 1;
+}
+
+void SerialTransmitter::poll() {
+	if (_held)
+		return;
+	uint8_t end = _droppable ? _messageStart : _head;
+	int room = Serial.availableForWrite();
+	while ((_tail != end) && (room-- > 0))
+		Serial.write((uint8_t)_ring[_tail++]);
+}
+
+void SerialTransmitter::flush() {
+	while (!_held && (_tail != _head))
+		poll();
+}
+
+void SerialTransmitter::hold(boolean held) {
+	_held = held;
+}
+
+boolean SerialTransmitter::held() const {
+	return _held;
+}
+
+uint8_t SerialTransmitter::queued() const {
+	return _head - _tail;
+}
+
+uint8_t SerialTransmitter::room() const {
+	return ringSize - 1 - queued();
+}
+
+uint16_t SerialTransmitter::getDropped() const {
+	return _dropped;
+}
+
+uint16_t SerialTransmitter::getWaits() const {
+	return _waits;
+}
+
+uint16_t SerialTransmitter::getCut() const {
+	return _cut;
+}
+
+uint8_t SerialTransmitter::getPeak() const {
+	return _peak;
+}
+
+void SerialTransmitter::report(Print &out) const {
+	out.print(reinterpret_cast<const __FlashStringHelper*>(txDroppedTxt));
+	TextFormat::printUInt(out, _dropped);
+	out.println();
+	out.print(reinterpret_cast<const __FlashStringHelper*>(txWaitsTxt));
+	TextFormat::printUInt(out, _waits);
+	out.println();
+	out.print(reinterpret_cast<const __FlashStringHelper*>(txCutTxt));
+	TextFormat::printUInt(out, _cut);
+	out.println();
+	out.print(reinterpret_cast<const __FlashStringHelper*>(txPeakTxt));
+	TextFormat::printUInt(out, _peak);
+	out.println(reinterpret_cast<const __FlashStringHelper*>(txBytesTxt));
+}
+
+//One byte is always left free, so head only meets tail when ring is empty
+boolean SerialTransmitter::full() const {
+	return (uint8_t)(_head + 1) == _tail;
+}
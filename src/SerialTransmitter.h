@@ -0,0 +1,154 @@
+// #############################################################################
+//
+// # Name       : SerialTransmitter
+//
+// # Description: Queues console output so printing it doesn't stall the loop
+// # HardwareSerial only holds 64 bytes, so a timestamped message, help or status
+// # kept the loop waiting for the UART at 115200 baud. Output is written into a 256
+// # byte ring instead and handed to Serial by poll() as its buffer empties. It's
+// # drained from the loop, never from interrupts, so code still writing Serial
+// # directly can't interleave with it halfway through a byte.
+// # Console messages have a severity and a module. Each module has a minimum level
+// # to be printed, and levels under LOG_LEVEL aren't built at all. If the ring fills
+// # up while a debug or info message is being written, the whole message is dropped
+// # and counted; warnings and errors wait. Nothing written outside messages, like
+// # command replies, is waited for: long ones are written a step at a time while
+// # there's room, and bytes that still don't fit are cut and counted.
+// # The ring can be held while something else, like a log transfer, writes Serial.
+// # Debug and info messages are then dropped, and warnings and errors are kept until
+// # it's released. Those that don't fit are dropped too, as waiting would never end.
+//
+// #  This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// #############################################################################
+
+#ifndef SERIALTRANSMITTER_H
+#define SERIALTRANSMITTER_H
+
+#include <Arduino.h>
+#include <TextFormat.h>
+
+//Console message severities
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO 1
+#define LOG_LEVEL_WARNING 2
+#define LOG_LEVEL_ERROR 3
+//Messages below it aren't built. Set to LOG_LEVEL_DEBUG (or build with -DLOG_LEVEL=0) to get debug ones
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+//Level names, in level order
+const char levelStr0[] PROGMEM = "debug";
+const char levelStr1[] PROGMEM = "info";
+const char levelStr2[] PROGMEM = "warning";
+const char levelStr3[] PROGMEM = "error";
+static const uint8_t nLevels = 4;
+const char* const levelNames[] PROGMEM = { levelStr0, levelStr1, levelStr2, levelStr3 };
+
+//Console message modules
+struct LogModule {
+	static const uint8_t System = 0;
+	static const uint8_t Sensors = 1;
+	static const uint8_t Water = 2;
+	static const uint8_t Alarms = 3;
+	static const uint8_t SDCard = 4;
+	static const uint8_t Console = 5;
+};
+
+//Module names, in module order
+const char moduleStr0[] PROGMEM = "system";
+const char moduleStr1[] PROGMEM = "sensors";
+const char moduleStr2[] PROGMEM = "water";
+const char moduleStr3[] PROGMEM = "alarms";
+const char moduleStr4[] PROGMEM = "sd";
+const char moduleStr5[] PROGMEM = "serial";
+static const uint8_t nModules = 6;
+const char* const moduleNames[] PROGMEM = { moduleStr0, moduleStr1, moduleStr2, moduleStr3,
+	moduleStr4, moduleStr5 };
+
+const char txDroppedTxt[] PROGMEM = "> Messages dropped, ring full: ";
+const char txWaitsTxt[] PROGMEM = "> Waits for ring room: ";
+const char txCutTxt[] PROGMEM = "> Reply bytes cut, ring full: ";
+const char txPeakTxt[] PROGMEM = "> TX ring peak use: ";
+const char txBytesTxt[] PROGMEM = " bytes";
+
+class SerialTransmitter : public Print {
+	public:
+		//Indexes are bytes, so they wrap on their own
+		static const uint16_t ringSize = 256;
+
+		SerialTransmitter();
+		SerialTransmitter(const SerialTransmitter &other);
+		SerialTransmitter& operator=(const SerialTransmitter &other);
+		~SerialTransmitter();
+
+		//Starts a message of a LOG_LEVEL_* level. Writes up to endMessage() belong to it
+		void beginMessage(uint8_t level);
+		//False if message was dropped
+		boolean endMessage();
+		//Whether a message of module and level passes module's filter
+		boolean enabled(uint8_t module, uint8_t level) const;
+		//Lowest level printed for module
+		void setLevel(uint8_t module, uint8_t level);
+		uint8_t getLevel(uint8_t module) const;
+		//Queues c. Only waits for room if it's part of a warning or error message
+		virtual size_t write(uint8_t c);
+		using Print::write;
+		//Hands Serial as much as its buffer takes without waiting. Call it from loop()
+		void poll();
+		//Waits until everything queued is in Serial's buffer. Needed before writing Serial directly.
+		//Does nothing while held
+		void flush();
+		//Stops or restarts handing output to Serial
+		void hold(boolean held);
+		boolean held() const;
+		//Bytes waiting
+		uint8_t queued() const;
+		//Bytes that can still be queued
+		uint8_t room() const;
+		uint16_t getDropped() const;
+		//Times a write had to wait for room
+		uint16_t getWaits() const;
+		//Bytes written outside messages that found no room
+		uint16_t getCut() const;
+		//Most ring bytes ever in use
+		uint8_t getPeak() const;
+		//Human readable report
+		void report(Print &out) const;
+
+	private:
+		char _ring[ringSize];
+		uint8_t _head;
+		uint8_t _tail;
+		//Start of message being written. poll() doesn't go past it while it can be dropped
+		uint8_t _messageStart;
+		boolean _inMessage;
+		boolean _droppable;
+		//Rest of message is to be dropped
+		boolean _dropping;
+		boolean _held;
+		uint8_t _level[nModules];
+		uint16_t _dropped;
+		uint16_t _waits;
+		uint16_t _cut;
+		uint8_t _peak;
+
+		boolean full() const;
+};
+
+//Defined in Huertomato.ino
+extern SerialTransmitter serialTx;
+
+#endif
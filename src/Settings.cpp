@@ -8,194 +8,116 @@ Settings::Settings() {
 	_alarmTriggered = false;
 	_pumpProtected = false;
   
-	setEEPROMaddresses();
-	readEEPROMvars();
+	//No valid record yet: defaults stay in RAM until upgrade() stores them
+	_loaded = _store.load(_record);
+	if (_loaded == SettingsStore::Empty) {
+		setDefaults();
+		_record.version = 0;
+	}
 }
 
-Settings::Settings(const Settings &other) {
-	setEEPROMaddresses();
-
+Settings::Settings(const Settings &other) : _record(other._record), _store(other._store),
+	_loaded(other._loaded) {
 	_nightWateringStopped = false;
 	_wateringPlants = false;
 	_alarmTriggered = false;
 	_pumpProtected = false;
-	  
-	//System Settings
-	_waterTimed = other._waterTimed;
-	_waterHour = other._waterHour;
-	_waterMinute = other._waterMinute;
-	_floodMinute = other._floodMinute;
-	_phAlarmUp = other._phAlarmUp;
-	_phAlarmDown = other._phAlarmDown;
-	_ecAlarmUp = other._ecAlarmUp;
-	_ecAlarmDown = other._ecAlarmDown;
-	_waterAlarm = other._waterAlarm;
-	_nightWatering = other._nightWatering;
-	_lightThreshold = other._lightThreshold;
-	_maxWaterLvl = other._maxWaterLvl;
-	_minWaterLvl= other._minWaterLvl;
-	_pumpProtection = other._pumpProtection;
-	_pumpProtectionLvl = other._pumpProtectionLvl;
-	  
-	//Controller Settings
-	_sensorSecond = other._sensorSecond;
-	_sdActive = other._sdActive;
-	_sdHour = other._sdHour;
-	_sdMinute = other._sdMinute;
-	_sound = other._sound;
-	_led = other._led;
-	_celsius = other._celsius;
-	_serialDebug = other._serialDebug;
-	_reservoirModule = other._reservoirModule;
 }
 
 Settings& Settings::operator=(const Settings &other) {
-	setEEPROMaddresses();
-	
+	_record = other._record;
+	_store = other._store;
+	_loaded = other._loaded;
+
 	_nightWateringStopped = false;
 	_wateringPlants = false;
 	_alarmTriggered = false;
 	_pumpProtected = false;
-		  
-	//System Settings
-	_waterTimed = other._waterTimed;
-	_waterHour = other._waterHour;
-	_waterMinute = other._waterMinute;
-	_floodMinute = other._floodMinute;
-	_phAlarmUp = other._phAlarmUp;
-	_phAlarmDown = other._phAlarmDown;
-	_ecAlarmUp = other._ecAlarmUp;
-	_ecAlarmDown = other._ecAlarmDown;
-	_waterAlarm = other._waterAlarm;
-	_nightWatering = other._nightWatering;
-	_lightThreshold = other._lightThreshold;
-	_maxWaterLvl = other._maxWaterLvl;
-	_minWaterLvl= other._minWaterLvl;
-	_pumpProtection = other._pumpProtection;
-	_pumpProtectionLvl = other._pumpProtectionLvl;
-		  
-	//Controller Settings
-	_sensorSecond = other._sensorSecond;
-	_sdActive = other._sdActive;
-	_sdHour = other._sdHour;
-	_sdMinute = other._sdMinute;
-	_sound = other._sound;
-	_led = other._led;
-	_celsius = other._celsius;
-	_serialDebug = other._serialDebug;
-	_reservoirModule = other._reservoirModule;
 	
 	return *this;
 }
 
 //Destructor
 Settings::~Settings() {}
-	
-//Sets EEPROM addresses for all variables
-void Settings::setEEPROMaddresses() {
-	_addressWaterTimed = EEPROM.getAddress(sizeof(byte));
-	_addressWaterHour = EEPROM.getAddress(sizeof(byte));
-	_addressWaterMinute = EEPROM.getAddress(sizeof(byte));
-	_addressFloodMinute = EEPROM.getAddress(sizeof(byte));
-	_addressPHalarmUp = EEPROM.getAddress(sizeof(float));
-	_addressPHalarmDown = EEPROM.getAddress(sizeof(float));
-	_addressECalarmUp = EEPROM.getAddress(sizeof(float));
-	_adressECalarmDown = EEPROM.getAddress(sizeof(float));
-	_addressWaterAlarm = EEPROM.getAddress(sizeof(byte));
-	_addressNightWatering = EEPROM.getAddress(sizeof(byte));
-	_addressSensorSecond = EEPROM.getAddress(sizeof(byte));
-	_addressSDactive = EEPROM.getAddress(sizeof(byte));
-	_addressSDhour = EEPROM.getAddress(sizeof(byte));
-	_addressSDminute = EEPROM.getAddress(sizeof(byte));
-	_addressSound = EEPROM.getAddress(sizeof(byte));
-	_addressLed = EEPROM.getAddress(sizeof(byte));
-	_addressCelsius = EEPROM.getAddress(sizeof(byte));
-	_addressSerialDebug = EEPROM.getAddress(sizeof(byte));
-	_addressLightThreshold = EEPROM.getAddress(sizeof(int));
-	_addressReservoirModule = EEPROM.getAddress(sizeof(byte));
-	_addressMaxWaterLvl = EEPROM.getAddress(sizeof(int));
-	_addressMinWaterLvl = EEPROM.getAddress(sizeof(int));
-	_addressPumpProtection = EEPROM.getAddress(sizeof(byte));
-	_addressPumpProtectionLvl = EEPROM.getAddress(sizeof(byte));
-	_addressVersion = EEPROM.getAddress(sizeof(float));	
-}
-
-//Reads settings from EEPROM non-volatile memory and loads vars
-void Settings::readEEPROMvars() {
-	_waterTimed = EEPROM.readByte(_addressWaterTimed);
-	_waterHour = EEPROM.readByte(_addressWaterHour);
-	_waterMinute = EEPROM.readByte(_addressWaterMinute);
-	_floodMinute = EEPROM.readByte(_addressFloodMinute);
-	_phAlarmUp = EEPROM.readFloat(_addressPHalarmUp);
-	_phAlarmDown = EEPROM.readFloat(_addressPHalarmDown);
-	_ecAlarmUp = EEPROM.readFloat(_addressECalarmUp);
-	_ecAlarmDown = EEPROM.readFloat(_adressECalarmDown);
-	_waterAlarm = EEPROM.readByte(_addressWaterAlarm);
-	_nightWatering = EEPROM.readByte(_addressNightWatering);
-	_sensorSecond = EEPROM.readByte(_addressSensorSecond);
-	_sdActive = EEPROM.readByte(_addressSDactive);
-	_sdHour = EEPROM.readByte(_addressSDhour);
-	_sdMinute = EEPROM.readByte(_addressSDminute);
-	_sound = EEPROM.readByte(_addressSound);
-	_led = EEPROM.readByte(_addressLed);
-	_celsius = EEPROM.readByte(_addressCelsius);
-	_serialDebug = EEPROM.readByte(_addressSerialDebug);
-	_lightThreshold = EEPROM.readInt(_addressLightThreshold);
-	_reservoirModule = EEPROM.readByte(_addressReservoirModule);
-	_maxWaterLvl = EEPROM.readInt(_addressMaxWaterLvl);
-	_minWaterLvl = EEPROM.readInt(_addressMinWaterLvl);
-	_pumpProtection = EEPROM.readByte(_addressPumpProtection);
-	_pumpProtectionLvl = EEPROM.readByte(_addressPumpProtectionLvl);
-	_version = EEPROM.readFloat(_addressVersion);
-}
 
 //Resets EEPROM data to defaults
 void Settings::loadDefaults() {	
+	setDefaults();
+	//Saves current version number to EEPROM
+	_record.version = versionNumber;
+	save();
+}
+
+SettingsStore::Result Settings::upgrade() {
+	if (_loaded == SettingsStore::Empty)
+		loadDefaults();
+	else if ((_loaded == SettingsStore::Migrated) || (_record.version != versionNumber)) {
+		_record.version = versionNumber;
+		save();
+	}
+	return _loaded;
+}
+
+void Settings::setDefaults() {
 	//System Settings
-	EEPROM.updateByte(_addressWaterTimed,1);
-	EEPROM.updateByte(_addressWaterHour,1);	
-	EEPROM.updateByte(_addressWaterMinute,30);
-	EEPROM.updateByte(_addressFloodMinute,1);
-	EEPROM.updateFloat(_addressPHalarmUp,14.0);
-	EEPROM.updateFloat(_addressPHalarmDown,0.0);
-	EEPROM.updateFloat(_addressECalarmUp,99.0);
-	EEPROM.updateFloat(_adressECalarmDown,0.0);
-	EEPROM.updateByte(_addressWaterAlarm,0);
-	EEPROM.updateByte(_addressNightWatering,1);  
+	_record.waterTimed = 1;
+	_record.waterHour = 1;
+	_record.waterMinute = 30;
+	_record.floodMinute = 1;
+	_record.phAlarmUp = 14.0;
+	_record.phAlarmDown = 0.0;
+	_record.ecAlarmUp = 99.0;
+	_record.ecAlarmDown = 0.0;
+	_record.waterAlarm = 0;
+	_record.nightWatering = 1;
+	_record.lightThreshold = 30;
+	_record.maxWaterLvl = 16;
+	_record.minWaterLvl = 50;
+	_record.pumpProtection = 0;
+	_record.pumpProtectionLvl = 15;
 	//Controller Settings
-	EEPROM.updateByte(_addressSensorSecond,10);
-	EEPROM.updateByte(_addressSDactive,1);
-	EEPROM.updateByte(_addressSDhour,1);
-	EEPROM.updateByte(_addressSDminute,0);
-	EEPROM.updateByte(_addressSound,1);
-	EEPROM.updateByte(_addressLed,1);
-	EEPROM.updateByte(_addressCelsius,1);
-	EEPROM.updateByte(_addressSerialDebug,1);
-	EEPROM.updateInt(_addressLightThreshold,30);
-	EEPROM.updateByte(_addressReservoirModule,1);
-	EEPROM.updateInt(_addressMaxWaterLvl,16);
-	EEPROM.updateInt(_addressMinWaterLvl,50);
-	EEPROM.updateByte(_addressPumpProtection,0);
-	EEPROM.updateByte(_addressPumpProtectionLvl,15);
-	//Saves current version number to EEPROM
-	EEPROM.updateFloat(_addressVersion,versionNumber);
-	readEEPROMvars();
+	_record.sensorSecond = 10;
+	_record.sdActive = 1;
+	_record.sdHour = 1;
+	_record.sdMinute = 0;
+	_record.sound = 1;
+	_record.led = 1;
+	_record.celsius = 1;
+	_record.serialDebug = 1;
+	_record.reservoirModule = 1;
+}
+
+//Queues whole record for next slot of EEPROM ring
+void Settings::save() {
+	_store.save(_record);
+}
+
+void Settings::process() {
+	_store.process();
+}
+
+void Settings::flush() {
+	_store.flush();
+}
+
+const SettingsStore& Settings::getStore() const {
+	return _store;
 }
 
 //Setters - These store their value on EEPROM too
 //System Settings
 //Also sets _waterModeChanged to true
 boolean Settings::setWaterTimed(const boolean w) { 
-	_waterTimed = w; 
-	EEPROM.updateByte(_addressWaterTimed,w);
+	_record.waterTimed = w; 
+	save();
 	_waterSettingsChanged = true;
 	return true;
 }
 
 boolean Settings::setWaterHour(const uint8_t w) { 
 	if ((w >= 0) & (w < 24)) {
-		_waterHour = w; 
-		EEPROM.updateByte(_addressWaterHour,w);	
+		_record.waterHour = w; 
+		save();	
 		_waterSettingsChanged = true;
 		return true;
 	} else
@@ -204,8 +126,8 @@ boolean Settings::setWaterHour(const uint8_t w) {
 
 boolean Settings::setWaterMinute(const uint8_t w) { 
 	if ((w >= 0) & (w < 60)) {
-		_waterMinute = w; 
-		EEPROM.updateByte(_addressWaterMinute,w);
+		_record.waterMinute = w; 
+		save();
 		_waterSettingsChanged = true;
 		return true;
 	} else
@@ -214,8 +136,8 @@ boolean Settings::setWaterMinute(const uint8_t w) {
 
 boolean Settings::setFloodMinute(const uint8_t f) { 
 	if ((f >= 0) & (f < 60)) {
-		_floodMinute = f; 
-		EEPROM.updateByte(_addressFloodMinute,f);
+		_record.floodMinute = f; 
+		save();
 		_waterSettingsChanged = true;
 		return true;
 	} else
@@ -224,8 +146,8 @@ boolean Settings::setFloodMinute(const uint8_t f) {
 
 boolean Settings::setPHalarmUp(const float p) { 
 	if ((p >= 0) && (p <= 14.00)) {
-		_phAlarmUp = p; 
-		EEPROM.updateFloat(_addressPHalarmUp,p);
+		_record.phAlarmUp = p; 
+		save();
 		return true;
 	} else
 		return false;
@@ -233,8 +155,8 @@ boolean Settings::setPHalarmUp(const float p) {
 
 boolean Settings::setPHalarmDown(const float p) { 
 	if ((p >= 0) && (p <= 14.00)) {
-		_phAlarmDown = p; 
-		EEPROM.updateFloat(_addressPHalarmDown,p);
+		_record.phAlarmDown = p; 
+		save();
 		return true;
 	} else
 		return false;
@@ -242,8 +164,8 @@ boolean Settings::setPHalarmDown(const float p) {
 
 boolean Settings::setECalarmUp(const float e) { 
 	if ((e >= 0.0) && (e <= 99.0)) {
-		_ecAlarmUp = e; 
-		EEPROM.updateFloat(_addressECalarmUp,e);
+		_record.ecAlarmUp = e; 
+		save();
 		return true;
 	} else
 		return false;
@@ -251,8 +173,8 @@ boolean Settings::setECalarmUp(const float e) {
 
 boolean Settings::setECalarmDown(const float e) { 
 	if ((e >= 0.0) && (e <= 99.0)) {
-		_ecAlarmDown = e;
-		EEPROM.updateFloat(_adressECalarmDown,e);
+		_record.ecAlarmDown = e;
+		save();
 		return true;
 	} else
 		return false;
@@ -260,23 +182,23 @@ boolean Settings::setECalarmDown(const float e) {
 
 boolean Settings::setWaterAlarm(const uint8_t w) { 
 	if ((w >= 0) && (w < 101)) {
-		_waterAlarm = w; 
-		EEPROM.updateByte(_addressWaterAlarm,w);
+		_record.waterAlarm = w; 
+		save();
 		return true;
 	} else
 		return false;
 }
 
 boolean Settings::setNightWatering(const boolean n) { 
-	_nightWatering = n; 
-	EEPROM.updateByte(_addressNightWatering,n);
+	_record.nightWatering = n; 
+	save();
 	return true;
 }
 
 boolean Settings::setLightThreshold(const uint16_t l) {
 	if ((l >= 0) && (l < 9999)) {
-		_lightThreshold = l;
-		EEPROM.updateInt(_addressLightThreshold,l);
+		_record.lightThreshold = l;
+		save();
 		return true;
 	} else
 		return false;
@@ -285,8 +207,8 @@ boolean Settings::setLightThreshold(const uint16_t l) {
 boolean Settings::setMaxWaterLvl(const uint16_t x) {
 	//Not valid if greater than 3m!
 	if ((x >= 0) && (x <= 300)) {
-		_maxWaterLvl = x;
-		EEPROM.updateInt(_addressMaxWaterLvl,x);
+		_record.maxWaterLvl = x;
+		save();
 		return true;
 	} else
 		return false;
@@ -295,23 +217,23 @@ boolean Settings::setMaxWaterLvl(const uint16_t x) {
 boolean Settings::setMinWaterLvl(const uint16_t n) {
 	//Not valid if greater than 3m!
 	if ((n >= 0) && (n <= 300)) {
-		_minWaterLvl = n;
-		EEPROM.updateInt(_addressMinWaterLvl,n);
+		_record.minWaterLvl = n;
+		save();
 		return true;
 	} else
 		return false;
 }
 
 boolean Settings::setPumpProtection(const boolean p) {
-	_pumpProtection = p;
-	EEPROM.updateByte(_addressPumpProtection,p);
+	_record.pumpProtection = p;
+	save();
 	return true;
 }
 
 boolean Settings::setPumpProtectionLvl(const uint8_t p) {
 	if ((p >= 0) && (p <= 100)) {
-		_pumpProtectionLvl = p;
-		EEPROM.updateByte(_addressPumpProtectionLvl,p);
+		_record.pumpProtectionLvl = p;
+		save();
 		return true;
 	} else
 		return false;
@@ -320,8 +242,8 @@ boolean Settings::setPumpProtectionLvl(const uint8_t p) {
 //Controller Settings
 boolean Settings::setSensorSecond(const uint8_t s) { 
 	if ((s >= 0) & (s < 60)) {
-		_sensorSecond = s; 
-		EEPROM.updateByte(_addressSensorSecond,s);
+		_record.sensorSecond = s; 
+		save();
 		_sensorPollingChanged = true;
 		return true;
 	} else
@@ -329,16 +251,16 @@ boolean Settings::setSensorSecond(const uint8_t s) {
 }
 
 boolean Settings::setSDactive(const boolean s) { 
-	_sdActive = s; 
-	EEPROM.updateByte(_addressSDactive,s);
+	_record.sdActive = s; 
+	save();
 	_sdSettingsChanged = true;
 	return true;
 }
 
 boolean Settings::setSDhour(const uint8_t s) { 
 	if ((s >= 0) & (s < 24)) {
-		_sdHour = s;
-		EEPROM.updateByte(_addressSDhour,s);
+		_record.sdHour = s;
+		save();
 		_sdSettingsChanged = true;
 		return true;
 	} else
@@ -347,8 +269,8 @@ boolean Settings::setSDhour(const uint8_t s) {
 
 boolean Settings::setSDminute(const uint8_t s) { 
 	if ((s >= 0) & (s < 60)) {
-		_sdMinute = s;
-		EEPROM.updateByte(_addressSDminute,s);
+		_record.sdMinute = s;
+		save();
 		_sdSettingsChanged = true;
 		return true;
 	} else
@@ -356,33 +278,33 @@ boolean Settings::setSDminute(const uint8_t s) {
 }
 
 boolean Settings::setSound(const boolean s) { 
-	_sound = s; 
-	EEPROM.updateByte(_addressSound,s);
+	_record.sound = s; 
+	save();
 	return true;
 }
 
 boolean Settings::setLed(const boolean l) {
-	_led = l;
-	EEPROM.updateByte(_addressLed,l);
+	_record.led = l;
+	save();
 	return true;
 }
 
 boolean Settings::setCelsius(const boolean c) {
-	_celsius = c;
-	EEPROM.updateByte(_addressCelsius,c);
+	_record.celsius = c;
+	save();
 	return true;
 }
 
 boolean Settings::setSerialDebug(const boolean s) { 
-	_serialDebug = s; 
-	EEPROM.updateByte(_addressSerialDebug,s);
+	_record.serialDebug = s; 
+	save();
 	_serialDebugChanged = true;
 	return true;
 }
 
 boolean Settings::setReservoirModule(const boolean r) {
-	_reservoirModule = r;
-	EEPROM.updateByte(_addressReservoirModule,r);
+	_record.reservoirModule = r;
+	save();
 	_moduleChanged = true;
 	return true;
 }
@@ -416,54 +338,54 @@ void Settings::setPumpProtected(const boolean p) {
 
 //Getters
 //System Settings
-boolean Settings::getWaterTimed() const { return _waterTimed; }
+boolean Settings::getWaterTimed() const { return _record.waterTimed; }
 
-uint8_t Settings::getWaterHour() const { return _waterHour; }
+uint8_t Settings::getWaterHour() const { return _record.waterHour; }
 
-uint8_t Settings::getWaterMinute() const { return _waterMinute; }
+uint8_t Settings::getWaterMinute() const { return _record.waterMinute; }
 
-uint8_t Settings::getFloodMinute() const { return _floodMinute; }
+uint8_t Settings::getFloodMinute() const { return _record.floodMinute; }
 
-float Settings::getPHalarmUp() const { return _phAlarmUp; }
+float Settings::getPHalarmUp() const { return _record.phAlarmUp; }
 
-float Settings::getPHalarmDown() const { return _phAlarmDown; }
+float Settings::getPHalarmDown() const { return _record.phAlarmDown; }
 
-float Settings::getECalarmUp() const { return _ecAlarmUp; }
+float Settings::getECalarmUp() const { return _record.ecAlarmUp; }
 
-float Settings::getECalarmDown() const { return _ecAlarmDown; }
+float Settings::getECalarmDown() const { return _record.ecAlarmDown; }
 
-uint8_t Settings::getWaterAlarm() const { return _waterAlarm; }
+uint8_t Settings::getWaterAlarm() const { return _record.waterAlarm; }
 
-boolean Settings::getNightWatering() const { return _nightWatering; }
+boolean Settings::getNightWatering() const { return _record.nightWatering; }
 
-uint16_t Settings::getLightThreshold() const { return _lightThreshold; }
+uint16_t Settings::getLightThreshold() const { return _record.lightThreshold; }
 	
-uint16_t Settings::getMaxWaterLvl() const { return _maxWaterLvl; }
+uint16_t Settings::getMaxWaterLvl() const { return _record.maxWaterLvl; }
 	
-uint16_t Settings::getMinWaterLvl() const { return _minWaterLvl; }
+uint16_t Settings::getMinWaterLvl() const { return _record.minWaterLvl; }
 	
-boolean Settings::getPumpProtection() const { return _pumpProtection; }
+boolean Settings::getPumpProtection() const { return _record.pumpProtection; }
 
-uint8_t Settings::getPumpProtectionLvl() const { return _pumpProtectionLvl; }
+uint8_t Settings::getPumpProtectionLvl() const { return _record.pumpProtectionLvl; }
 
 //Controller Settings
-uint8_t Settings::getSensorSecond() const { return _sensorSecond; }
+uint8_t Settings::getSensorSecond() const { return _record.sensorSecond; }
 
-boolean Settings::getSDactive() const { return _sdActive; }
+boolean Settings::getSDactive() const { return _record.sdActive; }
 
-uint8_t Settings::getSDhour() const { return _sdHour; }
+uint8_t Settings::getSDhour() const { return _record.sdHour; }
 
-uint8_t Settings::getSDminute() const { return _sdMinute; }
+uint8_t Settings::getSDminute() const { return _record.sdMinute; }
 
-boolean Settings::getSound() const { return _sound; }
+boolean Settings::getSound() const { return _record.sound; }
 	
-boolean Settings::getLed() const { return _led; }
+boolean Settings::getLed() const { return _record.led; }
 	
-boolean Settings::getCelsius() const { return _celsius; }
+boolean Settings::getCelsius() const { return _record.celsius; }
 
-boolean Settings::getSerialDebug() const { return _serialDebug; }
+boolean Settings::getSerialDebug() const { return _record.serialDebug; }
 	
-boolean Settings::getReservoirModule() const { return _reservoirModule; }
+boolean Settings::getReservoirModule() const { return _record.reservoirModule; }
 
 //Status vars
 uint8_t Settings::getNextWhour() const { return _nextWhour; }
@@ -478,7 +400,7 @@ boolean Settings::getAlarmTriggered() const { return _alarmTriggered; }
 	
 boolean Settings::getPumpProtected() const { return _pumpProtected; }
 	
-float Settings::getVersion() const { return _version; }
+float Settings::getVersion() const { return _record.version; }
 		
 boolean Settings::systemStateChanged() {
 	boolean res = _systemStateChanged;
@@ -530,110 +452,3 @@ void Settings::setRTCtime(uint8_t h, uint8_t m, uint8_t s, uint8_t d, uint8_t mo
 	setTime(time);
 	RTC.set(time);
 }
-
-/*
-void Settings::debugEEPROM() {
-	Serial.print("_addressWaterTimed: ");
-	Serial.print(_addressWaterTimed);
-	Serial.print(" | ");
-	Serial.println(_waterTimed);
-	Serial.print("_addressWaterHour: ");
-	Serial.print(_addressWaterHour);
-	Serial.print(" | ");
-	Serial.println(_waterHour);
-	Serial.print("_addressWaterMinute: ");
-	Serial.print(_addressWaterMinute);
-	Serial.print(" | ");
-	Serial.println(_waterMinute);
-	Serial.print("_addressFloodMinute: ");
-	Serial.print(_addressFloodMinute);
-	Serial.print(" | ");
-	Serial.println(_floodMinute);
-	Serial.print("_addressPHalarmUp: ");
-	Serial.print(_addressPHalarmUp);
-	Serial.print(" | ");
-	Serial.println(_phAlarmUp);
-	Serial.print("_addressPHalarmDown: ");
-	Serial.print(_addressPHalarmDown);
-	Serial.print(" | ");
-	Serial.println(_phAlarmDown);
-	Serial.print("_addressECalarmUp: ");
-	Serial.print(_addressECalarmUp);
-	Serial.print(" | ");
-	Serial.println(_ecAlarmUp);
-	Serial.print("_adressECalarmDown: ");
-	Serial.print(_adressECalarmDown);
-	Serial.print(" | ");
-	Serial.println(_ecAlarmDown);
-	Serial.print("_addressWaterAlarm: ");
-	Serial.print(_addressWaterAlarm);
-	Serial.print(" | ");
-	Serial.println(_waterAlarm);
-	Serial.print("_addressNightWatering: ");
-	Serial.print(_addressNightWatering);
-	Serial.print(" | ");
-	Serial.println(_nightWatering);
-	Serial.print("_addressSensorSecond: ");
-	Serial.print(_addressSensorSecond);
-	Serial.print(" | ");
-	Serial.println(_sensorSecond);
-	Serial.print("_addressSDactive: ");
-	Serial.print(_addressSDactive);
-	Serial.print(" | ");
-	Serial.println(_sdActive);
-	Serial.print("_addressSDhour: ");
-	Serial.print(_addressSDhour);
-	Serial.print(" | ");
-	Serial.println(_sdHour);
-	Serial.print("_addressSDminute: ");
-	Serial.print(_addressSDminute);
-	Serial.print(" | ");
-	Serial.println(_sdMinute);
-	Serial.print("_addressSound: ");
-	Serial.print(_addressSound);
-	Serial.print(" | ");
-	Serial.println(_sound);
-	Serial.print("_addressLed: ");
-	Serial.print(_addressLed);
-	Serial.print(" | ");
-	Serial.println(_led);
-	Serial.print("_addressCelsius: ");
-	Serial.print(_addressCelsius);
-	Serial.print(" | ");
-	Serial.println(_celsius);
-	Serial.print("_addressSerialDebug: ");
-	Serial.print(_addressSerialDebug);
-	Serial.print(" | ");
-	Serial.println(_serialDebug);
-	Serial.print("_addressLightThreshold: ");
-	Serial.print(_addressLightThreshold);
-	Serial.print(" | ");
-	Serial.println(_lightThreshold);
-	Serial.print("_addressReservoirModule: ");
-	Serial.print(_addressReservoirModule);
-	Serial.print(" | ");
-	Serial.println(_reservoirModule);
-	Serial.print("_addressMaxWaterLvl: ");
-	Serial.print(_addressMaxWaterLvl);
-	Serial.print(" | ");
-	Serial.println(_maxWaterLvl);
-	Serial.print("_addressMinWaterLvl: ");
-	Serial.print(_addressMinWaterLvl);
-	Serial.print(" | ");
-	Serial.println(_minWaterLvl);
-	Serial.print("_addressPumpProtection: ");
-	Serial.print(_addressPumpProtection);
-	Serial.print(" | ");
-	Serial.println(_pumpProtection);
-	Serial.print("_addressPumpProtectionLvl: ");
-	Serial.print(_addressPumpProtectionLvl);
-	Serial.print(" | ");
-	Serial.println(_pumpProtectionLvl);
-	Serial.print("_addressVersion: ");
-	Serial.print(_addressVersion);
-	Serial.print(" | ");
-	Serial.print(_version);
-	Serial.print(" | ");
-	Serial. println(versionNumber);
-}
-*/
\ No newline at end of file
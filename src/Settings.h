@@ -1,13 +1,14 @@
 // #############################################################################
 //
 // # Name       : Settings
-// # Version    : 1.7
+// # Version    : 1.8
 //
 // # Author     : Juan L. Perez Diez <ender.vs.melkor at gmail>
 // # Date       : 20.06.2016
 //
 // # Description: Settings class for Huertomato
 // # Stores all the system's current settings. Its in charge of reading and storing in EEPROM 
+// # Persistent ones live in a single SettingsRecord saved through SettingsStore
 //
 // #  This program is free software: you can redistribute it and/or modify
 //    it under the terms of the GNU General Public License as published by
@@ -28,16 +29,17 @@
 #define SETTINGS_H
 
 #include <Arduino.h>
-#include <EEPROMEx.h>
 #include <Time.h>
 #include <DS1307RTC.h>
-
-extern EEPROMClassEx EEPROM;
+#include "SettingsStore.h"
 
 extern const float versionNumber;
 
 // *********************************************
 class Settings {
+  //Reads and writes fields through its table of offsets
+  friend class SettingsRegistry;
+
   public:
 	enum Setting {
 		None,
@@ -82,8 +84,17 @@ class Settings {
 	
 	//Loads defaults to EEPROM and updates object
 	void loadDefaults();
+	//Stores settings read at boot if they came from older firmware, migrated
+	//to the current schema, or defaults if there were none. Returns what was found
+	SettingsStore::Result upgrade();
+	//Starts writing settings changed while EEPROM was busy. Call it once per loop
+	void process();
+	//Waits until every change is in EEPROM
+	void flush();
+	//EEPROM write-back state
+	const SettingsStore& getStore() const;
 	
-    //Setters - These store settings to EEPROM too
+    //Setters - These queue settings to be written to EEPROM too
     //System Settings
     boolean setWaterTimed(const boolean);
     boolean setWaterHour(const uint8_t);
@@ -173,52 +184,16 @@ class Settings {
 	//Needed for it to be called both by GUI and main .ino
 	void setRTCtime(uint8_t, uint8_t, uint8_t, uint8_t, uint8_t, int);
      
-	//void debugEEPROM();
-	  
   private:
-	void setEEPROMaddresses();
-    void readEEPROMvars();
+	//Fills record with default values, without saving it
+	void setDefaults();
+	void save();
 	
-    //System Settings
-    //Watering Cycle
-    boolean _waterTimed;
-    uint8_t _waterHour;
-    uint8_t _waterMinute;
-    uint8_t _floodMinute;
-    //Sensor Alarms
-    float _phAlarmUp;
-    float _phAlarmDown;
-    float _ecAlarmUp;
-    float _ecAlarmDown;
-    uint8_t _waterAlarm;
-    //Water at night - Informs the system that watering timers are stopped for the night
-    boolean _nightWatering;
-	//Sensor Calibrations
-	uint16_t _lightThreshold;
-	uint16_t _maxWaterLvl;
-	uint16_t _minWaterLvl;
-	//Pump protection
-	boolean _pumpProtection;
-	uint8_t _pumpProtectionLvl;
-    
-    //Controller settings
-    //Time & Date - Handled outside in RTC Lib
-    //Sensor Polling
-    uint8_t _sensorSecond;  
-    //SD Card
-    boolean _sdActive;
-    uint8_t _sdHour;
-    uint8_t _sdMinute;
-    //Sound toggle
-    boolean _sound;
-	//Leds toggle
-	boolean _led;
-	//Celsius toggle
-	boolean _celsius;
-    //Serial Debugging
-    boolean _serialDebug;
-	//Module present
-	boolean _reservoirModule;
+    //Settings stored in EEPROM
+    SettingsRecord _record;
+    SettingsStore _store;
+    //What was found in EEPROM at boot
+    SettingsStore::Result _loaded;
     
     //Status variables - Not read from EEPROM
     //Time next watering will happen
@@ -244,36 +219,6 @@ class Settings {
 	boolean _serialDebugChanged;
 	//Module config changed
 	boolean _moduleChanged;
-	//Version number
-	float _version;
-    
-    //EEPROM addresses for all settings
-    int _addressWaterTimed;
-    int _addressWaterHour;
-    int _addressWaterMinute;
-    int _addressFloodMinute;
-    int _addressPHalarmUp;
-    int _addressPHalarmDown;
-    int _addressECalarmUp;
-    int _adressECalarmDown;
-    int _addressWaterAlarm;
-    int _addressNightWatering;  
-    int _addressSensorMinute;
-    int _addressSensorSecond;  
-    int _addressSDactive;
-    int _addressSDhour;
-    int _addressSDminute;
-    int _addressSound;
-	int _addressLed;
-	int _addressCelsius;
-    int _addressSerialDebug;
-	int _addressLightThreshold;
-	int _addressReservoirModule;
-	int _addressMaxWaterLvl;
-	int _addressMinWaterLvl;
-	int _addressPumpProtectionLvl;
-	int _addressPumpProtection;
-	int _addressVersion;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,210 @@
+#include "SettingsRegistry.h"
+
+//Offset of a stored setting and of a status variable inside Settings
+#define STORED(field) (offsetof(Settings, _record) + offsetof(SettingsRecord, field))
+#define STATUS(field) offsetof(Settings, field)
+
+//Sorted by name, as strcmp() orders them
+const SettingInfo SettingsRegistry::_table[nSettings] PROGMEM = {
+	{ settingsNameStr0, Settings::AlarmTriggered, STATUS(_alarmTriggered), SettingInfo::Bool, SettingInfo::readOnly, 0, 1, noUnitStr },
+	{ settingsNameStr1, Settings::Celsius, STORED(celsius), SettingInfo::Bool, SettingInfo::stored, 0, 1, noUnitStr },
+	{ settingsNameStr2, Settings::ECalarmDown, STORED(ecAlarmDown), SettingInfo::Fixed1, SettingInfo::stored, 0, 990, ecUnitStr },
+	{ settingsNameStr3, Settings::ECalarmUp, STORED(ecAlarmUp), SettingInfo::Fixed1, SettingInfo::stored, 0, 990, ecUnitStr },
+	{ settingsNameStr4, Settings::FloodMinute, STORED(floodMinute), SettingInfo::UInt8, SettingInfo::stored | SettingInfo::waterChange, 0, 59, minuteUnitStr },
+	{ settingsNameStr5, Settings::Led, STORED(led), SettingInfo::Bool, SettingInfo::stored, 0, 1, noUnitStr },
+	{ settingsNameStr6, Settings::LightThreshold, STORED(lightThreshold), SettingInfo::UInt16, SettingInfo::stored, 0, 9998, luxUnitStr },
+	{ settingsNameStr7, Settings::MaxWaterLvl, STORED(maxWaterLvl), SettingInfo::UInt16, SettingInfo::stored, 0, 300, cmUnitStr },
+	{ settingsNameStr8, Settings::MinWaterLvl, STORED(minWaterLvl), SettingInfo::UInt16, SettingInfo::stored, 0, 300, cmUnitStr },
+	{ settingsNameStr9, Settings::NextWhour, STATUS(_nextWhour), SettingInfo::UInt8, SettingInfo::readOnly, 0, 23, hourUnitStr },
+	{ settingsNameStr10, Settings::NextWminute, STATUS(_nextWminute), SettingInfo::UInt8, SettingInfo::readOnly, 0, 59, minuteUnitStr },
+	{ settingsNameStr11, Settings::NightWatering, STORED(nightWatering), SettingInfo::Bool, SettingInfo::stored, 0, 1, noUnitStr },
+	{ settingsNameStr12, Settings::NightWateringStopped, STATUS(_nightWateringStopped), SettingInfo::Bool, SettingInfo::readOnly, 0, 1, noUnitStr },
+	{ settingsNameStr13, Settings::PHalarmDown, STORED(phAlarmDown), SettingInfo::Fixed2, SettingInfo::stored, 0, 1400, pHUnitStr },
+	{ settingsNameStr14, Settings::PHalarmUp, STORED(phAlarmUp), SettingInfo::Fixed2, SettingInfo::stored, 0, 1400, pHUnitStr },
+	{ settingsNameStr15, Settings::PumpProtection, STORED(pumpProtection), SettingInfo::Bool, SettingInfo::stored, 0, 1, noUnitStr },
+	{ settingsNameStr16, Settings::PumpProtectionLvl, STORED(pumpProtectionLvl), SettingInfo::UInt8, SettingInfo::stored, 0, 100, percentUnitStr },
+	{ settingsNameStr17, Settings::ReservoirModule, STORED(reservoirModule), SettingInfo::Bool, SettingInfo::stored | SettingInfo::moduleChange, 0, 1, noUnitStr },
+	{ settingsNameStr18, Settings::SDactive, STORED(sdActive), SettingInfo::Bool, SettingInfo::stored | SettingInfo::sdChange, 0, 1, noUnitStr },
+	{ settingsNameStr19, Settings::SDhour, STORED(sdHour), SettingInfo::UInt8, SettingInfo::stored | SettingInfo::sdChange, 0, 23, hourUnitStr },
+	{ settingsNameStr20, Settings::SDminute, STORED(sdMinute), SettingInfo::UInt8, SettingInfo::stored | SettingInfo::sdChange, 0, 59, minuteUnitStr },
+	{ settingsNameStr21, Settings::SensorSecond, STORED(sensorSecond), SettingInfo::UInt8, SettingInfo::stored | SettingInfo::pollingChange, 0, 59, secondUnitStr },
+	{ settingsNameStr22, Settings::SerialDebug, STORED(serialDebug), SettingInfo::Bool, SettingInfo::stored | SettingInfo::serialChange, 0, 1, noUnitStr },
+	{ settingsNameStr23, Settings::Sound, STORED(sound), SettingInfo::Bool, SettingInfo::stored, 0, 1, noUnitStr },
+	{ settingsNameStr24, Settings::WaterAlarm, STORED(waterAlarm), SettingInfo::UInt8, SettingInfo::stored, 0, 100, percentUnitStr },
+	{ settingsNameStr25, Settings::WaterHour, STORED(waterHour), SettingInfo::UInt8, SettingInfo::stored | SettingInfo::waterChange, 0, 23, hourUnitStr },
+	{ settingsNameStr26, Settings::WaterMinute, STORED(waterMinute), SettingInfo::UInt8, SettingInfo::stored | SettingInfo::waterChange, 0, 59, minuteUnitStr },
+	{ settingsNameStr27, Settings::WaterTimed, STORED(waterTimed), SettingInfo::Bool, SettingInfo::stored | SettingInfo::waterChange, 0, 1, noUnitStr },
+	{ settingsNameStr28, Settings::WateringPlants, STATUS(_wateringPlants), SettingInfo::Bool, SettingInfo::readOnly, 0, 1, noUnitStr }
+};
+
+#undef STORED
+#undef STATUS
+
+// *********************************************
+// SettingInfo
+// *********************************************
+uint8_t SettingInfo::decimals() const {
+	if (type == Fixed1)
+		return 1;
+	else if (type == Fixed2)
+		return 2;
+	return 0;
+}
+
+// *********************************************
+// SettingsRegistry
+// *********************************************
+int8_t SettingsRegistry::find(const char *name) {
+	if (name == NULL)
+		return notFound;
+	int8_t low = 0;
+	int8_t high = nSettings - 1;
+	while (low <= high) {
+		int8_t mid = (low + high) / 2;
+		int cmp = strcmp_P(name, SettingsRegistry::name(mid));
+		if (cmp == 0)
+			return mid;
+		else if (cmp < 0)
+			high = mid - 1;
+		else
+			low = mid + 1;
+	}
+	return notFound;
+}
+
+void SettingsRegistry::info(uint8_t i, SettingInfo &info) {
+	memcpy_P(&info, &_table[i], sizeof(SettingInfo));
+}
+
+const char* SettingsRegistry::name(uint8_t i) {
+	return (const char*)pgm_read_word(&_table[i].name);
+}
+
+int32_t SettingsRegistry::get(const Settings &settings, uint8_t i) {
+	SettingInfo entry;
+	info(i, entry);
+	const uint8_t *value = field(settings, entry);
+	switch (entry.type) {
+		case SettingInfo::UInt16:
+			return *(const uint16_t*)value;
+		case SettingInfo::Fixed1:
+		case SettingInfo::Fixed2:
+			return TextFormat::toFixed(*(const float*)value, entry.decimals());
+		default:
+			return *value;
+	}
+}
+
+//Booleans take true/false, on/off or 1/0. Numbers take up to their type's decimals
+boolean SettingsRegistry::parse(uint8_t i, const char *str, int32_t &value) {
+	if ((str == NULL) || (*str == '\0'))
+		return false;
+	SettingInfo entry;
+	info(i, entry);
+	if (entry.type == SettingInfo::Bool) {
+		if ((strcasecmp_P(str, boolTrueStr) == 0) || (strcasecmp_P(str, boolOnStr) == 0) || (strcmp(str, "1") == 0))
+			value = 1;
+		else if ((strcasecmp_P(str, boolFalseStr) == 0) || (strcasecmp_P(str, boolOffStr) == 0) || (strcmp(str, "0") == 0))
+			value = 0;
+		else
+			return false;
+		return true;
+	}
+	uint8_t decimals = entry.decimals();
+	//Decimals read, none until '.'
+	int8_t read = -1;
+	int32_t num = 0;
+	for (; *str != '\0'; str++) {
+		if ((*str == '.') && (read < 0) && (decimals > 0))
+			read = 0;
+		else if (isDigit(*str) && (read < (int8_t)decimals) && (num <= entry.max)) {
+			num = num * 10 + (*str - '0');
+			if (read >= 0)
+				read++;
+		} else
+			return false;
+	}
+	//Missing decimals
+	for (int8_t d = (read < 0) ? 0 : read; d < decimals; d++)
+		num *= 10;
+	if ((num < entry.min) || (num > entry.max))
+		return false;
+	value = num;
+	return true;
+}
+
+boolean SettingsRegistry::set(Settings &settings, uint8_t i, int32_t value, boolean persist) {
+	SettingInfo entry;
+	info(i, entry);
+	if ((entry.flags & SettingInfo::readOnly) || (value < entry.min) || (value > entry.max))
+		return false;
+	uint8_t *field = SettingsRegistry::field(settings, entry);
+	switch (entry.type) {
+		case SettingInfo::UInt16:
+			*(uint16_t*)field = value;
+			break;
+		case SettingInfo::Fixed1:
+		case SettingInfo::Fixed2:
+			*(float*)field = (float)value / scale(entry.decimals());
+			break;
+		default:
+			*field = value;
+			break;
+	}
+	if (entry.flags & SettingInfo::waterChange)
+		settings._waterSettingsChanged = true;
+	if (entry.flags & SettingInfo::sdChange)
+		settings._sdSettingsChanged = true;
+	if (entry.flags & SettingInfo::pollingChange)
+		settings._sensorPollingChanged = true;
+	if (entry.flags & SettingInfo::serialChange)
+		settings._serialDebugChanged = true;
+	if (entry.flags & SettingInfo::moduleChange)
+		settings._moduleChanged = true;
+	if (persist && (entry.flags & SettingInfo::stored))
+		settings.save();
+	return true;
+}
+
+void SettingsRegistry::save(Settings &settings) {
+	settings.save();
+}
+
+void SettingsRegistry::printValue(Print &out, uint8_t i, int32_t value) {
+	SettingInfo entry;
+	info(i, entry);
+	if (entry.type == SettingInfo::Bool) {
+		TextFormat::printP(out, value ? boolTrueStr : boolFalseStr);
+		return;
+	}
+	TextFormat::printFixed(out, value, entry.decimals());
+	if (pgm_read_byte(entry.unit) != '\0') {
+		out.print(' ');
+		TextFormat::printP(out, entry.unit);
+	}
+}
+
+void SettingsRegistry::printRange(Print &out, uint8_t i) {
+	SettingInfo entry;
+	info(i, entry);
+	if (entry.type == SettingInfo::Bool)
+		TextFormat::printP(out, boolTypeStr);
+	else {
+		TextFormat::printFixed(out, entry.min, entry.decimals());
+		TextFormat::printP(out, rangeSeparatorStr);
+		printValue(out, i, entry.max);
+	}
+	if (entry.flags & SettingInfo::readOnly)
+		TextFormat::printP(out, readOnlyStr);
+}
+
+uint8_t* SettingsRegistry::field(const Settings &settings, const SettingInfo &info) {
+	return (uint8_t*)&settings + info.offset;
+}
+
+int32_t SettingsRegistry::scale(uint8_t decimals) {
+	int32_t scale = 1;
+	while (decimals-- > 0)
+		scale *= 10;
+	return scale;
+}
@@ -0,0 +1,152 @@
+// #############################################################################
+//
+// # Name       : SettingsRegistry
+//
+// # Description: Table in flash describing every setting reachable through serial
+// # Each entry holds a setting's name, type, valid range, unit and where its value
+// # lives inside Settings, so get, set, list and help are driven by the table and
+// # adding a setting takes one line in it. Entries are sorted by name and looked up
+// # with a binary search. Values travel as fixed-point numbers: floats are scaled
+// # by the decimals of their type, booleans are 0 or 1.
+//
+// #  This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// #############################################################################
+
+#ifndef SETTINGSREGISTRY_H
+#define SETTINGSREGISTRY_H
+
+#include <Arduino.h>
+#include <TextFormat.h>
+#include "Settings.h"
+
+//Setting names, in table order
+const char settingsNameStr0[] PROGMEM = "AlarmTriggered";
+const char settingsNameStr1[] PROGMEM = "Celsius";
+const char settingsNameStr2[] PROGMEM = "ECalarmDown";
+const char settingsNameStr3[] PROGMEM = "ECalarmUp";
+const char settingsNameStr4[] PROGMEM = "FloodMinute";
+const char settingsNameStr5[] PROGMEM = "Led";
+const char settingsNameStr6[] PROGMEM = "LightThreshold";
+const char settingsNameStr7[] PROGMEM = "MaxWaterLvl";
+const char settingsNameStr8[] PROGMEM = "MinWaterLvl";
+const char settingsNameStr9[] PROGMEM = "NextWhour";
+const char settingsNameStr10[] PROGMEM = "NextWminute";
+const char settingsNameStr11[] PROGMEM = "NightWatering";
+const char settingsNameStr12[] PROGMEM = "NightWateringStopped";
+const char settingsNameStr13[] PROGMEM = "PHalarmDown";
+const char settingsNameStr14[] PROGMEM = "PHalarmUp";
+const char settingsNameStr15[] PROGMEM = "PumpProtection";
+const char settingsNameStr16[] PROGMEM = "PumpProtectionLvl";
+const char settingsNameStr17[] PROGMEM = "ReservoirModule";
+const char settingsNameStr18[] PROGMEM = "SDactive";
+const char settingsNameStr19[] PROGMEM = "SDhour";
+const char settingsNameStr20[] PROGMEM = "SDminute";
+const char settingsNameStr21[] PROGMEM = "SensorSecond";
+const char settingsNameStr22[] PROGMEM = "SerialDebug";
+const char settingsNameStr23[] PROGMEM = "Sound";
+const char settingsNameStr24[] PROGMEM = "WaterAlarm";
+const char settingsNameStr25[] PROGMEM = "WaterHour";
+const char settingsNameStr26[] PROGMEM = "WaterMinute";
+const char settingsNameStr27[] PROGMEM = "WaterTimed";
+const char settingsNameStr28[] PROGMEM = "WateringPlants";
+
+//Units
+const char noUnitStr[] PROGMEM = "";
+const char hourUnitStr[] PROGMEM = "h";
+const char minuteUnitStr[] PROGMEM = "min";
+const char secondUnitStr[] PROGMEM = "s";
+const char percentUnitStr[] PROGMEM = "%";
+const char luxUnitStr[] PROGMEM = "lux";
+const char cmUnitStr[] PROGMEM = "cm";
+const char pHUnitStr[] PROGMEM = "pH";
+const char ecUnitStr[] PROGMEM = "mS";
+
+//Boolean values
+const char boolTrueStr[] PROGMEM = "true";
+const char boolFalseStr[] PROGMEM = "false";
+const char boolOnStr[] PROGMEM = "on";
+const char boolOffStr[] PROGMEM = "off";
+
+//Types
+const char boolTypeStr[] PROGMEM = "true/false";
+const char rangeSeparatorStr[] PROGMEM = " .. ";
+const char readOnlyStr[] PROGMEM = " (read only)";
+
+struct SettingInfo {
+	//Value types
+	static const uint8_t Bool = 0;
+	static const uint8_t UInt8 = 1;
+	static const uint8_t UInt16 = 2;
+	//Floats with one and two decimals
+	static const uint8_t Fixed1 = 3;
+	static const uint8_t Fixed2 = 4;
+	//flags
+	static const uint8_t stored = 0x01;
+	static const uint8_t readOnly = 0x02;
+	//Settings::*Changed() flag raised on set
+	static const uint8_t waterChange = 0x04;
+	static const uint8_t sdChange = 0x08;
+	static const uint8_t pollingChange = 0x10;
+	static const uint8_t serialChange = 0x20;
+	static const uint8_t moduleChange = 0x40;
+
+	const char *name;
+	//Settings::Setting
+	uint8_t id;
+	//Byte offset of value inside Settings
+	uint8_t offset;
+	uint8_t type;
+	uint8_t flags;
+	//Fixed-point range
+	int16_t min;
+	int16_t max;
+	const char *unit;
+
+	uint8_t decimals() const;
+};
+
+class SettingsRegistry {
+	public:
+		static const uint8_t nSettings = 29;
+		static const int8_t notFound = -1;
+
+		//Index of setting called name, or notFound
+		static int8_t find(const char *name);
+		//Entry i of the table
+		static void info(uint8_t i, SettingInfo &info);
+		//Name of entry i, in PROGMEM
+		static const char* name(uint8_t i);
+		static int32_t get(const Settings &settings, uint8_t i);
+		//Parses str as a value of entry i. False if it isn't one or it's out of range
+		static boolean parse(uint8_t i, const char *str, int32_t &value);
+		//Stores value, raising Settings' change flags. False if read only or out of range.
+		//Without persist it's left for a later save()
+		static boolean set(Settings &settings, uint8_t i, int32_t value, boolean persist = true);
+		//Queues settings for EEPROM
+		static void save(Settings &settings);
+		//Value with its decimals and unit
+		static void printValue(Print &out, uint8_t i, int32_t value);
+		//"0 .. 23 h" or "true/false", plus read only mark
+		static void printRange(Print &out, uint8_t i);
+
+	private:
+		static const SettingInfo _table[nSettings];
+
+		//Byte of value inside Settings
+		static uint8_t* field(const Settings &settings, const SettingInfo &info);
+		static int32_t scale(uint8_t decimals);
+};
+
+#endif
@@ -0,0 +1,235 @@
+#include "SettingsStore.h"
+
+const float LegacySettings::knownVersion = 1.6;
+
+SettingsRecord SettingsStore::_buffer;
+uint16_t SettingsStore::_address = 0;
+volatile uint8_t SettingsStore::_index = 0;
+volatile boolean SettingsStore::_writing = false;
+volatile uint16_t SettingsStore::_bytesWritten = 0;
+
+ISR(EE_READY_vect) {
+	SettingsStore::writeNext();
+}
+
+SettingsStore::SettingsStore() : _slot(nSlots - 1), _sequence(0), _dirty(false), _saves(0),
+	_coalesced(0), _records(0) {}
+
+SettingsStore::SettingsStore(const SettingsStore &other) {
+	*this = other;
+}
+
+SettingsStore& SettingsStore::operator=(const SettingsStore &other) {
+	_slot = other._slot;
+	_sequence = other._sequence;
+	_queued = other._queued;
+	_dirty = other._dirty;
+	_saves = other._saves;
+	_coalesced = other._coalesced;
+	_records = other._records;
+	return *this;
+}
+
+SettingsStore::~SettingsStore() {}
+
+SettingsStore::Result SettingsStore::load(SettingsRecord &record) {
+	uint8_t data[slotSize];
+	uint8_t schema;
+	if (!loadSlot(data, schema)) {
+		if (!loadLegacy(data))
+			return Empty;
+		schema = SettingsRecord::legacySchema;
+	}
+	migrate(data, schema);
+	memcpy(&record, data, sizeof(SettingsRecord));
+	return (schema == SettingsRecord::currentSchema) ? Current : Migrated;
+}
+
+void SettingsStore::save(const SettingsRecord &record) {
+	if (_dirty)
+		_coalesced++;
+	_queued = record;
+	_dirty = true;
+	_saves++;
+	process();
+}
+
+void SettingsStore::process() {
+	if (_dirty && !_writing)
+		start();
+}
+
+void SettingsStore::flush() {
+	do {
+		process();
+	} while (busy());
+}
+
+boolean SettingsStore::busy() const {
+	return _dirty || _writing;
+}
+
+boolean SettingsStore::dirty() const {
+	return _dirty;
+}
+
+uint8_t SettingsStore::pending() const {
+	return _writing ? sizeof(SettingsRecord) - _index : 0;
+}
+
+uint8_t SettingsStore::getSlot() const {
+	return _slot;
+}
+
+uint16_t SettingsStore::getSaves() const {
+	return _saves;
+}
+
+uint16_t SettingsStore::getCoalesced() const {
+	return _coalesced;
+}
+
+uint16_t SettingsStore::getRecordsWritten() const {
+	return _records;
+}
+
+uint16_t SettingsStore::getBytesWritten() const {
+	uint8_t oldSREG = SREG;
+	cli();
+	uint16_t bytes = _bytesWritten;
+	SREG = oldSREG;
+	return bytes;
+}
+
+//Interrupt is off while not writing, so buffer is free to fill
+void SettingsStore::start() {
+	_slot = (_slot + 1) % nSlots;
+	_sequence++;
+	_queued.sequence = _sequence;
+	_queued.schema = SettingsRecord::currentSchema;
+	_queued.size = sizeof(SettingsRecord);
+	_queued.crc = crc((const uint8_t*)&_queued, sizeof(SettingsRecord));
+	_buffer = _queued;
+	_address = address(_slot);
+	_index = 0;
+	_dirty = false;
+	_records++;
+	_writing = true;
+	EECR |= _BV(EERIE);
+}
+
+//Programs next byte that differs, or turns itself off when there are none left.
+//Interrupt fires again once the byte is written
+void SettingsStore::writeNext() {
+	const uint8_t *data = (const uint8_t*)&_buffer;
+	while (_index < sizeof(SettingsRecord)) {
+		uint8_t value = data[_index];
+		EEAR = _address + _index;
+		_index++;
+		EECR |= _BV(EERE);
+		if (EEDR != value) {
+			EEDR = value;
+			//EEPE must be set within four cycles of EEMPE
+			EECR |= _BV(EEMPE);
+			EECR |= _BV(EEPE);
+			_bytesWritten++;
+			return;
+		}
+	}
+	EECR &= ~_BV(EERIE);
+	_writing = false;
+}
+
+boolean SettingsStore::loadSlot(uint8_t *data, uint8_t &schema) {
+	SettingsRecord &header = *(SettingsRecord*)data;
+	//Bit set for slots already found bad
+	uint16_t rejected = 0;
+	for (uint8_t tries = 0; tries < nSlots; tries++) {
+		//Newest slot left. Sequences wrap, so they're compared by difference
+		int8_t newest = -1;
+		uint16_t newestSequence = 0;
+		for (uint8_t i = 0; i < nSlots; i++) {
+			if (rejected & (1 << i))
+				continue;
+			uint16_t sequence = eeprom_read_word((const uint16_t*)(address(i) + offsetof(SettingsRecord, sequence)));
+			if ((newest < 0) || ((int16_t)(sequence - newestSequence) > 0)) {
+				newest = i;
+				newestSequence = sequence;
+			}
+		}
+		//Header is the same in every schema
+		eeprom_read_block(data, (const void*)address(newest), offsetof(SettingsRecord, version));
+		if ((header.schema > SettingsRecord::legacySchema) && (header.schema <= SettingsRecord::currentSchema)
+			&& (header.size > offsetof(SettingsRecord, version)) && (header.size <= slotSize)) {
+			eeprom_read_block(data, (const void*)address(newest), header.size);
+			if (header.crc == crc(data, header.size)) {
+				_slot = newest;
+				_sequence = header.sequence;
+				schema = header.schema;
+				return true;
+			}
+		}
+		rejected |= (1 << newest);
+	}
+	return false;
+}
+
+boolean SettingsStore::loadLegacy(uint8_t *data) {
+	LegacySettings &legacy = *(LegacySettings*)data;
+	eeprom_read_block(data, (const void*)legacyAddress, sizeof(LegacySettings));
+	return legacy.version == LegacySettings::knownVersion;
+}
+
+//Steps fall through, so a record goes up one schema at a time
+void SettingsStore::migrate(uint8_t *data, uint8_t schema) {
+	switch (schema) {
+		case SettingsRecord::legacySchema:
+			migrateLegacy(data);
+		default:
+			break;
+	}
+}
+
+void SettingsStore::migrateLegacy(uint8_t *data) {
+	LegacySettings legacy;
+	memcpy(&legacy, data, sizeof(LegacySettings));
+	SettingsRecord record;
+	record.crc = 0;
+	record.sequence = 0;
+	record.schema = 1;
+	record.size = sizeof(SettingsRecord);
+	record.version = legacy.version;
+	record.waterTimed = legacy.waterTimed;
+	record.waterHour = legacy.waterHour;
+	record.waterMinute = legacy.waterMinute;
+	record.floodMinute = legacy.floodMinute;
+	record.phAlarmUp = legacy.phAlarmUp;
+	record.phAlarmDown = legacy.phAlarmDown;
+	record.ecAlarmUp = legacy.ecAlarmUp;
+	record.ecAlarmDown = legacy.ecAlarmDown;
+	record.waterAlarm = legacy.waterAlarm;
+	record.nightWatering = legacy.nightWatering;
+	record.lightThreshold = legacy.lightThreshold;
+	record.maxWaterLvl = legacy.maxWaterLvl;
+	record.minWaterLvl = legacy.minWaterLvl;
+	record.pumpProtection = legacy.pumpProtection;
+	record.pumpProtectionLvl = legacy.pumpProtectionLvl;
+	record.sensorSecond = legacy.sensorSecond;
+	record.sdActive = legacy.sdActive;
+	record.sdHour = legacy.sdHour;
+	record.sdMinute = legacy.sdMinute;
+	record.sound = legacy.sound;
+	record.led = legacy.led;
+	record.celsius = legacy.celsius;
+	record.serialDebug = legacy.serialDebug;
+	record.reservoirModule = legacy.reservoirModule;
+	memcpy(data, &record, sizeof(SettingsRecord));
+}
+
+int SettingsStore::address(uint8_t slot) {
+	return baseAddress + slot * slotSize;
+}
+
+uint16_t SettingsStore::crc(const uint8_t *data, uint8_t size) {
+	return logCrc16(data + sizeof(uint16_t), size - sizeof(uint16_t));
+}
@@ -0,0 +1,192 @@
+// #############################################################################
+//
+// # Name       : SettingsStore
+//
+// # Description: Keeps persistent settings in EEPROM as a single CRC'd record
+// # Records are written to a ring of nSlots slots, one slot further each save, so
+// # wear is spread over all of them instead of hitting the same cells every time.
+// # Each record carries a sequence number; at boot the newest slot that passes its
+// # CRC check is used, so a save cut short by a power loss falls back to the one
+// # before it instead of loading garbage.
+// # Saves don't block: the record is queued and written by the EE_READY interrupt
+// # one byte at a time, skipping bytes that already hold the right value, while the
+// # loop goes on. Saves made before a write starts are coalesced into one record.
+// # Records of an older schema are upgraded on load by a chain of migration steps,
+// # each turning schema n into n + 1. Schema 0 is the one-setting-per-address layout
+// # firmware 1.6 kept at address 0, so settings survive upgrading from it too.
+//
+// #  This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// #############################################################################
+
+#ifndef SETTINGSSTORE_H
+#define SETTINGSSTORE_H
+
+#include <Arduino.h>
+#include <avr/eeprom.h>
+#include <avr/interrupt.h>
+#include "LogFormat.h"
+
+//Layout of firmware 1.6 and older, each setting at the address EEPROMEx handed out
+struct LegacySettings {
+	//Only firmware whose layout is known
+	static const float knownVersion;
+
+	uint8_t waterTimed;
+	uint8_t waterHour;
+	uint8_t waterMinute;
+	uint8_t floodMinute;
+	float phAlarmUp;
+	float phAlarmDown;
+	float ecAlarmUp;
+	float ecAlarmDown;
+	uint8_t waterAlarm;
+	uint8_t nightWatering;
+	uint8_t sensorSecond;
+	uint8_t sdActive;
+	uint8_t sdHour;
+	uint8_t sdMinute;
+	uint8_t sound;
+	uint8_t led;
+	uint8_t celsius;
+	uint8_t serialDebug;
+	uint16_t lightThreshold;
+	uint8_t reservoirModule;
+	uint16_t maxWaterLvl;
+	uint16_t minWaterLvl;
+	uint8_t pumpProtection;
+	uint8_t pumpProtectionLvl;
+	float version;
+} __attribute__ ((packed));
+
+//Every setting kept in EEPROM. Booleans are stored as bytes.
+//New fields go at the end, with a migration step that sets them
+struct SettingsRecord {
+	static const uint8_t legacySchema = 0;
+	static const uint8_t currentSchema = 1;
+
+	//Header. CRC covers the rest of the record, size bytes in all
+	uint16_t crc;
+	uint16_t sequence;
+	uint8_t schema;
+	uint8_t size;
+	//Firmware version that wrote it
+	float version;
+	//System Settings
+	uint8_t waterTimed;
+	uint8_t waterHour;
+	uint8_t waterMinute;
+	uint8_t floodMinute;
+	float phAlarmUp;
+	float phAlarmDown;
+	float ecAlarmUp;
+	float ecAlarmDown;
+	uint8_t waterAlarm;
+	uint8_t nightWatering;
+	uint16_t lightThreshold;
+	uint16_t maxWaterLvl;
+	uint16_t minWaterLvl;
+	uint8_t pumpProtection;
+	uint8_t pumpProtectionLvl;
+	//Controller Settings
+	uint8_t sensorSecond;
+	uint8_t sdActive;
+	uint8_t sdHour;
+	uint8_t sdMinute;
+	uint8_t sound;
+	uint8_t led;
+	uint8_t celsius;
+	uint8_t serialDebug;
+	uint8_t reservoirModule;
+} __attribute__ ((packed));
+
+class SettingsStore {
+	public:
+		//Ring sits after the addresses the old one-setting-per-address layout used
+		static const int baseAddress = 64;
+		static const uint8_t slotSize = 64;
+		static const uint8_t nSlots = 16;
+		//Address of LegacySettings
+		static const int legacyAddress = 0;
+
+		//What load() found
+		enum Result {
+			Empty = 0,
+			Current,
+			Migrated
+		};
+
+		SettingsStore();
+		SettingsStore(const SettingsStore &other);
+		SettingsStore& operator=(const SettingsStore &other);
+		~SettingsStore();
+
+		//Reads newest valid record, migrating it to current schema if it's older.
+		//Falls back to the legacy layout if no slot holds one. Only meant for boot,
+		//before anything is saved
+		Result load(SettingsRecord &record);
+		//Queues record for the slot after the newest one and returns at once.
+		//It replaces any record still waiting for the current write to end
+		void save(const SettingsRecord &record);
+		//Starts writing the queued record once the last write is done. Call it once per loop
+		void process();
+		//Waits until every saved record is in EEPROM
+		void flush();
+		boolean busy() const;
+		//True if a record is waiting for the current write to end
+		boolean dirty() const;
+		//Bytes of the current write not gone through yet
+		uint8_t pending() const;
+		//Slot last loaded or written to
+		uint8_t getSlot() const;
+		uint16_t getSaves() const;
+		//Saves that replaced a queued record
+		uint16_t getCoalesced() const;
+		uint16_t getRecordsWritten() const;
+		//EEPROM bytes actually programmed
+		uint16_t getBytesWritten() const;
+		//Called from EE_READY interrupt
+		static void writeNext();
+
+	private:
+		uint8_t _slot;
+		uint16_t _sequence;
+		SettingsRecord _queued;
+		boolean _dirty;
+		uint16_t _saves;
+		uint16_t _coalesced;
+		uint16_t _records;
+		//Interrupt writer state. There's a single EEPROM, so it's shared by all instances
+		static SettingsRecord _buffer;
+		static uint16_t _address;
+		static volatile uint8_t _index;
+		static volatile boolean _writing;
+		static volatile uint16_t _bytesWritten;
+
+		//Seals queued record into buffer and enables EE_READY interrupt
+		void start();
+		//Reads newest slot with a good CRC into data and its schema. False if there's none
+		boolean loadSlot(uint8_t *data, uint8_t &schema);
+		//Legacy layout into data, if it was written by a known firmware
+		static boolean loadLegacy(uint8_t *data);
+		//Upgrades a record held at the start of a slot-sized buffer from schema to current
+		static void migrate(uint8_t *data, uint8_t schema);
+		//Migration steps. Each turns schema n into n + 1
+		static void migrateLegacy(uint8_t *data);
+		static int address(uint8_t slot);
+		//Over size bytes of a record, header included
+		static uint16_t crc(const uint8_t *data, uint8_t size);
+};
+
+#endif
@@ -0,0 +1,75 @@
+#include "SettingsTransaction.h"
+
+SettingsTransaction::SettingsTransaction() : _active(false), _staged(0), _rejected(0) {}
+
+SettingsTransaction::SettingsTransaction(const SettingsTransaction &other) {
+	*this = other;
+}
+
+SettingsTransaction& SettingsTransaction::operator=(const SettingsTransaction &other) {
+	_active = other._active;
+	_staged = other._staged;
+	_rejected = other._rejected;
+	memcpy(_setting, other._setting, sizeof(_setting));
+	memcpy(_value, other._value, sizeof(_value));
+	return *this;
+}
+
+SettingsTransaction::~SettingsTransaction() {}
+
+void SettingsTransaction::begin() {
+	_active = true;
+	_staged = 0;
+	_rejected = 0;
+}
+
+boolean SettingsTransaction::active() const {
+	return _active;
+}
+
+void SettingsTransaction::stage(uint8_t i, int16_t value) {
+	uint8_t n = 0;
+	while ((n < _staged) && (_setting[n] != i))
+		n++;
+	if (n == _staged) {
+		//Can't happen while each setting is staged once, but it's not worth overflowing over
+		if (_staged == maxStaged) {
+			reject();
+			return;
+		}
+		_setting[n] = i;
+		_staged++;
+	}
+	_value[n] = value;
+}
+
+void SettingsTransaction::reject() {
+	_rejected++;
+}
+
+boolean SettingsTransaction::commit(Settings &settings) {
+	_active = false;
+	if (_rejected > 0)
+		return false;
+	for (uint8_t n = 0; n < _staged; n++)
+		SettingsRegistry::set(settings, _setting[n], _value[n], false);
+	if (_staged > 0)
+		SettingsRegistry::save(settings);
+	return true;
+}
+
+void SettingsTransaction::abort() {
+	_active = false;
+}
+
+uint8_t SettingsTransaction::staged() const {
+	return _staged;
+}
+
+uint8_t SettingsTransaction::setting(uint8_t n) const {
+	return _setting[n];
+}
+
+uint8_t SettingsTransaction::rejected() const {
+	return _rejected;
+}
@@ -0,0 +1,68 @@
+// #############################################################################
+//
+// # Name       : SettingsTransaction
+//
+// # Description: Groups serial settings changes so they are applied all together
+// # Between begin() and commit() values are checked and staged instead of being
+// # set. commit() applies every one of them and saves settings once; if any of
+// # them was rejected nothing is applied, so a unit is never left half configured.
+// # Values are kept in the fixed-point form SettingsRegistry uses, one entry per
+// # setting, a later value replacing an earlier one.
+//
+// #  This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// #############################################################################
+
+#ifndef SETTINGSTRANSACTION_H
+#define SETTINGSTRANSACTION_H
+
+#include <Arduino.h>
+#include "SettingsRegistry.h"
+
+class SettingsTransaction {
+	public:
+		//A setting is staged once at most
+		static const uint8_t maxStaged = SettingsRegistry::nSettings;
+
+		SettingsTransaction();
+		SettingsTransaction(const SettingsTransaction &other);
+		SettingsTransaction& operator=(const SettingsTransaction &other);
+		~SettingsTransaction();
+
+		//Drops anything staged and starts staging
+		void begin();
+		boolean active() const;
+		//Keeps value of registry entry i for commit. Value must have passed SettingsRegistry::parse()
+		void stage(uint8_t i, int16_t value);
+		//A set that was rejected. Makes commit() drop the whole transaction
+		void reject();
+		//Applies staged values and saves once. False, changing nothing, if a set was rejected
+		boolean commit(Settings &settings);
+		//Ends transaction without applying anything
+		void abort();
+		//Entries staged. Still readable after commit() until next begin()
+		uint8_t staged() const;
+		//Registry index of staged entry n
+		uint8_t setting(uint8_t n) const;
+		uint8_t rejected() const;
+
+	private:
+		boolean _active;
+		uint8_t _staged;
+		uint8_t _rejected;
+		uint8_t _setting[maxStaged];
+		int16_t _value[maxStaged];
+};
+
+#endif
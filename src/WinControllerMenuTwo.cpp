@@ -31,9 +31,9 @@ void WinControllerMenuTwo::printToggles() {
 	_lcd->setFont(hallfetica_normal);
 	//Serial ON/OFF
 	if (_serialActive)
-		_lcd->print(pmChar(onStr),_xMenu+_bigFontSize*2+_bigFontSize*strlen_P(controllerButtonTextTwo[2]),_yThreeLnsFirst+_bigFontSize*_yFactor3lines*2);
+		_lcd->print(pmChar(onStr),_xMenu+_bigFontSize*2+_bigFontSize*strlen_P(controllerButtonTextTwo[2]),_yFourLines+_bigFontSize*_yFactor4lines*2);
 	else
-		_lcd->print(pmChar(offStr),_xMenu+_bigFontSize*2+_bigFontSize*strlen_P(controllerButtonTextTwo[2]),_yThreeLnsFirst+_bigFontSize*_yFactor3lines*2);
+		_lcd->print(pmChar(offStr),_xMenu+_bigFontSize*2+_bigFontSize*strlen_P(controllerButtonTextTwo[2]),_yFourLines+_bigFontSize*_yFactor4lines*2);
 }
 
 void WinControllerMenuTwo::print() {
@@ -45,8 +45,8 @@ void WinControllerMenuTwo::print() {
 	
 	//Print bulletpoints & texts
 	for (uint8_t i = 0; i < _nControllerButtonsTwo - _nFlowButtons; i++) {
-		_lcd->print(pmChar(bulletStr),_xMenu,_yThreeLnsFirst+_bigFontSize*_yFactor3lines*i);
-		_controllerButtonsTwo[i + _nFlowButtons] = _buttons.addButton(_xMenu+_bigFontSize*2,_yThreeLnsFirst+_bigFontSize*_yFactor3lines*i,(char*)pgm_read_word(&controllerButtonTextTwo[i]));
+		_lcd->print(pmChar(bulletStr),_xMenu,_yFourLines+_bigFontSize*_yFactor4lines*i);
+		_controllerButtonsTwo[i + _nFlowButtons] = _buttons.addButton(_xMenu+_bigFontSize*2,_yFourLines+_bigFontSize*_yFactor4lines*i,(char*)pgm_read_word(&controllerButtonTextTwo[i]));
 	}
 	printToggles();
 }
@@ -89,6 +89,8 @@ Window::Screen WinControllerMenuTwo::processTouch(const int x, const int y) {
 		_settings->setSerialDebug(_serialActive);
 		_sensors->setSerialDebug(_serialActive);
 		update();
-	}
+	//Diagnostics
+	} else if (buttonIndex == _controllerButtonsTwo[6])
+		return Diagnostics;
 	return None;
 }
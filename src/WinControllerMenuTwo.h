@@ -34,7 +34,9 @@ const char nameWinControllerMenuTwo[] PROGMEM = "Controller Settings";
 const char controller2Str0[] PROGMEM = "SD Card";
 const char controller2Str1[] PROGMEM = "Sensor Polling";
 const char controller2Str2[] PROGMEM = "Serial Debugging:";
-const char* const controllerButtonTextTwo[] PROGMEM = { controller2Str0, controller2Str1, controller2Str2 };
+const char controller2Str3[] PROGMEM = "Diagnostics";
+const char* const controllerButtonTextTwo[] PROGMEM = { controller2Str0, controller2Str1, controller2Str2,
+	controller2Str3 };
 
 class WinControllerMenuTwo: public Window {
 	public:
@@ -48,7 +50,7 @@ class WinControllerMenuTwo: public Window {
 		Window::Screen processTouch(const int x, const int y);
 	
 	protected:
-		static const uint8_t _nControllerButtonsTwo = _nFlowButtons + 3;
+		static const uint8_t _nControllerButtonsTwo = _nFlowButtons + 4;
 		int8_t _controllerButtonsTwo[_nControllerButtonsTwo];
 		//These are temp variables used for displaying data
 		//They are read from _settings in print() funcs. Changed in processTouch()
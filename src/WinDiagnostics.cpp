@@ -0,0 +1,78 @@
+#include "WinDiagnostics.h"
+
+WinDiagnostics::WinDiagnostics(UTFT *lcd, UTouch *touch, Sensors *sensors, Settings *settings) 
+: Window(lcd,touch,sensors,settings) { }
+
+WinDiagnostics::WinDiagnostics(const WinDiagnostics &other) : Window(other) { 
+	for (uint8_t i = 0; i < _nDiagnosticsButtons; i++) {
+		_diagnosticsButtons[i] = other._diagnosticsButtons[i];
+	}
+}
+	
+WinDiagnostics& WinDiagnostics::operator=(const WinDiagnostics& other) {
+	_lcd = other._lcd;
+	_touch = other._touch;
+	_sensors = other._sensors;
+	_settings = other._settings;
+	_buttons = other._buttons;
+	for (uint8_t i = 0; i < _nDiagnosticsButtons; i++) {
+		_diagnosticsButtons[i] = other._diagnosticsButtons[i];
+	}
+	return *this;
+}
+
+WinDiagnostics::~WinDiagnostics() {}
+	
+Window::Screen WinDiagnostics::getType() const {
+	return Window::Diagnostics;
+}
+
+void WinDiagnostics::print() {
+	_lcd->setColor(grey[0],grey[1],grey[2]);
+	_lcd->setBackColor(VGA_WHITE);
+	_lcd->setFont(hallfetica_normal);
+	
+	//Labels and units. Numbers are printed by update()
+	for (uint8_t i = 0; i < _nDiagnosticsLines; i++) {
+		int y = _yFiveLines+_bigFontSize*_yFactor5lines*i;
+		_lcd->print(pmChar((const char*)pgm_read_word(&diagnosticsText[i])),_xConfig,y);
+		if (i == _nDiagnosticsLines - 1)
+			_lcd->print(pmChar(percentSign),_xConfig+19*_bigFontSize,y);
+		else
+			_lcd->print(pmChar(bytesStr),_xConfig+19*_bigFontSize,y);
+	}
+	update();
+}
+
+//Redraws only numbers, as GUI::refresh() calls it periodically
+void WinDiagnostics::update() {
+	int values[_nDiagnosticsLines] = { MemoryMonitor::freeMemory(), MemoryMonitor::minFreeMemory(),
+		MemoryMonitor::maxStackUsed(), MemoryMonitor::largestFreeBlock(), MemoryMonitor::fragmentation() };
+	
+	_lcd->setColor(grey[0],grey[1],grey[2]);
+	_lcd->setBackColor(VGA_WHITE);
+	_lcd->setFont(hallfetica_normal);
+	for (uint8_t i = 0; i < _nDiagnosticsLines; i++)
+		_lcd->printNumI(values[i],_xConfig+14*_bigFontSize,_yFiveLines+_bigFontSize*_yFactor5lines*i,4,' ');
+}
+ 
+//Draws entire screen Diagnostics
+void WinDiagnostics::draw() {
+	_lcd->fillScr(VGA_WHITE);
+	_buttons.deleteAllButtons();
+	printMenuHeader(nameWinDiagnostics);
+	addFlowButtons(true,false,true,_diagnosticsButtons);
+	print();
+	_buttons.drawButtons();
+}
+
+Window::Screen WinDiagnostics::processTouch(const int x, const int y) {
+	int buttonIndex = _buttons.checkButtons(x,y);
+	//Back
+	if (buttonIndex == _diagnosticsButtons[0]) 
+		return ControllerSettingsTwo;
+	//Exit
+	else if (buttonIndex == _diagnosticsButtons[2]) 
+		return MainScreen;
+	return None;
+}
@@ -0,0 +1,60 @@
+// #############################################################################
+//
+// # Name       : WinDiagnostics
+//
+// # Description: Memory diagnostics window. Shows MemoryMonitor telemetry
+//
+// #  This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// #############################################################################
+
+
+#ifndef WINDIAGNOSTICS_H_
+#define WINDIAGNOSTICS_H_
+
+#include "Window.h"
+#include "MemoryMonitor.h"
+
+const char nameWinDiagnostics[] PROGMEM = "Diagnostics";
+
+const char diagnosticsStr0[] PROGMEM = "Free memory:";
+const char diagnosticsStr1[] PROGMEM = "Lowest free:";
+const char diagnosticsStr2[] PROGMEM = "Max stack:";
+const char diagnosticsStr3[] PROGMEM = "Largest block:";
+const char diagnosticsStr4[] PROGMEM = "Fragmented:";
+const char* const diagnosticsText[] PROGMEM = { diagnosticsStr0, diagnosticsStr1, diagnosticsStr2,
+	diagnosticsStr3, diagnosticsStr4 };
+const char bytesStr[] PROGMEM = "B";
+
+class WinDiagnostics: public Window {
+	public:
+		WinDiagnostics(UTFT *lcd, UTouch *touch, Sensors *sensors, Settings *settings);
+		WinDiagnostics(const WinDiagnostics &other);
+		WinDiagnostics& operator=(const WinDiagnostics &other);
+		~WinDiagnostics();
+		Screen getType() const;
+		void draw();
+		void update();
+		Window::Screen processTouch(const int x, const int y);
+	
+	protected:
+		static const uint8_t _nDiagnosticsButtons = _nFlowButtons;
+		static const uint8_t _nDiagnosticsLines = 5;
+		int8_t _diagnosticsButtons[_nDiagnosticsButtons];
+		void print();
+};
+
+
+
+#endif
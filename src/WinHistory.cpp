@@ -0,0 +1,320 @@
+#include "WinHistory.h"
+
+uint8_t WinHistory::_channel = 0;
+uint8_t WinHistory::_range = 2;
+
+WinHistory::WinHistory(UTFT *lcd, UTouch *touch, Sensors *sensors, Settings *settings)
+: Window(lcd,touch,sensors,settings), _from(0), _window(SECS_PER_DAY), _low(0), _high(0), _found(false) { }
+
+WinHistory::WinHistory(const WinHistory &other) : Window(other) {
+	for (uint8_t i = 0; i < _nHistoryButtons; i++) {
+		_historyButtons[i] = other._historyButtons[i];
+	}
+	_from = other._from;
+	_window = other._window;
+	_low = other._low;
+	_high = other._high;
+	_found = other._found;
+	memcpy(_min, other._min, sizeof(_min));
+	memcpy(_max, other._max, sizeof(_max));
+}
+
+WinHistory& WinHistory::operator=(const WinHistory& other) {
+	_lcd = other._lcd;
+	_touch = other._touch;
+	_sensors = other._sensors;
+	_settings = other._settings;
+	_buttons = other._buttons;
+	for (uint8_t i = 0; i < _nHistoryButtons; i++) {
+		_historyButtons[i] = other._historyButtons[i];
+	}
+	_from = other._from;
+	_window = other._window;
+	_low = other._low;
+	_high = other._high;
+	_found = other._found;
+	memcpy(_min, other._min, sizeof(_min));
+	memcpy(_max, other._max, sizeof(_max));
+	return *this;
+}
+
+WinHistory::~WinHistory() {}
+
+Window::Screen WinHistory::getType() const {
+	return Window::History;
+}
+
+void WinHistory::print() {
+	drawPlot();
+}
+
+//Draws entire screen History
+void WinHistory::draw() {
+	_lcd->fillScr(VGA_WHITE);
+	_buttons.deleteAllButtons();
+	printMenuHeader(nameWinHistory);
+	addFlowButtons(true,false,true,_historyButtons);
+	//Reservoir module may have been turned off since last time
+	if (!_settings->getReservoirModule() && (_channel > 2))
+		_channel = 0;
+	const int y = _headerHeight + 10;
+	_historyButtons[3] = _buttons.addButton(_xConfig,y,(const char*)pgm_read_word(&historySensors[_channel]));
+	_historyButtons[4] = _buttons.addButton(_xSize-15-_bigFontSize*strlen_P(historyRangeStr0),y,
+		(const char*)pgm_read_word(&historyRanges[_range]));
+	print();
+	_buttons.drawButtons();
+}
+
+Window::Screen WinHistory::processTouch(const int x, const int y) {
+	int buttonIndex = _buttons.checkButtons(x,y);
+	//Back or Exit
+	if ((buttonIndex == _historyButtons[0]) || (buttonIndex == _historyButtons[2]))
+		return MainScreen;
+	//Sensor
+	else if (buttonIndex == _historyButtons[3]) {
+		nextChannel();
+		_buttons.relabelButton(_historyButtons[3],(const char*)pgm_read_word(&historySensors[_channel]),true);
+		drawPlot();
+	//Range
+	} else if (buttonIndex == _historyButtons[4]) {
+		_range = (_range + 1) % _nRanges;
+		_buttons.relabelButton(_historyButtons[4],(const char*)pgm_read_word(&historyRanges[_range]),true);
+		drawPlot();
+	}
+	return None;
+}
+
+boolean WinHistory::load() {
+	_window = pgm_read_dword(&historyRangeSecs[_range]);
+	_from = now() - _window;
+	_found = false;
+	scan(false);
+	if (!_found)
+		return false;
+	//Thresholds are always in sight
+	int32_t values[2];
+	uint8_t n = thresholds(values);
+	for (uint8_t i = 0; i < n; i++) {
+		if (values[i] < _low)
+			_low = values[i];
+		if (values[i] > _high)
+			_high = values[i];
+	}
+	if (_high == _low) {
+		_high++;
+		_low--;
+	}
+	memset(_min, _empty, _nLeaves);
+	memset(_max, _empty, _nLeaves);
+	scan(true);
+	joinLeaves();
+	buildPyramid();
+	return true;
+}
+
+void WinHistory::scan(boolean fill) {
+	time_t from = _from;
+	//Week: hours on card first, then whatever SensorSeries has after them
+	if ((_range == _weekRange) && _settings->getSDactive()) {
+		char fileName[sizeof(hourlyFile)];
+		strcpy_P(fileName, hourlyFile);
+		File file = SD.open(fileName, FILE_READ);
+		if (file) {
+			//File is in time order, window's hours are at its end
+			uint32_t n = file.size() / sizeof(RollupRecord);
+			uint32_t hours = _window / SECS_PER_HOUR + 1;
+			file.seek((n > hours) ? (n - hours) * sizeof(RollupRecord) : 0);
+			RollupRecord record;
+			while (file.read(&record, sizeof(RollupRecord)) == sizeof(RollupRecord)) {
+				if (!record.valid() || !(record.present & (1 << _channel)))
+					continue;
+				add(record.start, LogRecord::value(_channel, record.min[_channel]),
+					LogRecord::value(_channel, record.max[_channel]), fill);
+				if (record.start + SECS_PER_HOUR > from)
+					from = record.start + SECS_PER_HOUR;
+			}
+			file.close();
+		}
+	}
+	SensorSeries::Iterator it = sensorSeries.begin(from);
+	SensorSample sample;
+	while (it.next(sample)) {
+		if (sample.present & (1 << _channel))
+			add(sample.time, sample.value[_channel], sample.value[_channel], fill);
+	}
+}
+
+void WinHistory::add(time_t t, int32_t min, int32_t max, boolean fill) {
+	if ((t < _from) || (t - _from >= _window))
+		return;
+	if (!fill) {
+		if (!_found || (min < _low))
+			_low = min;
+		if (!_found || (max > _high))
+			_high = max;
+		_found = true;
+		return;
+	}
+	uint16_t leaf = (uint32_t)(t - _from) * _nLeaves / _window;
+	uint8_t low = toRow(min);
+	uint8_t high = toRow(max);
+	if ((_min[leaf] == _empty) || (low < _min[leaf]))
+		_min[leaf] = low;
+	if ((_max[leaf] == _empty) || (high > _max[leaf]))
+		_max[leaf] = high;
+}
+
+void WinHistory::joinLeaves() {
+	uint16_t last = 0;
+	for (uint16_t i = 0; i < _nLeaves; i++) {
+		if (_min[i] != _empty)
+			last = i;
+	}
+	//Span of the last leaf with samples, as it was before joining
+	uint8_t holdMin = _empty;
+	uint8_t holdMax = _empty;
+	for (uint16_t i = 0; i <= last; i++) {
+		uint8_t min = _min[i];
+		uint8_t max = _max[i];
+		if (min == _empty) {
+			if (holdMin != _empty) {
+				_min[i] = holdMin;
+				_max[i] = holdMax;
+			}
+			continue;
+		}
+		if (holdMin != _empty) {
+			if (_min[i] > holdMax)
+				_min[i] = holdMax;
+			if (_max[i] < holdMin)
+				_max[i] = holdMin;
+		}
+		holdMin = min;
+		holdMax = max;
+	}
+}
+
+void WinHistory::buildPyramid() {
+	uint16_t src = 0;
+	uint16_t dst = _nLeaves;
+	for (uint16_t n = _nLeaves / 2; n > 0; n /= 2) {
+		for (uint16_t i = 0; i < n; i++) {
+			uint8_t min = _empty;
+			uint8_t max = _empty;
+			merge(src + 2 * i, min, max);
+			merge(src + 2 * i + 1, min, max);
+			_min[dst + i] = min;
+			_max[dst + i] = max;
+		}
+		src = dst;
+		dst += n;
+	}
+}
+
+//Takes whole nodes from both ends of the range, going up a level each time
+void WinHistory::query(uint16_t from, uint16_t to, uint8_t &min, uint8_t &max) const {
+	min = _empty;
+	max = _empty;
+	uint16_t level = 0;
+	uint16_t n = _nLeaves;
+	while (from < to) {
+		if (from & 1)
+			merge(level + from++, min, max);
+		if (to & 1)
+			merge(level + --to, min, max);
+		level += n;
+		n >>= 1;
+		from >>= 1;
+		to >>= 1;
+	}
+}
+
+void WinHistory::merge(uint16_t node, uint8_t &min, uint8_t &max) const {
+	if (_min[node] == _empty)
+		return;
+	if ((min == _empty) || (_min[node] < min))
+		min = _min[node];
+	if ((max == _empty) || (_max[node] > max))
+		max = _max[node];
+}
+
+void WinHistory::drawPlot() {
+	//Clears plot and its labels
+	_lcd->setColor(VGA_WHITE);
+	_lcd->fillRect(0,_plotY,_xSize,_plotY+_plotHeight);
+	_lcd->setColor(grey[0],grey[1],grey[2]);
+	_lcd->setBackColor(VGA_WHITE);
+	_lcd->drawVLine(_plotX-1,_plotY,_plotHeight);
+	_lcd->drawHLine(_plotX-1,_plotY+_plotHeight,_plotWidth+1);
+	if (!load()) {
+		_lcd->setFont(hallfetica_normal);
+		_lcd->print(pmChar(noDataStr),centerX(noDataStr),_plotY+(_plotHeight-_bigFontSize)/2);
+		return;
+	}
+	_lcd->setFont(Sinclair_S);
+	drawValue(_high,_plotY);
+	drawValue(_low,_plotY+_plotHeight-_smallFontSize);
+	//One span per pixel column
+	_lcd->setColor(darkGreen[0],darkGreen[1],darkGreen[2]);
+	const int bottom = _plotY + _plotHeight - 1;
+	for (int x = 0; x < _plotWidth; x++) {
+		uint16_t from = (uint32_t)x * _nLeaves / _plotWidth;
+		uint16_t to = (uint32_t)(x + 1) * _nLeaves / _plotWidth;
+		if (to <= from)
+			to = from + 1;
+		uint8_t min, max;
+		query(from,to,min,max);
+		if (min != _empty)
+			_lcd->drawVLine(_plotX+x,bottom-max,max-min+1);
+	}
+	//Alarm thresholds
+	int32_t values[2];
+	uint8_t n = thresholds(values);
+	_lcd->setColor(red[0],red[1],red[2]);
+	for (uint8_t i = 0; i < n; i++)
+		_lcd->drawHLine(_plotX,bottom-toRow(values[i]),_plotWidth-1);
+}
+
+//Right aligned to plot's left edge
+void WinHistory::drawValue(int32_t value, int y) {
+	char buf[10];
+	CharBuffer text(buf, sizeof(buf));
+	LogRecord::printValue(text, _channel, value);
+	_lcd->print(buf,_plotX-4-text.length()*_smallFontSize,y);
+}
+
+uint8_t WinHistory::thresholds(int32_t values[2]) const {
+	switch (_channel) {
+		//EC
+		case 3:
+			values[0] = TextFormat::toFixed(_settings->getECalarmUp(), 0);
+			values[1] = TextFormat::toFixed(_settings->getECalarmDown(), 0);
+			return 2;
+		//pH
+		case 4:
+			values[0] = TextFormat::toFixed(_settings->getPHalarmUp(), 2);
+			values[1] = TextFormat::toFixed(_settings->getPHalarmDown(), 2);
+			return 2;
+		//Level
+		case 5:
+			values[0] = _settings->getWaterAlarm();
+			return 1;
+		default:
+			return 0;
+	}
+}
+
+uint8_t WinHistory::toRow(int32_t value) const {
+	if (value <= _low)
+		return 0;
+	if (value >= _high)
+		return _plotHeight - 1;
+	return (uint32_t)(value - _low) * (_plotHeight - 1) / (uint32_t)(_high - _low);
+}
+
+void WinHistory::nextChannel() {
+	_channel = (_channel + 1) % LogRecord::nChannels;
+	//Reservoir sensors are channels 3 to 5
+	if (!_settings->getReservoirModule() && (_channel > 2))
+		_channel = 0;
+}
@@ -0,0 +1,123 @@
+// #############################################################################
+//
+// # Name       : WinHistory
+//
+// # Description: Trend graph of a sensor over the last 1h, 6h, 24h or 7d
+// # Data comes from SensorSeries, or from HOURLY.BIN on the SD card for 7 days.
+// # It's binned into _nLeaves min/max pairs, quantized to plot rows, and the window
+// # keeps a pyramid of them: each level holds the min/max of pairs of the one below.
+// # Any pixel column's span is then a handful of pyramid nodes away, so drawing
+// # takes one drawVLine per column whatever the number of samples. Alarm
+// # thresholds are drawn as horizontal lines.
+//
+// #  This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// #############################################################################
+
+#ifndef WINHISTORY_H_
+#define WINHISTORY_H_
+
+#include "Window.h"
+#include <SD.h>
+#include <Time.h>
+#include <TextFormat.h>
+#include "LogFormat.h"
+#include "SensorSeries.h"
+
+const char nameWinHistory[] PROGMEM = "History";
+
+//Sensor button labels in LogRecord channel order, padded so relabeling covers longer ones
+const char historySensorStr0[] PROGMEM = "Temp    ";
+const char historySensorStr1[] PROGMEM = "Humidity";
+const char historySensorStr2[] PROGMEM = "Light   ";
+const char historySensorStr3[] PROGMEM = "EC      ";
+const char historySensorStr4[] PROGMEM = "pH      ";
+const char historySensorStr5[] PROGMEM = "Level   ";
+const char* const historySensors[] PROGMEM = { historySensorStr0, historySensorStr1,
+	historySensorStr2, historySensorStr3, historySensorStr4, historySensorStr5 };
+const char historyRangeStr0[] PROGMEM = " 1h";
+const char historyRangeStr1[] PROGMEM = " 6h";
+const char historyRangeStr2[] PROGMEM = "24h";
+const char historyRangeStr3[] PROGMEM = " 7d";
+const char* const historyRanges[] PROGMEM = { historyRangeStr0, historyRangeStr1,
+	historyRangeStr2, historyRangeStr3 };
+const uint32_t historyRangeSecs[] PROGMEM = { SECS_PER_HOUR, 6 * SECS_PER_HOUR,
+	SECS_PER_DAY, 7 * SECS_PER_DAY };
+const char noDataStr[] PROGMEM = "No data yet";
+
+extern SensorSeries sensorSeries;
+
+class WinHistory: public Window {
+	public:
+		WinHistory(UTFT *lcd, UTouch *touch, Sensors *sensors, Settings *settings);
+		WinHistory(const WinHistory &other);
+		WinHistory& operator=(const WinHistory &other);
+		~WinHistory();
+		Screen getType() const;
+		void draw();
+		Window::Screen processTouch(const int x, const int y);
+
+	protected:
+		static const uint8_t _nHistoryButtons = _nFlowButtons + 2;
+		static const uint8_t _nRanges = 4;
+		//Range that reads HOURLY.BIN when there's a card
+		static const uint8_t _weekRange = 3;
+		//Leaves must be a power of 2
+		static const uint16_t _nLeaves = 256;
+		static const uint16_t _nNodes = 2 * _nLeaves - 1;
+		//Node with no data
+		static const uint8_t _empty = 0xFF;
+		//Plot area
+		static const int _plotX = 72;
+		static const int _plotY = 58;
+		static const int _plotWidth = 312;
+		static const uint8_t _plotHeight = 140;
+		//Sensor and range shown, kept for next time the window opens
+		static uint8_t _channel;
+		static uint8_t _range;
+
+		int8_t _historyButtons[_nHistoryButtons];
+		time_t _from;
+		time_t _window;
+		//Value range plot rows span
+		int32_t _low;
+		int32_t _high;
+		boolean _found;
+		//Pyramid levels one after another, leaves first. Values are plot rows
+		uint8_t _min[_nNodes];
+		uint8_t _max[_nNodes];
+
+		void print();
+		//Reads data into pyramid. Returns false if there's none
+		boolean load();
+		//Feeds every sample in window to add(). First pass finds value range, second fills leaves
+		void scan(boolean fill);
+		boolean scanHourly(boolean fill);
+		void add(time_t t, int32_t min, int32_t max, boolean fill);
+		//Holds last value over empty leaves between samples and joins neighbouring spans
+		void joinLeaves();
+		void buildPyramid();
+		//Min and max rows of leaves from..to-1
+		void query(uint16_t from, uint16_t to, uint8_t &min, uint8_t &max) const;
+		void merge(uint16_t node, uint8_t &min, uint8_t &max) const;
+		void drawPlot();
+		void drawValue(int32_t value, int y);
+		//Alarm thresholds of channel as fixed-point values. Returns how many
+		uint8_t thresholds(int32_t values[2]) const;
+		uint8_t toRow(int32_t value) const;
+		//Next channel shown, skipping reservoir ones if the module is off
+		void nextChannel();
+};
+
+#endif
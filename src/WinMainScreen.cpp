@@ -270,7 +270,8 @@ void WinMainScreen::printNextWaterHour() {
 //Loads img files from /PICTURE folder of the SD card
 void WinMainScreen::printIconAndStatus() {
 	File img;
-	char* path;
+	//Pointer to PROGMEM path of the icon
+	const char* path;
 	boolean alarm = _settings->getAlarmTriggered();
 	boolean pumpOff = _settings->getPumpProtected();
 	boolean nightStopped =_settings->getNightWateringStopped();
@@ -282,17 +283,17 @@ void WinMainScreen::printIconAndStatus() {
 	if (pumpOff) {
 		_lcd->setColor(red[0],red[1],red[2]);
 		printStatus(pumpCont);
-		path = pmChar(alarmPath);
+		path = alarmPath;
 	//Night watering stopped & no pump protection triggered
 	} else if (nightStopped) {
 		(alarm) ? _lcd->setColor(red[0],red[1],red[2]) : _lcd->setColor(grey[0],grey[1],grey[2]);
 		printStatus(noNight);
-		path = pmChar(nightPath);
+		path = nightPath;
 	//Timed mode and watering plants
 	} else if (waterTimed && watering) {
 		_lcd->setColor(blue[0],blue[1],blue[2]);
 		printStatus(htmtWatering);
-		path = pmChar(logoPath);
+		path = logoPath;
 	//Normal or alarm modes
 	} else {
 		(alarm) ? _lcd->setColor(red[0],red[1],red[2]) : _lcd->setColor(darkGreen[0],darkGreen[1],darkGreen[2]);	
@@ -304,7 +305,7 @@ void WinMainScreen::printIconAndStatus() {
 		} else
 			(alarm) ? printStatus(alarmCont) : printStatus(normalCont);
 		//Path to image
-		(alarm) ? path = pmChar(alarmPath) : path = pmChar(plantPath);
+		(alarm) ? path = alarmPath : path = plantPath;
 	}
 	
 	//Read from SD line by line and display icon.
@@ -312,8 +313,11 @@ void WinMainScreen::printIconAndStatus() {
 	//Slow but effective
 	int xSpacer = 15;
 	int ySpacer = 25 + _bigFontSize;
-	if (SD.exists(path) && _settings->getSDactive()) {
-		img = SD.open(path,FILE_READ);
+	//SD library needs the path in SRAM
+	char pathArray[strlen_P(path) + 1];
+	strcpy_P(pathArray, path);
+	if (SD.exists(pathArray) && _settings->getSDactive()) {
+		img = SD.open(pathArray,FILE_READ);
 		for (int y = 0; y < _bigIconSize && img.available(); y++) {
 			uint16_t buf[_bigIconSize];
 			for (int x = _bigIconSize - 1; x >= 0; x--) {
@@ -341,6 +345,9 @@ void WinMainScreen::updateIconAndStatus() {
 	}
 }
 
+//Sensor readings open their trend graphs, anywhere else opens main menu
 Window::Screen WinMainScreen::processTouch(const int x, const int y) { 
+	if ((x > _xSize/2) && (y > _headerHeight) && (y < _statusTextY))
+		return History;
 	return MainMenu; 
 }
\ No newline at end of file
@@ -100,12 +100,14 @@ void Window::printMenuHeader(const char* c) {
 	_lcd->setFont(hallfetica_normal);
 	_lcd->setColor(grey[0], grey[1], grey[2]);
 	_lcd->setBackColor(lightGreen[0],lightGreen[1],lightGreen[2]);
-	//Prepare header string and convert to char array
-	String title = (String)pmChar(headerDecoration) + (String)pmChar(spaceChar) + (String)pmChar(c) + (String)pmChar(spaceChar) + (String)pmChar(headerDecoration);
-	char titleArray[title.length() + 1];
-	title.toCharArray(titleArray, sizeof(titleArray));
-	//Print title centered
-	_lcd->print(titleArray,(_xSize/2)-(_bigFontSize*(strlen(titleArray)/2)),2);
+	//Title is "- <c> -", printed piece by piece straight from flash
+	const uint8_t titleLength = strlen_P(c) + 4;
+	int x = (_xSize/2)-(_bigFontSize*(titleLength/2));
+	_lcd->print(pmChar(headerDecoration),x,2);
+	x += 2*_bigFontSize;
+	_lcd->print(pmChar(c),x,2);
+	x += strlen_P(c)*_bigFontSize;
+	_lcd->print(pmChar(headerDecoration),x+_bigFontSize,2);
 }
 
 //Overlays "Saved" text over save button
@@ -120,8 +122,7 @@ int Window::centerX(const char* c) {
 	return (_xSize / 2) - (_bigFontSize * (strlen_P(c) / 2));
 }
 
-//Converts a char array from PROGMEM to variable in SRAM
-char* Window::pmChar(const char *pmArray) {
-	strcpy_P(_stringBuffer, (char*)pmArray);
-	return _stringBuffer;
+//Tags a char array in PROGMEM so it gets printed from flash with no SRAM copy
+const __FlashStringHelper* Window::pmChar(const char *pmArray) {
+	return reinterpret_cast<const __FlashStringHelper*>(pmArray);
 }
\ No newline at end of file
@@ -114,7 +114,9 @@ class Window {
 			EcCalib = 18,
 			NightWater = 19,
 			Pump = 20,
-			Reservoir = 21
+			Reservoir = 21,
+			Diagnostics = 22,
+			History = 23
 		};
 				
 		Window(UTFT *lcd, UTouch *touch, Sensors *sensors, Settings *settings);
@@ -170,9 +172,8 @@ class Window {
 		void printSavedButton();
 		int centerX(const char* c);
 		
-		//These are used to read data from PROGMEM and store them into SRAM
-		char _stringBuffer[30];
-		char* pmChar(const char* pmArray);
+		//Tags a PROGMEM char* so print() reads it straight from flash
+		const __FlashStringHelper* pmChar(const char* pmArray);
 	
 		UTFT *_lcd;
 		UTouch *_touch;